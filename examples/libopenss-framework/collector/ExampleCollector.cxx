@@ -249,18 +249,21 @@ void ExampleCollector::getMetricValues(const std::string& metric,
     double t_blob = 
 	static_cast<double>(extent.getTimeInterval().getWidth());
     
+    // Buffer holding the subextents intersected by each sample
+    std::vector<ExtentGroup::size_type> intersection;
+
     // Iterate over each of the samples
     for(unsigned i = 0; i < data.pc.pc_len; ++i) {
 	
 	// Find the subextents that contain this sample
-	std::set<ExtentGroup::size_type> intersection = 
-	    subextents.getIntersectionWith(
-		Extent(extent.getTimeInterval(),
-		       AddressRange(data.pc.pc_val[i]))
-		);
+	subextents.getIntersectionWith(
+	    Extent(extent.getTimeInterval(),
+		   AddressRange(data.pc.pc_val[i])),
+	    intersection
+	    );
 	
 	// Iterate over each subextent in the intersection
-	for(std::set<ExtentGroup::size_type>::const_iterator
+	for(std::vector<ExtentGroup::size_type>::const_iterator
 		j = intersection.begin(); j != intersection.end(); ++j) {
 	    
 	    // Calculate intersection time (in nS) of subextent and data blob
@@ -42,6 +42,65 @@ struct ltCR {
   }
 };
 
+// Map the right most column value of a row to an index.
+// Functions, statements and linked objects are keyed on their canonical
+// Queries::SymbolKey, computed only once per row, so that matching the rows
+// of many compare sets needs no attribute lookups beyond those made for the
+// keys themselves. All other values are compared with ltCR. The keys' strings
+// are interned in a table owned by the map, and so are freed along with it
+// once the comparison is complete.
+class Symbol_Map
+{
+ private:
+  Queries::SymbolKey::Table key_strings;
+  std::map<Queries::SymbolKey, int64_t> keyed_map;
+  std::map<CommandResult *, int64_t, ltCR> unkeyed_map;
+
+  bool Get_Key (CommandResult *C, Queries::SymbolKey& key) {
+    switch (C->Type()) {
+     case CMD_RESULT_FUNCTION:
+      key = Queries::SymbolKey(key_strings, *((CommandResult_Function *)C),
+                               OPENSS_LESS_RESTRICTIVE_COMPARISONS);
+      return true;
+     case CMD_RESULT_STATEMENT:
+      key = Queries::SymbolKey(key_strings, *((CommandResult_Statement *)C),
+                               OPENSS_LESS_RESTRICTIVE_COMPARISONS);
+      return true;
+     case CMD_RESULT_LINKEDOBJECT:
+      key = Queries::SymbolKey(key_strings,
+                               *((CommandResult_LinkedObject *)C));
+      return true;
+     default:
+      return false;
+    }
+  }
+
+ public:
+ // Associate C with index, replacing any existing association.
+  void Set (CommandResult *C, int64_t index) {
+    Queries::SymbolKey key;
+    if (Get_Key (C, key)) {
+      keyed_map[key] = index;
+    } else {
+      unkeyed_map[C] = index;
+    }
+  }
+
+ // Return the index already associated with C, if there is one.
+ // Otherwise associate C with index and return -1.
+  int64_t Find_Or_Set (CommandResult *C, int64_t index) {
+    Queries::SymbolKey key;
+    if (Get_Key (C, key)) {
+      std::pair<std::map<Queries::SymbolKey, int64_t>::iterator, bool> result =
+        keyed_map.insert(std::make_pair(key, index));
+      return result.second ? -1 : (*result.first).second;
+    }
+    std::pair<std::map<CommandResult *, int64_t, ltCR>::iterator, bool> result =
+      unkeyed_map.insert(std::make_pair(C, index));
+    return result.second ? -1 : (*result.first).second;
+  }
+};
+
 // Data used to track Custom View definitions.
 pthread_mutex_t CustomView_List_Lock;
 class CustomView;
@@ -657,19 +716,19 @@ static bool Generate_CustomView (CommandObject *cmd,
   cmd->Result_Predefined (C); // attach column headers to output
 
  // Build the master maps.
- // The master_map associates a CommandResult * with an index.
+ // The master_map associates a CommandResult * (by its symbol key, when it has one) with an index.
  // The index is into master_vector, which points to the Function, Statement, LinkedObject, ...
 
   int64_t num_rows = 0;
   std::vector<CommandResult *> master_vector(rows_in_Set0);
-  std::map<CommandResult *, int64_t, ltCR> master_map;
+  Symbol_Map master_map;
   int64_t num_enders = 0;
 //  std::vector<std::vector<CommandResult *> > master_ender_vector(enders_in_allSets,numQuickSets);
 
   std::vector<std::vector<CommandResult*> > master_ender_vector(
 		enders_in_allSets, std::vector<CommandResult*>(numQuickSets));
 
-  std::map<CommandResult *, int64_t, ltCR> master_ender_map;
+  Symbol_Map master_ender_map;
 
  // Initial the master maps with information from Quick_Compare_Set[0].
   for (coi = Quick_Compare_Set[0].partial_view.begin(); coi != Quick_Compare_Set[0].partial_view.end(); coi++) {
@@ -688,7 +747,7 @@ static bool Generate_CustomView (CommandObject *cmd,
       std::list<CommandResult *>::iterator li;
       for (li = L.begin(); li != L.end(); li++) { last_column = *li; }
       Assert (last_column != NULL);
-      master_map[last_column] = num_rows;
+      master_map.Set (last_column, num_rows);
       master_vector[num_rows++] = last_column;
 
     } else if (c->Type() == CMD_RESULT_COLUMN_ENDER) {
@@ -699,7 +758,7 @@ static bool Generate_CustomView (CommandObject *cmd,
       std::list<CommandResult *>::iterator li;
       for (li = L.begin(); li != L.end(); li++) { last_column = *li; }
       Assert (last_column != NULL);
-      master_ender_map[last_column] = num_enders;
+      master_ender_map.Set (last_column, num_enders);
       master_ender_vector[num_enders++][0] = c;
 
     }
@@ -732,22 +791,15 @@ static bool Generate_CustomView (CommandObject *cmd,
         std::list<CommandResult *>::iterator li;
         for (li = L.begin(); li != L.end(); li++) { last_column = *li; }
         Assert (last_column != NULL);
-        std::map<CommandResult *, int64_t, ltCR>::iterator result = master_map.find(last_column);
-        int64_t master_index = -1;
+        int64_t master_index = master_map.Find_Or_Set (last_column, num_rows);
 
-        if (master_map.end() == result) {
+        if (master_index < 0) {
 
          // Need to add a new entry into the master.
           master_index = num_rows;
-          master_map[last_column] = num_rows;
           master_vector.push_back (last_column);
           num_rows++;
 
-        } else {
-
-         // Use the index to an existing entry.
-          master_index = (*result).second;
-
         }
 #if DEBUG_COMPARE_SETS
         printf("SSCOMPARE: IN Generate_CustomView, master_index section, master_index=%d\n", master_index);
@@ -778,19 +830,12 @@ static bool Generate_CustomView (CommandObject *cmd,
         std::list<CommandResult *>::iterator li;
         for (li = L.begin(); li != L.end(); li++) { last_column = *li; }
         Assert (last_column != NULL);
-        std::map<CommandResult *, int64_t, ltCR>::iterator result = master_ender_map.find(last_column);
-        int64_t master_ender_index = -1;
+        int64_t master_ender_index = master_ender_map.Find_Or_Set (last_column, num_enders);
 
-        if (master_ender_map.end() == result) {
+        if (master_ender_index < 0) {
 
          // Need to add a new entry into the master.
           master_ender_index = num_enders++;
-          master_ender_map[last_column] = master_ender_index;
-
-        } else {
-
-         // Use the index to an existing entry.
-          master_ender_index = (*result).second;
 
         }
 
@@ -866,6 +866,75 @@ static inline void Accumulate_PreDefined_Temps (std::vector<ViewInstruction *>&
   }
 }
 
+// Interned identifiers for the frames of call stacks.
+// Each distinct frame is mapped to a small integer so that call stacks can be
+// hashed without repeatedly comparing the heap allocated CommandResult objects.
+class CallStack_Frame_Table {
+  std::map<Function, int64_t> Functions;
+  std::map<LinkedObject, int64_t> LinkedObjects;
+  std::map<std::string, int64_t> Strings;
+
+  template <typename T>
+  static int64_t Intern (std::map<T, int64_t>& table, const T& item) {
+    typename std::map<T, int64_t>::iterator ti = table.lower_bound(item);
+    if ((ti == table.end()) ||
+        (table.key_comp()(item, ti->first))) {
+      ti = table.insert (ti, std::make_pair(item, (int64_t)table.size()));
+    }
+    return ti->second;
+  }
+
+  static void Mix (uint64_t& hash, uint64_t V) {
+   // FNV-1a, one byte at a time.
+    for (int64_t i = 0; i < 8; i++) {
+      hash ^= (V & 0xff);
+      hash *= 0x100000001b3ULL;
+      V >>= 8;
+    }
+  }
+
+ public:
+
+ // Hash a call stack using the same fields that Match_Call_Stack compares.
+ // Columns are not hashed because Match_Call_Stack treats a zero column as
+ // matching any column.  Returns false if the call stack contains a frame
+ // that Match_Call_Stack never considers equal to anything.
+  bool Hash_Call_Stack (std::vector<CommandResult *> *cs, uint64_t& hash) {
+    hash = 0xcbf29ce484222325ULL;
+    Mix (hash, cs->size());
+    for (std::vector<CommandResult *>::size_type i = 0; i < cs->size(); i++) {
+      CommandResult *cse = (*cs)[i];
+      cmd_result_type_enum ty = cse->Type();
+      Mix (hash, ty);
+      if (ty == CMD_RESULT_FUNCTION) {
+        CommandResult_Function *F = (CommandResult_Function *)cse;
+        Mix (hash, Intern (Functions, *((Function *)F)));
+        Mix (hash, F->getLine());
+      } else if (ty == CMD_RESULT_LINKEDOBJECT) {
+        uint64_t V;
+        ((CommandResult_LinkedObject *)cse)->Value(V);
+        Mix (hash, V);
+        Mix (hash, Intern (LinkedObjects, *((LinkedObject *)(CommandResult_LinkedObject *)cse)));
+      } else if (ty == CMD_RESULT_ADDRESS) {
+        uint64_t V;
+        ((CommandResult_Address *)cse)->Value(V);
+        Mix (hash, V);
+      } else if (ty == CMD_RESULT_UINT) {
+        uint64_t V;
+        ((CommandResult_Uint *)cse)->Value(V);
+        Mix (hash, V);
+      } else if (ty == CMD_RESULT_STRING) {
+        std::string V;
+        ((CommandResult_String *)cse)->Value(V);
+        Mix (hash, Intern (Strings, V));
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
 static void Combine_Duplicate_CallStacks (
               std::vector<ViewInstruction *>& IV,
               std::vector<ViewInstruction *>& FieldRequirements,
@@ -874,46 +943,62 @@ static void Combine_Duplicate_CallStacks (
 #if DEBUG_CLI
   printf("in Combine_Duplicate_CallStacks\n");
 #endif
-  std::vector<std::pair<CommandResult *,
-                        SmartPtr<std::vector<CommandResult *> > > >::iterator vpi;
-
-  for (vpi = c_items.begin(); vpi != c_items.end(); vpi++) {
-   // Foreach CallStack entry, look for duplicates.
-    std::vector<std::pair<CommandResult *,
-                          SmartPtr<std::vector<CommandResult *> > > >::iterator nvpi = vpi+1;
-    if (nvpi == c_items.end()) break;
+ // Each entry is combined into the first earlier entry with an identical call
+ // stack, as long as no remaining entry with a shorter call stack lies between
+ // them.  (Expanded call stacks are placed in the vector in calling order, so
+ // a shorter call stack marks the start of a different calling path.)
+ // Rather than comparing every entry against all that follow, look up each
+ // entry's call stack in a hash table of the entries that remain, in a single
+ // pass over the vector.
+  typedef std::vector<std::pair<CommandResult *,
+                                SmartPtr<std::vector<CommandResult *> > > >::size_type Entry_Index;
+  typedef std::vector<CommandResult *>::size_type Stack_Size;
+
+  CallStack_Frame_Table Frames;
+  std::map<uint64_t, std::vector<Entry_Index> > Remaining;
+
+ // Entries with a given call stack size remain available for combining only
+ // if they are at or beyond the cutoff for that size.
+  std::vector<Entry_Index> Cutoff;
+
+  for (Entry_Index k = 0; k < c_items.size(); k++) {
     std::pair<CommandResult *,
-              SmartPtr<std::vector<CommandResult *> > > cp = *vpi;
-    if (cp.first == NULL) {
+              SmartPtr<std::vector<CommandResult *> > > ncp = c_items[k];
+    if (ncp.first == NULL) {
       continue;
     }
-    std::vector<CommandResult *> *cs = ((CommandResult_CallStackEntry *)cp.first)->Value();
-    int64_t cs_size = cs->size();
-   // Compare the current entry to all following ones.
+    std::vector<CommandResult *> *ncs = ((CommandResult_CallStackEntry *)ncp.first)->Value();
+    Stack_Size ncs_size = ncs->size();
+    if (Cutoff.size() <= ncs_size) {
+      Cutoff.resize(ncs_size + 1, 0);
+    }
 
-    for ( ; nvpi != c_items.end(); ) {
-      std::pair<CommandResult *,
-                SmartPtr<std::vector<CommandResult *> > > ncp = *nvpi;
-      if (ncp.first == NULL) {
-        nvpi++;
-        continue;
-      }
-      std::vector<CommandResult *> *ncs = ((CommandResult_CallStackEntry *)ncp.first)->Value();
-      if (cs_size > ncs->size()) {
-        break;
-      }
-      if (cs_size != ncs->size()) {
-       // We can do this because the original call stacks are expanded in place.
-        nvpi++;
-        continue;
+   // Look for an earlier entry with the same call stack.
+    Entry_Index match = k;
+    uint64_t hash;
+    if (Frames.Hash_Call_Stack (ncs, hash)) {
+      std::vector<Entry_Index>& candidates = Remaining[hash];
+      for (std::vector<Entry_Index>::size_type c = 0; c < candidates.size(); c++) {
+        std::pair<CommandResult *,
+                  SmartPtr<std::vector<CommandResult *> > > cp = c_items[candidates[c]];
+        std::vector<CommandResult *> *cs = ((CommandResult_CallStackEntry *)cp.first)->Value();
+        if ((candidates[c] < Cutoff[cs->size()]) ||
+            (cs->size() != ncs_size)) {
+          continue;
+        }
+        int64_t matchcount = Match_Call_Stack (cs, ncs);
+        if ((matchcount >= 0) &&
+            ((Stack_Size)matchcount == cs->size()) &&
+            ((Stack_Size)matchcount == ncs_size) &&
+            Match_Field_Requirements(FieldRequirements, (*cp.second), (*ncp.second))) {
+          match = candidates[c];
+          break;
+        }
       }
-      int64_t matchcount = Match_Call_Stack (cs, ncs);
-      if ((matchcount >= 0) &&
-          (matchcount == cs->size()) &&
-          (matchcount == ncs->size()) &&
-          Match_Field_Requirements(FieldRequirements, (*cp.second), (*ncp.second))) {
+
+      if (match != k) {
        // Call stacks are identical - combine values.
-        Accumulate_PreDefined_Temps (IV, (*cp.second), (*ncp.second));
+        Accumulate_PreDefined_Temps (IV, (*c_items[match].second), (*ncp.second));
         delete ncp.first;
         if ((*ncp.second).begin() != (*ncp.second).end()) {
           for (int64_t i = 0; i < (*ncp.second).size(); i++) {
@@ -924,14 +1009,17 @@ static void Combine_Duplicate_CallStacks (
        // Because a "c_items.erase(nvpi);" operation takes a lot of time
        // when vectors get long, just fill with a null pointer and compress
        // the vector after all unnecessary entries have been identified.
-        (*nvpi).first = NULL;
-        nvpi++;
-        continue;
+        c_items[k].first = NULL;
+      } else {
+        candidates.push_back (k);
       }
-     // Match failed.  Continue looking for other stacks that match.
-      nvpi++;
     }
 
+   // This entry separates the entries with longer call stacks before it from
+   // those after it, unless it was combined into an entry preceding them.
+    for (Stack_Size i = ncs_size + 1; i < Cutoff.size(); i++) {
+      Cutoff[i] = std::max (Cutoff[i], match);
+    }
   }
 
   Pack_Vector_Elements (c_items);
@@ -25,12 +25,91 @@
 #include "AddressBitmap.hxx"
 #include "Blob.hxx"
 
-#include <string.h>
+#include <algorithm>
+#include <stdlib.h>
 
 using namespace OpenSpeedShop::Framework;
 
 
 
+namespace {
+
+    /**
+     * Count trailing zeros.
+     *
+     * Returns the number of trailing (least significant) zero bits in the
+     * specified word, which must not be zero.
+     *
+     * @param word    Word to be examined.
+     * @return        Number of trailing zero bits in that word.
+     */
+    inline unsigned countTrailingZeros(uint64_t word)
+    {
+#ifdef __GNUC__
+	return __builtin_ctzll(word);
+#else
+	unsigned count = 0;
+	for(; !(word & 1); word >>= 1)
+	    ++count;
+	return count;
+#endif
+    }
+
+    /**
+     * Get the size of a packed bitmap.
+     *
+     * Returns the number of bytes in a blob containing a bitmap of the
+     * specified width packed one bit per address. This is the original (and
+     * still most general) format of the bitmaps stored in experiment
+     * databases. Any blob with fewer bytes contains a run-length encoding.
+     *
+     * @param width    Width of the bitmap.
+     * @return         Size (in bytes) of the packed bitmap.
+     */
+    inline uint64_t getPackedSize(const uint64_t& width)
+    {
+	return (width + 7) / 8;
+    }
+
+    /**
+     * Append a run length.
+     *
+     * Appends the specified run length to a run-length encoding as an unsigned,
+     * little-endian base 128 number.
+     *
+     * @param length      Run length to be appended.
+     * @retval encoding   Encoding to which the run length is appended.
+     */
+    void appendRunLength(uint64_t length, std::vector<unsigned char>& encoding)
+    {
+	for(; length >= 0x80; length >>= 7)
+	    encoding.push_back(static_cast<unsigned char>(length | 0x80));
+	encoding.push_back(static_cast<unsigned char>(length));
+    }
+
+    /**
+     * Test if run-length encoded blobs are enabled.
+     *
+     * Returns a flag indicating if getBlob() may produce run-length encoded
+     * blobs. Releases before these encodings were introduced assume that all
+     * bitmap blobs are packed, and abort on any database containing them, so
+     * they are only produced when OPENSS_COMPRESS_BITMAPS is set. The variable
+     * is examined once, on the first call.
+     *
+     * @return    Boolean "true" if run-length encoded blobs are enabled,
+     *            "false" otherwise.
+     */
+    bool isRunLengthEncodingEnabled()
+    {
+	static const bool is_enabled =
+	    (getenv("OPENSS_COMPRESS_BITMAPS") != NULL);
+	return is_enabled;
+    }
+
+}
+
+
+
 /**
  * Constructor from address range.
  *
@@ -41,7 +120,7 @@ using namespace OpenSpeedShop::Framework;
  */
 AddressBitmap::AddressBitmap(const AddressRange& range) :
     dm_range(range),
-    dm_bitmap(range.getWidth(), false)
+    dm_words((range.getWidth() + 63) / 64, 0)
 {
 }
 
@@ -51,22 +130,45 @@ AddressBitmap::AddressBitmap(const AddressRange& range) :
  * Constructor from address range and blob.
  *
  * Constructs a new address bitmap covering the specified range and with its
- * contents specified by a blob.
+ * contents specified by a blob. The blob may contain either of the formats
+ * produced by getBlob().
  *
  * @param range    Address range covered by this bitmap.
  * @param blob     Blob containing the bitmap's contents.
  */
 AddressBitmap::AddressBitmap(const AddressRange& range, const Blob& blob) :
     dm_range(range),
-    dm_bitmap(range.getWidth(), false)
+    dm_words((range.getWidth() + 63) / 64, 0)
 {
-    // Check assertions
-    Assert(blob.getSize() >= (dm_range.getWidth() / 8));
+    const unsigned char* contents =
+	reinterpret_cast<const unsigned char*>(blob.getContents());
+    uint64_t width = dm_range.getWidth();
+
+    // Transfer a packed bitmap from the blob's contents, eight bits at a time
+    if(blob.getSize() >= getPackedSize(width)) {
+	for(uint64_t i = 0; i < getPackedSize(width); ++i)
+	    dm_words[i / 8] |= static_cast<uint64_t>(contents[i]) << (8*(i % 8));
+	if(width % 64)
+	    dm_words.back() &= (static_cast<uint64_t>(1) << (width % 64)) - 1;
+    }
 
-    // Transfer bitmap from the blob's contents
-    const char* contents = reinterpret_cast<const char*>(blob.getContents());
-    for(unsigned i = 0; i < dm_range.getWidth(); ++i)
-	dm_bitmap[i] = contents[i / 8] & (1 << (i % 8));
+    // Otherwise decode the alternating runs of "false" and "true" values
+    else {
+	uint64_t offset = 0;
+	bool value = false;
+	for(unsigned i = 0; i < blob.getSize(); value = !value) {
+	    uint64_t length = 0;
+	    for(unsigned shift = 0; i < blob.getSize(); shift += 7) {
+		length |= static_cast<uint64_t>(contents[i] & 0x7f) << shift;
+		if(!(contents[i++] & 0x80))
+		    break;
+	    }
+	    Assert(length <= (width - offset));
+	    setBits(offset, offset + length, value);
+	    offset += length;
+	}
+	Assert(offset == width);
+    }
 }
 
 
@@ -85,7 +187,33 @@ void AddressBitmap::setValue(const Address& address, const bool& value)
     Assert(dm_range.doesContain(address));
 
     // Set the value
-    dm_bitmap[address - dm_range.getBegin()] = value;
+    setBits(address - dm_range.getBegin(),
+	    (address - dm_range.getBegin()) + 1, value);
+}
+
+
+
+/**
+ * Set a range of values.
+ *
+ * Sets the values in this bitmap corresponding to all the addresses within the
+ * specified address range.
+ *
+ * @param range    Address range to be set.
+ * @param value    Value to set for these addresses.
+ */
+void AddressBitmap::setValue(const AddressRange& range, const bool& value)
+{
+    // Handle special case of an empty range
+    if(range.isEmpty())
+	return;
+
+    // Check assertions
+    Assert(dm_range.doesContain(range));
+
+    // Set the values
+    setBits(range.getBegin() - dm_range.getBegin(),
+	    range.getEnd() - dm_range.getBegin(), value);
 }
 
 
@@ -104,7 +232,7 @@ bool AddressBitmap::getValue(const Address& address) const
     Assert(dm_range.doesContain(address));
 
     // Return the value to the caller
-    return dm_bitmap[address - dm_range.getBegin()];
+    return getBit(address - dm_range.getBegin());
 }
 
 
@@ -112,32 +240,50 @@ bool AddressBitmap::getValue(const Address& address) const
 /**
  * Get bitmap as a blob.
  *
- * Returns a blob containing the bitmaps as its contents.
- * 
+ * Returns a blob containing the bitmaps as its contents. The bitmap is normally
+ * stored packed one bit per address. When OPENSS_COMPRESS_BITMAPS is set, it
+ * is instead stored as a sequence of alternating run lengths, beginning with a
+ * (possibly empty) run of "false" values, whenever that is smaller. Each run
+ * length is stored as an unsigned, little-endian base 128 number. A bitmap
+ * with every address valid thus requires only a few bytes however wide its
+ * address range.
+ *
+ * @note    Run-length encoded blobs break compatibility with older releases,
+ *          which assume every bitmap blob is packed and fail an assertion when
+ *          reading a database containing them. The schema version is not
+ *          changed, since those releases don't check it. Only enable the
+ *          encoding for databases that will be read by this or later releases.
+ *
  * @return    Blob containing this bitmap.
  */
 Blob AddressBitmap::getBlob() const
 {
-    // Calculate the size of the blob to cover this address range
-    unsigned size = ((dm_range.getWidth() - 1) / 8) + 1;
-
-    // Allocate and zero the contents of the blob
-    char* contents = new char[size];
-    memset(contents, 0, size);
-
-    // Transfer bitmap into the blob's contents
-    for(unsigned i = 0; i < dm_range.getWidth(); ++i)
-	if(dm_bitmap[i])
-	    contents[i / 8] |= 1 << (i % 8);
-
-    // Create the blob
-    Blob blob(size, contents);
-
-    // Destroy the contents (the blob keeps a private copy)
-    delete [] contents;
-
-    // Return the blob to the caller
-    return blob;
+    uint64_t width = dm_range.getWidth();
+
+    // Handle special case of an empty bitmap
+    if(width == 0)
+	return Blob();
+
+    // Run-length encode the bitmap, giving up if that isn't any smaller
+    if(isRunLengthEncodingEnabled()) {
+	std::vector<unsigned char> encoding;
+	bool value = false;
+	for(uint64_t offset = 0;
+	    (offset < width) && (encoding.size() < getPackedSize(width));
+	    value = !value) {
+	    uint64_t next = findNext(!value, offset);
+	    appendRunLength(next - offset, encoding);
+	    offset = next;
+	}
+	if(encoding.size() < getPackedSize(width))
+	    return Blob(encoding.size(), &encoding[0]);
+    }
+    
+    // Otherwise pack the bitmap, eight bits at a time
+    std::vector<unsigned char> contents(getPackedSize(width));
+    for(uint64_t i = 0; i < contents.size(); ++i)
+	contents[i] = static_cast<unsigned char>(dm_words[i / 8] >> (8*(i % 8)));
+    return Blob(contents.size(), &contents[0]);
 }
 
 
@@ -155,30 +301,80 @@ std::set<AddressRange>
 AddressBitmap::getContiguousRanges(const bool& value) const
 {
     std::set<AddressRange> ranges;
-    bool in_range = false;
-    Address range_begin;
     
-    // Iterate over each address in the bitmap
-    for(Address i = dm_range.getBegin(); i != dm_range.getEnd(); ++i) {
-
-	// Is this address the beginning of a range?
-	if(!in_range && (getValue(i) == value)) {
-	    in_range = true;
-	    range_begin = i;
-	}
-	
-	// Is this address the end of a range?
-	else if(in_range && (getValue(i) != value)) {
-	    in_range = false;
-	    ranges.insert(AddressRange(range_begin, i));
-	}
-	
+    // Alternately find the beginning and end of each range
+    for(uint64_t begin = findNext(value, 0), end = 0;
+	begin < dm_range.getWidth();
+	begin = findNext(value, end)) {
+	end = findNext(!value, begin);
+	ranges.insert(AddressRange(dm_range.getBegin() + begin,
+				   dm_range.getBegin() + end));
     }
 
-    // Does a range end at the end of the bitmap?
-    if(in_range)
-	ranges.insert(AddressRange(range_begin, dm_range.getEnd()));
-    
     // Return the ranges to the caller
     return ranges;
 }
+
+
+
+/**
+ * Set a range of bits.
+ *
+ * Sets the bits at the specified offsets within the address range. Whole words
+ * are filled at once, leaving only the partial words at either end to be set
+ * by masking.
+ *
+ * @param begin    Offset of the first bit to be set.
+ * @param end      Offset one beyond the last bit to be set.
+ * @param value    Value to set for these bits.
+ */
+void AddressBitmap::setBits(const uint64_t& begin, const uint64_t& end,
+			    const bool& value)
+{
+    for(uint64_t i = begin; i < end;) {
+	uint64_t word = i / 64;
+	uint64_t bits = std::min<uint64_t>(end - i, 64 - (i % 64));
+	uint64_t mask = (bits == 64) ? ~static_cast<uint64_t>(0) :
+	    (((static_cast<uint64_t>(1) << bits) - 1) << (i % 64));
+	if(value)
+	    dm_words[word] |= mask;
+	else
+	    dm_words[word] &= ~mask;
+	i += bits;
+    }
+}
+
+
+
+/**
+ * Find the next bit with a value.
+ *
+ * Returns the offset of the first bit, at or after the specified offset, with
+ * the specified value. The search skips over whole words that don't contain
+ * any such bits.
+ *
+ * @param value     Value of interest.
+ * @param offset    Offset at which to begin the search.
+ * @return          Offset of the next bit with that value, or the width of the
+ *                  address range if there is no such bit.
+ */
+uint64_t AddressBitmap::findNext(const bool& value,
+				 const uint64_t& offset) const
+{
+    uint64_t width = dm_range.getWidth();
+    if(offset >= width)
+	return width;
+
+    // Search the first (partial) word and then any following words
+    uint64_t i = offset / 64;
+    uint64_t word = (value ? dm_words[i] : ~dm_words[i]) &
+	(~static_cast<uint64_t>(0) << (offset % 64));
+    while(word == 0) {
+	if(++i == dm_words.size())
+	    return width;
+	word = value ? dm_words[i] : ~dm_words[i];
+    }
+    
+    // The "false" bits beyond the end of the address range don't count
+    return std::min<uint64_t>((i * 64) + countTrailingZeros(word), width);
+}
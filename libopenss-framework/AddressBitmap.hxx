@@ -31,6 +31,9 @@
 
 #include "AddressRange.hxx"
 
+#ifdef HAVE_INTTYPES_H
+#include <inttypes.h>
+#endif
 #include <set>
 #include <vector>
 
@@ -49,6 +52,10 @@ namespace OpenSpeedShop { namespace Framework {
      * which addresses within an address range are actually attributable to
      * the source statement.
      *
+     * The bits are packed into 64-bit words so that conversions to and from
+     * blobs, and searches for contiguous ranges, operate on whole words at a
+     * time rather than on individual addresses.
+     *
      * @ingroup Implementation
      */
     class AddressBitmap
@@ -65,13 +72,8 @@ namespace OpenSpeedShop { namespace Framework {
 	    return dm_range;
 	}
 
-	/** Read-only data member accessor function. */
-	const std::vector<bool>& getBitmap() const
-	{
-	    return dm_bitmap;
-	}
-
 	void setValue(const Address&, const bool&);
+	void setValue(const AddressRange&, const bool&);
 	bool getValue(const Address&) const;
 	
 	Blob getBlob() const;
@@ -83,19 +85,15 @@ namespace OpenSpeedShop { namespace Framework {
 					const AddressBitmap& object)
 	{
 	    stream << object.dm_range << " ";
-	    bool has_false = false, has_true = false;
-	    for(unsigned i = 0; i < object.dm_range.getWidth(); ++i)
-		if(object.getBitmap()[i] == true)
-		    has_true = true;
-		else
-		    has_false = true;
-	    if(has_false && !has_true)
+	    uint64_t first_true = object.findNext(true, 0);
+	    uint64_t first_false = object.findNext(false, 0);
+	    if(first_true == object.dm_range.getWidth())
 		stream << "0...0";
-	    else if(!has_false && has_true)
+	    else if(first_false == object.dm_range.getWidth())
 		stream << "1...1";
 	    else
-		for(unsigned i = 0; i < object.dm_range.getWidth(); ++i)
-		    stream << (object.dm_bitmap[i] ? "1" : "0");
+		for(uint64_t i = 0; i < object.dm_range.getWidth(); ++i)
+		    stream << (object.getBit(i) ? "1" : "0");
 	    return stream;
 	}
 
@@ -104,8 +102,23 @@ namespace OpenSpeedShop { namespace Framework {
 	/** Address range covered by this bitmap. */
 	AddressRange dm_range;
 
-	/** Actual bitmap. */
-	std::vector<bool> dm_bitmap;
+	/**
+	 * Actual bitmap.
+	 *
+	 * Bit (i % 64) of word (i / 64) corresponds to the address at offset i
+	 * within the address range. Bits beyond the end of the address range
+	 * are always "false".
+	 */
+	std::vector<uint64_t> dm_words;
+
+	/** Get the bit at an offset within the address range. */
+	bool getBit(const uint64_t& offset) const
+	{
+	    return (dm_words[offset / 64] >> (offset % 64)) & 1;
+	}
+
+	void setBits(const uint64_t&, const uint64_t&, const bool&);
+	uint64_t findNext(const bool&, const uint64_t&) const;
 	
     };
     
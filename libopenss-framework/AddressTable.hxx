@@ -0,0 +1,292 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Declaration and definition of the AddressTable template.
+ *
+ */
+
+#ifndef _OpenSpeedShop_Framework_AddressTable_
+#define _OpenSpeedShop_Framework_AddressTable_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Address.hxx"
+#include "AddressRange.hxx"
+#include "Assert.hxx"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+
+
+namespace OpenSpeedShop { namespace Framework {
+
+    /**
+     * Table of address ranges.
+     *
+     * Template for a container holding the address ranges of a given set of
+     * objects (e.g. functions) within a group (e.g. a linked object), and
+     * answering which objects contain a single address. Unlike ExtentTable,
+     * which is optimized for intersecting whole extent groups, this table is
+     * optimized for point queries such as those made for every frame of every
+     * call stack.
+     *
+     * Ranges are added to a group in any order. Upon the first query of that
+     * group the ranges are converted into an immutable, sorted sequence of non-
+     * overlapping segments, each listing the objects covering that segment.
+     * Queries then require only a binary search over the segments.
+     *
+     * Individual addresses of a group may also be added along with the objects
+     * already known to contain them (e.g. from a table of addresses resolved in
+     * advance). Queries for such pre-resolved addresses are answered directly,
+     * without requiring that any of the group's address ranges be added.
+     *
+     * @ingroup Implementation
+     */
+    template <typename TG, typename TO>
+    class AddressTable
+    {
+
+    public:
+
+	/** Default constructor. */
+	AddressTable() :
+	    dm_indices(),
+	    dm_resolved()
+	{
+	}
+
+	/** Add a group (possibly without any address ranges). */
+	void addGroup(const TG& group)
+	{
+	    dm_indices.insert(std::make_pair(group, Index()));
+	}
+
+	/** Add an address range for a given group and object. */
+	void addRange(const TG& group, const TO& object,
+		      const AddressRange& range)
+	{
+	    typename std::map<TG, Index>::iterator i = dm_indices.find(group);
+	    if(i == dm_indices.end())
+		i = dm_indices.insert(std::make_pair(group, Index())).first;
+	    Assert(i != dm_indices.end());
+	    i->second.dm_ranges.push_back(std::make_pair(range, object));
+	    i->second.dm_is_built = false;
+	}
+
+	/** Remove the address ranges for the given group. */
+	void removeGroup(const TG& group)
+	{
+	    dm_indices.erase(group);
+	}
+
+	/** Test if the given group has been added. */
+	bool hasGroup(const TG& group) const
+	{
+	    return dm_indices.find(group) != dm_indices.end();
+	}
+
+	/** Add a group of pre-resolved addresses (possibly without any). */
+	void addResolvedGroup(const TG& group)
+	{
+	    dm_resolved.insert(
+		std::make_pair(group, std::map<Address, std::set<TO> >())
+		);
+	}
+
+	/** Add a pre-resolved address, without any objects, for a group. */
+	void addResolvedAddress(const TG& group, const Address& address)
+	{
+	    dm_resolved[group][address];
+	}
+
+	/** Add an object containing a pre-resolved address for a group. */
+	void addResolvedObject(const TG& group, const Address& address,
+			       const TO& object)
+	{
+	    dm_resolved[group][address].insert(object);
+	}
+
+	/** Remove the pre-resolved addresses for the given group. */
+	void removeResolvedGroup(const TG& group)
+	{
+	    dm_resolved.erase(group);
+	}
+
+	/** Test if the given group of pre-resolved addresses has been added. */
+	bool hasResolvedGroup(const TG& group) const
+	{
+	    return dm_resolved.find(group) != dm_resolved.end();
+	}
+
+	/** Test if an address has been pre-resolved for the given group. */
+	bool isResolvedAt(const TG& group, const Address& address) const
+	{
+	    typename std::map<TG, std::map<Address, std::set<TO> > >::
+		const_iterator i = dm_resolved.find(group);
+	    return (i != dm_resolved.end()) &&
+		(i->second.find(address) != i->second.end());
+	}
+
+	/** Get the objects for the given group containing an address. */
+	std::set<TO> getObjectsAt(const TG& group, const Address& address)
+	{
+	    std::set<TO> objects;
+
+	    // Use the pre-resolved objects for this address when available
+	    typename std::map<TG, std::map<Address, std::set<TO> > >::
+		const_iterator r = dm_resolved.find(group);
+	    if(r != dm_resolved.end()) {
+		typename std::map<Address, std::set<TO> >::const_iterator
+		    j = r->second.find(address);
+		if(j != r->second.end())
+		    return j->second;
+	    }
+
+	    typename std::map<TG, Index>::iterator i = dm_indices.find(group);
+	    if(i == dm_indices.end())
+		return objects;
+	    if(!i->second.dm_is_built)
+		build(i->second);
+	    const Index& index = i->second;
+
+	    // Find the last segment beginning at or before this address
+	    typename std::vector<Address>::const_iterator j = std::upper_bound(
+		index.dm_begins.begin(), index.dm_begins.end(), address
+		);
+	    if(j == index.dm_begins.begin())
+		return objects;
+	    typename std::vector<Address>::size_type k =
+		(j - index.dm_begins.begin()) - 1;
+
+	    // Add that segment's objects if it contains this address
+	    if(address < index.dm_ends[k])
+		objects.insert(index.dm_objects.begin() + index.dm_offsets[k],
+			       index.dm_objects.begin() + index.dm_offsets[k + 1]);
+
+	    return objects;
+	}
+
+    private:
+
+	/** Address ranges, and their segments, for a single group. */
+	struct Index
+	{
+	    /** Address ranges of all objects in this group. */
+	    std::vector<std::pair<AddressRange, TO> > dm_ranges;
+
+	    /** Flag indicating if the segments are current. */
+	    bool dm_is_built;
+
+	    /** Beginning address of each segment (sorted). */
+	    std::vector<Address> dm_begins;
+
+	    /** Ending address of each segment. */
+	    std::vector<Address> dm_ends;
+
+	    /** Offset of each segment's first object (plus a final end). */
+	    std::vector<typename std::vector<TO>::size_type> dm_offsets;
+
+	    /** Objects of all segments, stored contiguously. */
+	    std::vector<TO> dm_objects;
+
+	    /** Default constructor. */
+	    Index() :
+		dm_ranges(),
+		dm_is_built(true),
+		dm_begins(),
+		dm_ends(),
+		dm_offsets(1, 0),
+		dm_objects()
+	    {
+	    }
+	};
+
+	/** Indices for each group. */
+	std::map<TG, Index> dm_indices;
+
+	/** Objects containing each pre-resolved address for each group. */
+	std::map<TG, std::map<Address, std::set<TO> > > dm_resolved;
+
+	/** Build the segments of an index from its address ranges. */
+	static void build(Index& index)
+	{
+	    // Find the unique boundaries of all address ranges
+	    std::vector<Address> boundaries;
+	    for(typename std::vector<std::pair<AddressRange, TO> >::
+		    const_iterator i = index.dm_ranges.begin();
+		i != index.dm_ranges.end();
+		++i) {
+		boundaries.push_back(i->first.getBegin());
+		boundaries.push_back(i->first.getEnd());
+	    }
+	    std::sort(boundaries.begin(), boundaries.end());
+	    boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+			     boundaries.end());
+
+	    // Assign each address range's object to the segments it covers
+	    std::vector<std::vector<TO> > segments(
+		boundaries.empty() ? 0 : (boundaries.size() - 1)
+		);
+	    for(typename std::vector<std::pair<AddressRange, TO> >::
+		    const_iterator i = index.dm_ranges.begin();
+		i != index.dm_ranges.end();
+		++i)
+		for(typename std::vector<Address>::size_type j =
+			std::lower_bound(boundaries.begin(), boundaries.end(),
+					 i->first.getBegin()) -
+			boundaries.begin();
+		    boundaries[j] < i->first.getEnd();
+		    ++j)
+		    segments[j].push_back(i->second);
+
+	    // Flatten the non-empty segments
+	    index.dm_begins.clear();
+	    index.dm_ends.clear();
+	    index.dm_offsets.assign(1, 0);
+	    index.dm_objects.clear();
+	    for(typename std::vector<std::vector<TO> >::size_type
+		    i = 0; i < segments.size(); ++i) {
+		if(segments[i].empty())
+		    continue;
+		index.dm_begins.push_back(boundaries[i]);
+		index.dm_ends.push_back(boundaries[i + 1]);
+		index.dm_objects.insert(index.dm_objects.end(),
+					segments[i].begin(), segments[i].end());
+		index.dm_offsets.push_back(index.dm_objects.size());
+	    }
+
+	    index.dm_is_built = true;
+	}
+
+    };
+
+
+
+} }
+
+
+
+#endif
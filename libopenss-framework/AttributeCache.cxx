@@ -0,0 +1,632 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Definition of the AttributeCache class.
+ *
+ */
+
+#include "AttributeCache.hxx"
+#include "Guard.hxx"
+
+#include <stdlib.h>
+
+using namespace OpenSpeedShop::Framework;
+
+
+
+//
+// Note: See the note in Function.cxx regarding <demangle.h>.
+//
+
+#if !defined (DEMANGLE_H)
+
+#define DMGL_NO_OPTS	 0		/* For readability... */
+#define DMGL_PARAMS	 (1 << 0)	/* Include function args */
+#define DMGL_ANSI	 (1 << 1)	/* Include const, volatile, etc */
+
+extern "C" char* cplus_demangle(const char*, int);
+
+#endif
+
+
+
+namespace {
+
+    /**
+     * Number of lookups that must find a database unchanged before one of its
+     * tables is (re)loaded. Keeps code interleaving database changes with a
+     * few lookups from repeatedly reloading entire tables.
+     */
+    const unsigned LookupsBeforeLoad = 64;
+
+    /** Intern a string. */
+    const std::string* intern(std::set<std::string>& strings,
+			      const std::string& value)
+    {
+	return &*strings.insert(value).first;
+    }
+
+    /** Store a value for an entry identifier into a column. */
+    template <typename T>
+    void store(std::vector<T>& column, const int& entry, const T& value)
+    {
+	if(static_cast<typename std::vector<T>::size_type>(entry) >=
+	   column.size())
+	    column.resize(entry + 1, T());
+	column[entry] = value;
+    }
+
+}
+
+
+
+/**
+ * Get a function's linked object.
+ *
+ * @param database         Database containing the function.
+ * @param entry            Identifier of the function.
+ * @retval linked_object   Identifier of the linked object containing the
+ *                         function.
+ * @return                 Boolean "true" if the linked object was found in the
+ *                         cache, "false" otherwise.
+ */
+bool AttributeCache::getFunctionLinkedObject(const SmartPtr<Database>& database,
+					     const int& entry,
+					     int& linked_object)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_functions))
+	return false;
+    Functions& functions = dm_attributes[database].dm_functions;
+    if(!functions.isPresent(entry))
+	return false;
+
+    linked_object = functions.dm_linked_objects[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a function's mangled name.
+ *
+ * @param database    Database containing the function.
+ * @param entry       Identifier of the function.
+ * @retval name       Mangled name of the function.
+ * @return            Boolean "true" if the name was found in the cache,
+ *                    "false" otherwise.
+ */
+bool AttributeCache::getFunctionMangledName(const SmartPtr<Database>& database,
+					    const int& entry,
+					    std::string& name)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_functions))
+	return false;
+    Functions& functions = dm_attributes[database].dm_functions;
+    if(!functions.isPresent(entry))
+	return false;
+
+    name = *functions.dm_names[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a function's demangled name.
+ *
+ * Demangles the function's name the first time it is requested, and remembers
+ * the demangled name for later requests.
+ *
+ * @param database    Database containing the function.
+ * @param entry       Identifier of the function.
+ * @param all         Boolean "true" if all available information should be
+ *                    included in the demangled name, "false" otherwise.
+ * @retval name       Demangled name of the function.
+ * @return            Boolean "true" if the name was found in the cache,
+ *                    "false" otherwise.
+ */
+bool AttributeCache::getFunctionDemangledName(
+    const SmartPtr<Database>& database, const int& entry, const bool& all,
+    std::string& name
+    )
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_functions))
+	return false;
+    Functions& functions = dm_attributes[database].dm_functions;
+    if(!functions.isPresent(entry))
+	return false;
+
+    // Demangle the mangled name if it hasn't been demangled before
+    std::vector<const std::string*>& demangled_names =
+	functions.dm_demangled_names[all ? 1 : 0];
+    if(demangled_names[entry] == NULL) {
+	const std::string& mangled = *functions.dm_names[entry];
+	char* demangled =
+	    cplus_demangle(mangled.c_str(),
+			   all ? (DMGL_ANSI | DMGL_PARAMS) : DMGL_NO_OPTS);
+	if(demangled != NULL) {
+	    demangled_names[entry] = intern(functions.dm_strings, demangled);
+	    free(demangled);
+	}
+	else
+	    demangled_names[entry] = &mangled;
+    }
+
+    name = *demangled_names[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a statement's linked object.
+ *
+ * @param database         Database containing the statement.
+ * @param entry            Identifier of the statement.
+ * @retval linked_object   Identifier of the linked object containing the
+ *                         statement.
+ * @return                 Boolean "true" if the linked object was found in the
+ *                         cache, "false" otherwise.
+ */
+bool AttributeCache::getStatementLinkedObject(
+    const SmartPtr<Database>& database, const int& entry, int& linked_object
+    )
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_statements))
+	return false;
+    Statements& statements = dm_attributes[database].dm_statements;
+    if(!statements.isPresent(entry))
+	return false;
+
+    linked_object = statements.dm_linked_objects[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a statement's path.
+ *
+ * @param database    Database containing the statement.
+ * @param entry       Identifier of the statement.
+ * @retval path       Full path name of the statement's source file.
+ * @return            Boolean "true" if the path was found in the cache,
+ *                    "false" otherwise.
+ */
+bool AttributeCache::getStatementPath(const SmartPtr<Database>& database,
+				      const int& entry,
+				      std::string& path)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_statements) ||
+       !isCurrent(database, &Attributes::dm_files))
+	return false;
+    Attributes& attributes = dm_attributes[database];
+    if(!attributes.dm_statements.isPresent(entry))
+	return false;
+
+    int file = attributes.dm_statements.dm_files[entry];
+    if(!attributes.dm_files.isPresent(file) ||
+       attributes.dm_files.dm_paths[file]->empty())
+	return false;
+
+    path = *attributes.dm_files.dm_paths[file];
+    return true;
+}
+
+
+
+/**
+ * Get a statement's line number.
+ *
+ * @param database    Database containing the statement.
+ * @param entry       Identifier of the statement.
+ * @retval line       Line number of the statement.
+ * @return            Boolean "true" if the line number was found in the cache,
+ *                    "false" otherwise.
+ */
+bool AttributeCache::getStatementLine(const SmartPtr<Database>& database,
+				      const int& entry,
+				      int& line)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_statements))
+	return false;
+    Statements& statements = dm_attributes[database].dm_statements;
+    if(!statements.isPresent(entry))
+	return false;
+
+    line = statements.dm_lines[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a statement's column number.
+ *
+ * @param database    Database containing the statement.
+ * @param entry       Identifier of the statement.
+ * @retval column     Column number of the statement.
+ * @return            Boolean "true" if the column number was found in the
+ *                    cache, "false" otherwise.
+ */
+bool AttributeCache::getStatementColumn(const SmartPtr<Database>& database,
+					const int& entry,
+					int& column)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_statements))
+	return false;
+    Statements& statements = dm_attributes[database].dm_statements;
+    if(!statements.isPresent(entry))
+	return false;
+
+    column = statements.dm_columns[entry];
+    return true;
+}
+
+
+
+/**
+ * Get a linked object's path.
+ *
+ * @param database    Database containing the linked object.
+ * @param entry       Identifier of the linked object.
+ * @retval path       Full path name of the linked object.
+ * @return            Boolean "true" if the path was found in the cache,
+ *                    "false" otherwise.
+ */
+bool AttributeCache::getLinkedObjectPath(const SmartPtr<Database>& database,
+					 const int& entry,
+					 std::string& path)
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_linked_objects) ||
+       !isCurrent(database, &Attributes::dm_files))
+	return false;
+    Attributes& attributes = dm_attributes[database];
+    if(!attributes.dm_linked_objects.isPresent(entry))
+	return false;
+
+    int file = attributes.dm_linked_objects.dm_files[entry];
+    if(!attributes.dm_files.isPresent(file) ||
+       attributes.dm_files.dm_paths[file]->empty())
+	return false;
+
+    path = *attributes.dm_files.dm_paths[file];
+    return true;
+}
+
+
+
+/**
+ * Test if a linked object is an executable.
+ *
+ * @param database          Database containing the linked object.
+ * @param entry             Identifier of the linked object.
+ * @retval is_executable    Boolean "true" if the linked object is an
+ *                          executable, "false" otherwise.
+ * @return                  Boolean "true" if the flag was found in the cache,
+ *                          "false" otherwise.
+ */
+bool AttributeCache::getLinkedObjectIsExecutable(
+    const SmartPtr<Database>& database, const int& entry, bool& is_executable
+    )
+{
+    Guard guard_myself(this);
+
+    if(!isCurrent(database, &Attributes::dm_linked_objects))
+	return false;
+    LinkedObjects& linked_objects = dm_attributes[database].dm_linked_objects;
+    if(!linked_objects.isPresent(entry))
+	return false;
+
+    is_executable = linked_objects.dm_is_executable[entry] != 0;
+    return true;
+}
+
+
+
+/**
+ * Remove a database.
+ *
+ * Removes all the attributes in the passed database from the cache.
+ *
+ * @param database    Database to be removed from the cache.
+ */
+void AttributeCache::removeDatabase(const SmartPtr<Database>& database)
+{
+    Guard guard_myself(this);
+
+    dm_attributes.erase(database);
+}
+
+
+/**
+ * Test if a table is current.
+ *
+ * Returns a boolean value indicating if the passed table may be used to answer
+ * a lookup. The table is never used while the calling thread has uncommitted
+ * changes to its database. A table whose database has changed since it was
+ * loaded is first discarded. The table is then (re)loaded once enough lookups
+ * have found its database unchanged.
+ *
+ * @note    The table is loaded without holding the cache's lock so that other
+ *          threads' lookups aren't blocked behind the load's transaction, and
+ *          is only installed if its database remains cached and unchanged.
+ *          The lookup triggering the load is left to the database, because
+ *          the other cached tables may have changed while the lock was free.
+ *
+ * @pre     The cache's lock must be held by the caller.
+ *
+ * @param database    Database containing the table.
+ * @param member      Table to be tested.
+ * @return            Boolean "true" if the table is current, "false"
+ *                    otherwise.
+ */
+template <typename T>
+bool AttributeCache::isCurrent(const SmartPtr<Database>& database,
+			       T Attributes::* member)
+{
+    // Bypass the cache while this thread's transaction has changed the database
+    if(database->hasUncommittedChanges())
+	return false;
+
+    uint64_t generation = database->getGeneration();
+    T& table = dm_attributes[database].*member;
+
+    if(table.dm_is_loaded) {
+	if(table.dm_generation == generation)
+	    return true;
+	table.dm_is_loaded = false;
+	table.dm_is_present.clear();
+    }
+
+    // Count the lookups that have found the database unchanged
+    if(generation != table.dm_last_generation) {
+	table.dm_last_generation = generation;
+	table.dm_lookups = 0;
+    }
+    if((++table.dm_lookups < LookupsBeforeLoad) || table.dm_is_loading)
+	return false;
+    table.dm_is_loading = true;
+
+    // Load the table without holding the lock
+    T loaded;
+    releaseLock();
+    try {
+	loaded.load(database);
+    }
+    catch(...) {
+	acquireLock();
+	std::map<SmartPtr<Database>, Attributes>::iterator
+	    i = dm_attributes.find(database);
+	if(i != dm_attributes.end())
+	    (i->second.*member).dm_is_loading = false;
+	throw;
+    }
+    acquireLock();
+
+    // Install the table if its database is still cached and unchanged
+    std::map<SmartPtr<Database>, Attributes>::iterator
+	i = dm_attributes.find(database);
+    if(i == dm_attributes.end())
+	return false;
+    T& current = i->second.*member;
+    current.dm_is_loading = false;
+    if(database->getGeneration() == generation) {
+	current.swap(loaded);
+	current.dm_is_loaded = true;
+	current.dm_generation = generation;
+    }
+    return false;
+}
+
+
+
+/**
+ * Load the functions.
+ *
+ * Loads the linked object and mangled name of every function in the passed
+ * database. Demangled names are computed later, on demand.
+ *
+ * @param database    Database containing the functions.
+ */
+void AttributeCache::Functions::load(const SmartPtr<Database>& database)
+{
+    BEGIN_TRANSACTION(database);
+    database->prepareStatement(
+	"SELECT id, linked_object, name FROM Functions;"
+	);
+    while(database->executeStatement()) {
+	int entry = database->getResultAsInteger(1);
+	if((entry < 0) || database->getResultIsNull(3))
+	    continue;
+	store(dm_is_present, entry, true);
+	store(dm_linked_objects, entry, database->getResultAsInteger(2));
+	store(dm_names, entry,
+	      intern(dm_strings, database->getResultAsString(3)));
+    }
+    END_TRANSACTION(database);
+
+    for(int i = 0; i < 2; ++i)
+	dm_demangled_names[i].assign(dm_names.size(), NULL);
+}
+
+
+
+/**
+ * Swap the functions.
+ *
+ * Exchanges the contents, but not the state, of this table with another.
+ *
+ * @param other    Table with which to exchange contents.
+ */
+void AttributeCache::Functions::swap(Functions& other)
+{
+    swapContents(other);
+    dm_linked_objects.swap(other.dm_linked_objects);
+    dm_names.swap(other.dm_names);
+    for(int i = 0; i < 2; ++i)
+	dm_demangled_names[i].swap(other.dm_demangled_names[i]);
+}
+
+
+
+/**
+ * Load the statements.
+ *
+ * Loads the linked object, source file, line number, and column number of
+ * every statement in the passed database.
+ *
+ * @param database    Database containing the statements.
+ */
+void AttributeCache::Statements::load(const SmartPtr<Database>& database)
+{
+    BEGIN_TRANSACTION(database);
+    database->prepareStatement(
+	"SELECT id, linked_object, file, line, \"column\" FROM Statements;"
+	);
+    while(database->executeStatement()) {
+	int entry = database->getResultAsInteger(1);
+	if(entry < 0)
+	    continue;
+	store(dm_is_present, entry, true);
+	store(dm_linked_objects, entry, database->getResultAsInteger(2));
+	store(dm_files, entry, database->getResultAsInteger(3));
+	store(dm_lines, entry, database->getResultAsInteger(4));
+	store(dm_columns, entry, database->getResultAsInteger(5));
+    }
+    END_TRANSACTION(database);
+}
+
+
+
+/**
+ * Swap the statements.
+ *
+ * Exchanges the contents, but not the state, of this table with another.
+ *
+ * @param other    Table with which to exchange contents.
+ */
+void AttributeCache::Statements::swap(Statements& other)
+{
+    swapContents(other);
+    dm_linked_objects.swap(other.dm_linked_objects);
+    dm_files.swap(other.dm_files);
+    dm_lines.swap(other.dm_lines);
+    dm_columns.swap(other.dm_columns);
+}
+
+
+
+/**
+ * Load the files.
+ *
+ * Loads the full path name of every file in the passed database.
+ *
+ * @param database    Database containing the files.
+ */
+void AttributeCache::Files::load(const SmartPtr<Database>& database)
+{
+    BEGIN_TRANSACTION(database);
+    database->prepareStatement("SELECT id, path FROM Files;");
+    while(database->executeStatement()) {
+	int entry = database->getResultAsInteger(1);
+	if((entry < 0) || database->getResultIsNull(2))
+	    continue;
+	store(dm_is_present, entry, true);
+	store(dm_paths, entry,
+	      intern(dm_strings, database->getResultAsString(2)));
+    }
+    END_TRANSACTION(database);
+}
+
+
+
+/**
+ * Swap the files.
+ *
+ * Exchanges the contents, but not the state, of this table with another.
+ *
+ * @param other    Table with which to exchange contents.
+ */
+void AttributeCache::Files::swap(Files& other)
+{
+    swapContents(other);
+    dm_paths.swap(other.dm_paths);
+}
+
+
+
+/**
+ * Load the linked objects.
+ *
+ * Loads the file and executable flag of every linked object in the passed
+ * database.
+ *
+ * @param database    Database containing the linked objects.
+ */
+void AttributeCache::LinkedObjects::load(const SmartPtr<Database>& database)
+{
+    BEGIN_TRANSACTION(database);
+    database->prepareStatement(
+	"SELECT id, file, is_executable FROM LinkedObjects;"
+	);
+    while(database->executeStatement()) {
+	int entry = database->getResultAsInteger(1);
+	if(entry < 0)
+	    continue;
+	store(dm_is_present, entry, true);
+	store(dm_files, entry, database->getResultAsInteger(2));
+	store(dm_is_executable, entry,
+	      static_cast<char>(database->getResultAsInteger(3) != 0));
+    }
+    END_TRANSACTION(database);
+}
+
+
+
+/**
+ * Swap the linked objects.
+ *
+ * Exchanges the contents, but not the state, of this table with another.
+ *
+ * @param other    Table with which to exchange contents.
+ */
+void AttributeCache::LinkedObjects::swap(LinkedObjects& other)
+{
+    swapContents(other);
+    dm_files.swap(other.dm_files);
+    dm_is_executable.swap(other.dm_is_executable);
+}
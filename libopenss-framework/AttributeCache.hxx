@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+//
+// This library is free software; you can redistribute it and/or modify it under
+// the terms of the GNU Lesser General Public License as published by the Free
+// Software Foundation; either version 2.1 of the License, or (at your option)
+// any later version.
+//
+// This library is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+// FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+// details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation, Inc.,
+// 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+////////////////////////////////////////////////////////////////////////////////
+
+/** @file
+ *
+ * Declaration of the AttributeCache class.
+ *
+ */
+
+#ifndef _OpenSpeedShop_Framework_AttributeCache_
+#define _OpenSpeedShop_Framework_AttributeCache_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "Database.hxx"
+#include "Lockable.hxx"
+#include "SmartPtr.hxx"
+
+#ifdef HAVE_INTTYPES_H
+#include <inttypes.h>
+#endif
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+
+namespace OpenSpeedShop { namespace Framework {
+
+    /**
+     * Entry attribute cache.
+     *
+     * Cache of the attributes (names, paths, line numbers, etc.) of the
+     * functions, statements, and linked objects stored on a per database basis.
+     * Each of the Functions, Statements, Files, and LinkedObjects tables is
+     * loaded in its entirety, with one query, into arrays indexed by entry
+     * identifier. All strings are interned so that each distinct name or path
+     * is stored only once per table. Demangled function names are computed on
+     * demand and then remembered.
+     *
+     * A table is discarded whenever its database is changed, and is reloaded
+     * only once the database has remained unchanged for a number of lookups.
+     * Tables are loaded without holding the cache's lock. The cache is bypassed
+     * by a thread whose in-progress transaction has changed the database, since
+     * those changes don't advance the database's generation until committed.
+     * Queries that cannot be answered from the cache return "false", and the
+     * caller is then expected to query the database directly.
+     *
+     * @note    The attributes of an entry were previously found with a single-
+     *          row query within its own transaction. Views sorting and
+     *          formatting functions and statements make so many of these
+     *          queries that the per-query overhead dominated. This class
+     *          alleviates that bottleneck by caching the attributes in memory.
+     *
+     * @ingroup Implementation
+     */
+    class AttributeCache :
+	private Lockable
+    {
+
+    public:
+
+	bool getFunctionLinkedObject(const SmartPtr<Database>&, const int&,
+				     int&);
+	bool getFunctionMangledName(const SmartPtr<Database>&, const int&,
+				    std::string&);
+	bool getFunctionDemangledName(const SmartPtr<Database>&, const int&,
+				      const bool&, std::string&);
+
+	bool getStatementLinkedObject(const SmartPtr<Database>&, const int&,
+				      int&);
+	bool getStatementPath(const SmartPtr<Database>&, const int&,
+			      std::string&);
+	bool getStatementLine(const SmartPtr<Database>&, const int&, int&);
+	bool getStatementColumn(const SmartPtr<Database>&, const int&, int&);
+
+	bool getLinkedObjectPath(const SmartPtr<Database>&, const int&,
+				 std::string&);
+	bool getLinkedObjectIsExecutable(const SmartPtr<Database>&, const int&,
+					 bool&);
+
+	void removeDatabase(const SmartPtr<Database>&);
+
+    private:
+
+	/** State of a single cached table. */
+	struct Table
+	{
+	    /** Flag indicating if the table has been loaded. */
+	    bool dm_is_loaded;
+
+	    /** Flag indicating if the table is being loaded. */
+	    bool dm_is_loading;
+
+	    /** Database generation at which the table was loaded. */
+	    uint64_t dm_generation;
+
+	    /** Database generation seen by the most recent lookup. */
+	    uint64_t dm_last_generation;
+
+	    /** Number of lookups that have seen that same generation. */
+	    unsigned dm_lookups;
+
+	    /** Flag indicating which entry identifiers are present. */
+	    std::vector<bool> dm_is_present;
+
+	    /** Strings interned by this table. */
+	    std::set<std::string> dm_strings;
+
+	    /** Default constructor. */
+	    Table() :
+		dm_is_loaded(false),
+		dm_is_loading(false),
+		dm_generation(0),
+		dm_last_generation(0),
+		dm_lookups(0),
+		dm_is_present(),
+		dm_strings()
+	    {
+	    }
+
+	    /** Test if the given entry identifier is present. */
+	    bool isPresent(const int& entry) const
+	    {
+		return (entry >= 0) &&
+		    (static_cast<std::vector<bool>::size_type>(entry) <
+		     dm_is_present.size()) &&
+		    dm_is_present[entry];
+	    }
+
+	    /** Exchange contents, but not state, with another table. */
+	    void swapContents(Table& other)
+	    {
+		dm_is_present.swap(other.dm_is_present);
+		dm_strings.swap(other.dm_strings);
+	    }
+	};
+
+	/** Functions table. */
+	struct Functions :
+	    public Table
+	{
+	    /** Linked object containing each function. */
+	    std::vector<int> dm_linked_objects;
+
+	    /** Mangled name of each function. */
+	    std::vector<const std::string*> dm_names;
+
+	    /** Demangled name, without and with all information, of each. */
+	    std::vector<const std::string*> dm_demangled_names[2];
+
+	    void load(const SmartPtr<Database>&);
+	    void swap(Functions&);
+	};
+
+	/** Statements table. */
+	struct Statements :
+	    public Table
+	{
+	    /** Linked object containing each statement. */
+	    std::vector<int> dm_linked_objects;
+
+	    /** Source file of each statement. */
+	    std::vector<int> dm_files;
+
+	    /** Line number of each statement. */
+	    std::vector<int> dm_lines;
+
+	    /** Column number of each statement. */
+	    std::vector<int> dm_columns;
+
+	    void load(const SmartPtr<Database>&);
+	    void swap(Statements&);
+	};
+
+	/** Files table. */
+	struct Files :
+	    public Table
+	{
+	    /** Full path name of each file. */
+	    std::vector<const std::string*> dm_paths;
+
+	    void load(const SmartPtr<Database>&);
+	    void swap(Files&);
+	};
+
+	/** LinkedObjects table. */
+	struct LinkedObjects :
+	    public Table
+	{
+	    /** File of each linked object. */
+	    std::vector<int> dm_files;
+
+	    /** Executable flag of each linked object. */
+	    std::vector<char> dm_is_executable;
+
+	    void load(const SmartPtr<Database>&);
+	    void swap(LinkedObjects&);
+	};
+
+	/** Cached attributes of a single database. */
+	struct Attributes
+	{
+	    /** Functions table. */
+	    Functions dm_functions;
+
+	    /** Statements table. */
+	    Statements dm_statements;
+
+	    /** Files table. */
+	    Files dm_files;
+
+	    /** LinkedObjects table. */
+	    LinkedObjects dm_linked_objects;
+	};
+
+	/** Cached attributes of each database. */
+	std::map<SmartPtr<Database>, Attributes> dm_attributes;
+
+	template <typename T>
+	bool isCurrent(const SmartPtr<Database>&, T Attributes::*);
+
+    };
+
+
+
+} }
+
+
+
+#endif
@@ -36,6 +36,7 @@
 #define HAVE_DECL_BASENAME 1
 #include <libiberty.h>
 
+#include "Assert.hxx"
 #include "ToolAPI.hxx"
 #include "BFDSymbols.hxx"
 #include "Path.hxx"
@@ -47,30 +48,53 @@
 #include <stdint.h>
 #include <dis-asm.h>
 #include <algorithm>
+#include <pthread.h>
 
 
-// bfd symbols for current linkedobject
-static asymbol **syms;
-static long numsyms;
+using namespace OpenSpeedShop::Framework;
 
-// Sorted bfd symbols for current linkedobject
-// Used to find function begin and end addresses.
-static asymbol **sortedsyms;
-static long numsortedsyms;
+namespace {
 
-static int init_done = 0;
+    /** Once-only initialization control for the BFD library. */
+    pthread_once_t bfd_init_once = PTHREAD_ONCE_INIT;
 
-// statics used by find_address_in_section and bfd_find_nearest_line.
-static bfd  *theBFD;
-static bfd_vma pc;
-static bfd_vma obj_base;
-static bfd_boolean found;
-static bool debug_symbols = false;
+    /** Flag indicating if the BFD library may be used by several threads. */
+    bool is_bfd_thread_safe = false;
 
-using namespace OpenSpeedShop::Framework;
+#if defined(HAVE_BFD_THREAD_INIT)
+    /** Mutual exclusion lock given to the BFD library. */
+    pthread_mutex_t bfd_lock = PTHREAD_MUTEX_INITIALIZER;
+
+    /** Lock the BFD library's global state. */
+    bool lockBFD(void*)
+    {
+	return pthread_mutex_lock(&bfd_lock) == 0;
+    }
+
+    /** Unlock the BFD library's global state. */
+    bool unlockBFD(void*)
+    {
+	return pthread_mutex_unlock(&bfd_lock) == 0;
+    }
+#endif
+
+    /**
+     * Initialize the BFD library.
+     *
+     * Must be called exactly once (via pthread_once) before any other use of
+     * the BFD library. When the library supports it (binutils 2.42 and later),
+     * it is also told to serialize access to its own global state, allowing
+     * several threads to each resolve symbols from their own bfd handle.
+     */
+    void initializeBFD()
+    {
+	bfd_init();
+#if defined(HAVE_BFD_THREAD_INIT)
+	is_bfd_thread_safe = bfd_thread_init(lockBFD, unlockBFD, NULL);
+#endif
+    }
 
-static StatementsVec statementvec;
-static FunctionsVec functionvec;
+}
 
 #ifndef NDEBUG
 /** Flag indicating if debuging for offline symbols is enabled. */
@@ -93,6 +117,37 @@ static void bfdErrHandler (const char *s, ...)
 }
 #endif
 
+BFDSymbols::BFDSymbols() :
+    init_done(0),
+    syms(NULL),
+    numsyms(0),
+    sortedsyms(NULL),
+    numsortedsyms(0),
+    theBFD(NULL),
+    pc(0),
+    obj_base(0),
+    found(false),
+    statementvec(),
+    functionvec()
+{
+}
+
+/**
+ * Test if symbols may be resolved concurrently.
+ *
+ * Returns a boolean value indicating if the BFD library may be used by several
+ * threads at once, each with its own BFDSymbols object. Requires a version of
+ * the BFD library providing bfd_thread_init().
+ *
+ * @return    Boolean "true" if symbols may be resolved concurrently, "false"
+ *            otherwise.
+ */
+bool BFDSymbols::isThreadSafe()
+{
+    Assert(pthread_once(&bfd_init_once, initializeBFD) == 0);
+    return is_bfd_thread_safe;
+}
+
 // lifted from objdump
 void BFDSymbols::slurp_symtab (bfd *abfd)
 {
@@ -715,7 +770,7 @@ BFDSymbols::getFunctionSyms (PCBuffer *addrbuf,
 }
 
 int
-BFDSymbols::getFunctionSyms (std::set<Address>& addresses, AddressRange& range_in_this_obj)
+BFDSymbols::getFunctionSyms (const std::set<Address>& addresses, AddressRange& range_in_this_obj)
 {
 
 #ifndef NDEBUG
@@ -731,9 +786,9 @@ BFDSymbols::getFunctionSyms (std::set<Address>& addresses, AddressRange& range_i
 	return 0;
     }
 
-    std::set<Address>::iterator ai;
-    std::set<Address>::iterator ai_begin = addresses.equal_range(range_in_this_obj.getBegin()).first;
-    std::set<Address>::iterator ai_end = addresses.equal_range(range_in_this_obj.getEnd()).second;
+    std::set<Address>::const_iterator ai;
+    std::set<Address>::const_iterator ai_begin = addresses.equal_range(range_in_this_obj.getBegin()).first;
+    std::set<Address>::const_iterator ai_end = addresses.equal_range(range_in_this_obj.getEnd()).second;
 
     /* We make a copy of syms to sort.  We don't want to sort syms
        because that will screw up any relocs.  */
@@ -1112,7 +1167,7 @@ BFDSymbols::getFunctionSyms (std::set<Address>& addresses, AddressRange& range_i
 
 int BFDSymbols::initBFD (std::string filename)
 {
-    bfd_init();
+    Assert(pthread_once(&bfd_init_once, initializeBFD) == 0);
 
 #if 0
     /* binutils 2.23/2.24 use this definition */
@@ -1145,9 +1200,14 @@ int BFDSymbols::initBFD (std::string filename)
 }
 
 // Callback for bfd_map_over_sections to find nearest line.
-void
-find_address_in_section (bfd *theBFD, asection *section,
-                         void *data ATTRIBUTE_UNUSED)
+void BFDSymbols::find_address_in_section (bfd * /* abfd */, asection *section,
+					  void *data)
+{
+    reinterpret_cast<BFDSymbols*>(data)->find_address_in_section(section);
+}
+
+// Find the nearest line to pc within a single section.
+void BFDSymbols::find_address_in_section (asection *section)
 {
     bfd_vma vma;
     bfd_size_type size;
@@ -1197,7 +1257,7 @@ find_address_in_section (bfd *theBFD, asection *section,
     if (!found) {
 // DEBUG
 #ifndef NDEBUG
-	if(debug_symbols) {
+	if(is_debug_symbols_enabled) {
 	    std::cerr << "find_address_in_section: "
 	    << " bfd_find_nearest_line FAILS FOR " << Address(pc) << std::endl;
 	}
@@ -1210,7 +1270,7 @@ find_address_in_section (bfd *theBFD, asection *section,
 
 // DEBUG
 #ifndef NDEBUG
-    if(debug_symbols) {
+    if(is_debug_symbols_enabled) {
       std::cerr << "find_address_in_section: addr[" << Address(pc) << "]"
 	<< " func[" << tfunc << "]"
 	<< " file[" << tfile << "]"
@@ -1284,15 +1344,10 @@ Path BFDSymbols::getObjectFile(Path filename)
 int
 BFDSymbols::getBFDFunctionStatements(PCBuffer *addrbuf,
 				     const LinkedObject& linkedobject,
-				     SymbolTableMap& stmap)
+				     const SymbolTableMap& stmap)
 {
     int rval = -1;
     init_done = 0;
-#ifndef NDEBUG
-    if(is_debug_symbols_enabled) {
-	debug_symbols = true;
-    }
-#endif
 
     std::string filename = linkedobject.getPath();
     std::set<AddressRange> lorange = linkedobject.getAddressRange();
@@ -1444,7 +1499,7 @@ BFDSymbols::getBFDFunctionStatements(PCBuffer *addrbuf,
 #endif
 
 	    rval = addresses_found;
-	    bfd_map_over_sections (theBFD, find_address_in_section, NULL);
+	    bfd_map_over_sections (theBFD, find_address_in_section, this);
 	}
     }
 
@@ -1455,7 +1510,7 @@ BFDSymbols::getBFDFunctionStatements(PCBuffer *addrbuf,
 					  ++fi) {
 	found = false;
 	pc = (*fi).getValue();
-        bfd_map_over_sections (theBFD, find_address_in_section, NULL);
+        bfd_map_over_sections (theBFD, find_address_in_section, this);
     }
 
     if (syms) {
@@ -1484,17 +1539,12 @@ BFDSymbols::getBFDFunctionStatements(PCBuffer *addrbuf,
 
 
 int
-BFDSymbols::getBFDFunctionStatements(std::set<Address>& addresses,
+BFDSymbols::getBFDFunctionStatements(const std::set<Address>& addresses,
 				     const LinkedObject& linkedobject,
-				     SymbolTableMap& stmap)
+				     const SymbolTableMap& stmap)
 {
     int rval = -1;
     init_done = 0;
-#ifndef NDEBUG
-    if(is_debug_symbols_enabled) {
-	debug_symbols = true;
-    }
-#endif
 
     std::string filename = linkedobject.getPath();
     std::set<AddressRange> lorange = linkedobject.getAddressRange();
@@ -1527,9 +1577,9 @@ BFDSymbols::getBFDFunctionStatements(std::set<Address>& addresses,
 #endif
 
 	// find the subset of addresses within the range of symtab si.
-	std::set<Address>::iterator ai;
-	std::set<Address>::iterator ai_begin = addresses.equal_range((*si).getBegin()).first;
-	std::set<Address>::iterator ai_end = addresses.equal_range((*si).getEnd()).second;
+	std::set<Address>::const_iterator ai;
+	std::set<Address>::const_iterator ai_begin = addresses.equal_range((*si).getBegin()).first;
+	std::set<Address>::const_iterator ai_end = addresses.equal_range((*si).getEnd()).second;
 
 	// DSO OFFSET. Pass address object was loaded at in victim process.
 	// The file /proc/self/maps has this info.
@@ -1635,7 +1685,7 @@ BFDSymbols::getBFDFunctionStatements(std::set<Address>& addresses,
 #endif
 
 	    rval = addresses_found;
-	    bfd_map_over_sections (theBFD, find_address_in_section, NULL);
+	    bfd_map_over_sections (theBFD, find_address_in_section, this);
 	}
     }
 
@@ -1646,7 +1696,7 @@ BFDSymbols::getBFDFunctionStatements(std::set<Address>& addresses,
 					  ++fi) {
 	found = false;
 	pc = (*fi).getValue();
-        bfd_map_over_sections (theBFD, find_address_in_section, NULL);
+        bfd_map_over_sections (theBFD, find_address_in_section, this);
     }
 
     if (syms) {
@@ -1829,16 +1879,78 @@ BFDSymbols::getSymbols(PCBuffer *addrbuf,
     statementvec.clear();
 }
 
+/**
+ * Get the functions and statements of a linked object.
+ *
+ * Resolves the sampled addresses within the specified linked object and then
+ * stores the resulting functions and statements into the symbol table map.
+ *
+ * @param addresses    Sampled addresses to be resolved.
+ * @param lo           Linked object whose symbols are to be resolved.
+ * @param stmap        Symbol table map receiving the symbols.
+ */
 void
 BFDSymbols::getSymbols(std::set<Address>& addresses,
 		       const LinkedObject& lo, SymbolTableMap& stmap)
+{
+    resolveSymbols(addresses, lo, stmap);
+    storeSymbols(lo, stmap);
+}
+
+/**
+ * Resolve the functions and statements of a linked object.
+ *
+ * Finds the functions and statements containing the sampled addresses within
+ * the specified linked object, holding them within this object until they are
+ * stored by storeSymbols(). The symbol table map is only read, so different
+ * linked objects may be resolved concurrently by different BFDSymbols objects
+ * when isThreadSafe() is true.
+ *
+ * @param addresses    Sampled addresses to be resolved.
+ * @param lo           Linked object whose symbols are to be resolved.
+ * @param stmap        Symbol table map that will receive the symbols.
+ */
+void
+BFDSymbols::resolveSymbols(const std::set<Address>& addresses,
+			   const LinkedObject& lo, const SymbolTableMap& stmap)
 {
 #ifndef NDEBUG
     if(is_debug_symbols_enabled) {
-	std::cerr << "BFDSymbols::getSymbols: ENTERED.. addresses size:" << addresses.size() << std::endl;
+	std::cerr << "BFDSymbols::resolveSymbols: ENTERED.. addresses size:" << addresses.size() << std::endl;
     }
 #endif
 
+    std::set<AddressRange> lorange = lo.getAddressRange();
+    for(std::set<AddressRange>::iterator si = lorange.begin();
+	si != lorange.end(); ++si) {
+	AddressRange lrange = (*si);
+
+// DEBUG
+#ifndef NDEBUG
+	if(is_debug_symbols_enabled) {
+	     std::cerr  << "BFDSymbols::resolveSymbols: RESOLVING LO " << lo.getPath()
+		 << ":" << lrange << std::endl;
+	}
+#endif
+	// addressrange lrange may not be the one in stmap.
+	if (stmap.find(lrange) != stmap.end()) {
+	    getBFDFunctionStatements(addresses, lo, stmap);
+	}
+    }
+}
+
+/**
+ * Store the functions and statements of a linked object.
+ *
+ * Adds the functions and statements previously found by resolveSymbols() to
+ * the symbol table map and then discards them from this object.
+ *
+ * @param lo       Linked object whose symbols were resolved.
+ * @param stmap    Symbol table map receiving the symbols.
+ */
+void
+BFDSymbols::storeSymbols(const LinkedObject& lo, SymbolTableMap& stmap)
+{
     // LinkedObject::getAddressRange actually returns the
     // set of AddressSpaces found in the database where the
     // LinkedObject actually was loaded into memory.
@@ -1850,7 +1962,7 @@ BFDSymbols::getSymbols(std::set<Address>& addresses,
     for(si = lorange.begin() ; si != lorange.end(); ++si) {
 #ifndef NDEBUG
 	if(is_debug_symbols_enabled) {
-	     std::cerr  << "BFDSymbols::getSymbols: RESOLVING LO " << lo.getPath()
+	     std::cerr  << "BFDSymbols::storeSymbols: RESOLVING LO " << lo.getPath()
 		 << ":" << *si << std::endl;
 	}
 #endif
@@ -1860,124 +1972,108 @@ BFDSymbols::getSymbols(std::set<Address>& addresses,
 // DEBUG
 #ifndef NDEBUG
 	    if(is_debug_symbols_enabled) {
-	        std::cerr << "BFDSymbols::getSymbols: " << " stmap RANGE " << *si << std::endl;
+	        std::cerr << "BFDSymbols::storeSymbols: " << " stmap RANGE " << *si << std::endl;
 	    }
 #endif
 	}
     }
 
-    for(si = lorange.begin() ; si != lorange.end(); ++si) {
-	AddressRange lrange = (*si);
-
-// DEBUG
+    // Add Functions
+    // RESTRICT functions to only those with sampled addresses.
+    // We need to remember that some sampled addresses may come
+    // from an addressspace OTHER than the one used for the
+    // SymbolTableMap.  Need to compute an offset for those. somehow.
+
+    for(FunctionsVec::iterator f = functionvec.begin();
+			       f != functionvec.end(); ++f) {
+
+	AddressRange frange(f->getFuncBegin(),f->getFuncEnd());
+
+	// See if the function range is inclosed by any addressspace
+	// in the SymbolTableMap. If it is found in the addressrange
+	// used to create the symboltable entry we can use it straight away.
+	// Otherwise we need to find the addressspace the function was
+	// sampled in and compute an offset to the stmap addressrange.
+	if (stmap.find(frange) != stmap.end()) {
+	    SymbolTable& symbol_table =
+				stmap.find(frange)->second.first;
+//DEBUG
 #ifndef NDEBUG
-	if(is_debug_symbols_enabled) {
-	     std::cerr  << "BFDSymbols::getSymbols: RESOLVING LO " << lo.getPath()
-		 << ":" << lrange << std::endl;
-	}
+	    if(is_debug_symbols_enabled) {
+		std::cerr << "BFDSymbols::storeSymbols: "
+		    << "ADDING FUNCTION for " << f->getFuncName()
+		    << " with range " << frange << std::endl;
+	    }
 #endif
-	// addressrange lrange may not be the one in stmap.
-	if (stmap.find(lrange) != stmap.end()) {
-	    int addresses_found =
-		getBFDFunctionStatements(addresses, lo, stmap);
-	    
-	    // Add Functions
-	    // RESTRICT functions to only those with sampled addresses.
-	    // We need to remember that some sampled addresses may come
-	    // from an addressspace OTHER than the one used for the
-	    // SymbolTableMap.  Need to compute an offset for those. somehow.
 
-	    for(FunctionsVec::iterator f = functionvec.begin();
-				       f != functionvec.end(); ++f) {
+	    symbol_table.addFunction(f->getFuncBegin(),
+				     f->getFuncEnd(), f->getFuncName());
 
-		AddressRange frange(f->getFuncBegin(),f->getFuncEnd());
+	} else {
+	    std::set<AddressRange>::iterator li;
+	    for(li = lorange.begin() ; li != lorange.end(); ++li) {
+		if ((*li).doesContain(frange)) {
 
-		// See if the function range is inclosed by any addressspace
-		// in the SymbolTableMap. If it is found in the addressrange
-		// used to create the symboltable entry we can use it straight away.
-		// Otherwise we need to find the addressspace the function was
-		// sampled in and compute an offset to the stmap addressrange.
-		if (stmap.find(frange) != stmap.end()) {
-		    SymbolTable& symbol_table =
-					stmap.find(frange)->second.first;
+		    Address offset(stmap_lorange.getBegin() - (*li).getBegin());
 //DEBUG
 #ifndef NDEBUG
 		    if(is_debug_symbols_enabled) {
-			std::cerr << "BFDSymbols::getSymbols: "
-			    << "ADDING FUNCTION for " << f->getFuncName()
-			    << " with range " << frange << std::endl;
+			std::cerr << "BFDSymbols::storeSymbols: " << f->getFuncName()
+			<< " with range " << frange
+			<< " found in alternate " << (*li)
+			<< " offset is " << offset
+			<< std::endl;
 		    }
 #endif
+		    // the real symboltable for this function.
+		    SymbolTable& symbol_table =
+				stmap.find(stmap_lorange)->second.first;
 
-		    symbol_table.addFunction(f->getFuncBegin(),
-					     f->getFuncEnd(), f->getFuncName());
-
-		} else {
-		    std::set<AddressRange>::iterator li;
-		    for(li = lorange.begin() ; li != lorange.end(); ++li) {
-			if ((*li).doesContain(frange)) {
+		    // compute new start and end to fit stmap_lorange.
+		    Address start(f->getFuncBegin().getValue() +
+				  offset.getValue());
+		    Address end(f->getFuncEnd().getValue() +
+				  offset.getValue());
 
-			    Address offset(stmap_lorange.getBegin() - (*li).getBegin());
-//DEBUG
-#ifndef NDEBUG
-			    if(is_debug_symbols_enabled) {
-			        std::cerr << "BFDSymbols::getSymbols: " << f->getFuncName()
-				<< " with range " << frange
-				<< " found in alternate " << (*li)
-				<< " offset is " << offset
-				<< std::endl;
-			    }
-#endif
-			    // the real symboltable for this function.
-		    	    SymbolTable& symbol_table =
-					stmap.find(stmap_lorange)->second.first;
-
-			    // compute new start and end to fit stmap_lorange.
-			    Address start(f->getFuncBegin().getValue() +
-					  offset.getValue());
-			    Address end(f->getFuncEnd().getValue() +
-					  offset.getValue());
-
-			    // Now we can add this function
-			    symbol_table.addFunction(start, end, f->getFuncName());
-			}
-		    }
+		    // Now we can add this function
+		    symbol_table.addFunction(start, end, f->getFuncName());
 		}
 	    }
+	}
+    }
 
-	    // Add Statements
-	    // RESTRICT statements to only those with sampled addresses.
-	    // NOTE: We may need to look at offsets like we do for functions.
-
-	    for(StatementsVec::iterator objsyms = statementvec.begin() ;
-					objsyms !=  statementvec.end() ;  ++objsyms) {
-
-		AddressRange frange(objsyms->pc,objsyms->pc+1);
-		if (stmap.find(frange) != stmap.end()) {
-		    SymbolTable& symbol_table =
-					stmap.find(frange)->second.first;
-		    Address s_begin = objsyms->pc;
-		    Address s_end = objsyms->pc + 1; // HACK
-		    std::string path = objsyms->file_name;
-		    unsigned int line = objsyms->lineno;
-		    unsigned int col = 0;
+    // Add Statements
+    // RESTRICT statements to only those with sampled addresses.
+    // NOTE: We may need to look at offsets like we do for functions.
+
+    for(StatementsVec::iterator objsyms = statementvec.begin() ;
+				objsyms !=  statementvec.end() ;  ++objsyms) {
+
+	AddressRange frange(objsyms->pc,objsyms->pc+1);
+	if (stmap.find(frange) != stmap.end()) {
+	    SymbolTable& symbol_table =
+				stmap.find(frange)->second.first;
+	    Address s_begin = objsyms->pc;
+	    Address s_end = objsyms->pc + 1; // HACK
+	    std::string path = objsyms->file_name;
+	    unsigned int line = objsyms->lineno;
+	    unsigned int col = 0;
 //DEBUG
 #ifndef NDEBUG
-		    if(is_debug_symbols_enabled) {
-			std::cerr << "BFDSymbols::getSymbols:"
-			    << " ADDING STATEMENT for " << Address(objsyms->pc)
-			    << " with path " << path << " line " << line << std::endl;
-		    }
+	    if(is_debug_symbols_enabled) {
+		std::cerr << "BFDSymbols::storeSymbols:"
+		    << " ADDING STATEMENT for " << Address(objsyms->pc)
+		    << " with path " << path << " line " << line << std::endl;
+	    }
 #endif
 
-		    if (path.size() != 0) {
-			symbol_table.addStatement(s_begin,s_end,path,line,col);
-		    }
-		} else {
-		}
+	    if (path.size() != 0) {
+		symbol_table.addStatement(s_begin,s_end,path,line,col);
 	    }
+	} else {
 	}
-    } // end for lorange
+    }
+
     functionvec.clear();
     statementvec.clear();
 }
@@ -86,16 +86,24 @@ class BFDSymbols {
 
     public:
 
+    BFDSymbols();
+
+    static bool	isThreadSafe();
+
     int		getBFDFunctionStatements(PCBuffer*, const LinkedObject&,
-					 SymbolTableMap&);
-    int		getBFDFunctionStatements(std::set<Address>&, const LinkedObject&,
-					 SymbolTableMap&);
+					 const SymbolTableMap&);
+    int		getBFDFunctionStatements(const std::set<Address>&,
+					 const LinkedObject&,
+					 const SymbolTableMap&);
     int		getFunctionSyms(PCBuffer*, bfd_vma, bfd_vma);
-    int		getFunctionSyms(std::set<Address>&, AddressRange&);
+    int		getFunctionSyms(const std::set<Address>&, AddressRange&);
     int		initBFD(std::string);
     Path	getObjectFile(Path);
     void	getSymbols(PCBuffer*, const LinkedObject&, SymbolTableMap&);
     void	getSymbols(std::set<Address>&, const LinkedObject&, SymbolTableMap&);
+    void	resolveSymbols(const std::set<Address>&, const LinkedObject&,
+			       const SymbolTableMap&);
+    void	storeSymbols(const LinkedObject&, SymbolTableMap&);
 
     private:
 
@@ -103,8 +111,30 @@ class BFDSymbols {
     int		dummyprint () { return 0; };
     long	remove_useless_symbols (asymbol **symbols, long count);
 
+    static void	find_address_in_section (bfd *, asection *, void *);
+    void	find_address_in_section (asection *);
+
     int init_done;
 
+    // bfd symbols for current linkedobject
+    asymbol **syms;
+    long numsyms;
+
+    // Sorted bfd symbols for current linkedobject
+    // Used to find function begin and end addresses.
+    asymbol **sortedsyms;
+    long numsortedsyms;
+
+    // state used by find_address_in_section and bfd_find_nearest_line.
+    bfd *theBFD;
+    bfd_vma pc;
+    bfd_vma obj_base;
+    bool found;
+
+    // functions and statements found for current linkedobject
+    StatementsVec statementvec;
+    FunctionsVec functionvec;
+
 #ifndef NDEBUG
     static bool is_debug_symbols_enabled;
     static bool is_debug_offline_enabled;
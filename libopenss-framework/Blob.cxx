@@ -25,13 +25,90 @@
 #include "Assert.hxx"
 #include "Blob.hxx"
 
+#include <algorithm>
 #include <iostream>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 using namespace OpenSpeedShop::Framework;
 
 
 
+/**
+ * Shared storage of a blob's contents.
+ *
+ * Header preceding the contents within a single allocation. The contents begin
+ * HeaderSize bytes after the start of the header, keeping them as aligned as
+ * the allocation itself.
+ */
+struct Blob::Storage
+{
+    /** Number of blobs referencing these contents. */
+    unsigned dm_references;
+};
+
+
+
+namespace {
+
+    /** Size of the storage header preceding the contents (in bytes). */
+    const unsigned HeaderSize = 16;
+
+#ifndef NDEBUG
+    /** Flag indicating if debugging for this namespace is enabled. */
+    bool is_debug_enabled = (getenv("OPENSS_DEBUG_BLOB") != NULL);
+
+    /**
+     * Blob statistics.
+     *
+     * Cumulative counts of the blob contents that were allocated, shared, and
+     * borrowed. These are displayed to the standard error stream upon exit
+     * when debugging is enabled.
+     */
+    struct Statistics
+    {
+	/** Number of contents that were allocated. */
+	uint64_t dm_allocated_count;
+
+	/** Number of bytes (within contents) that were allocated. */
+	uint64_t dm_allocated_bytes;
+
+	/** Number of copies that shared existing contents. */
+	uint64_t dm_shared_count;
+
+	/** Number of contents that were borrowed. */
+	uint64_t dm_borrowed_count;
+
+	/** Default constructor. */
+	Statistics() :
+	    dm_allocated_count(0),
+	    dm_allocated_bytes(0),
+	    dm_shared_count(0),
+	    dm_borrowed_count(0)
+	{
+	}
+
+	/** Destructor. */
+	~Statistics()
+	{
+	    if(is_debug_enabled)
+		std::cerr << "[ Blob Allocated: " << dm_allocated_count
+			  << " (" << dm_allocated_bytes << ")"
+			  << ", Shared: " << dm_shared_count
+			  << ", Borrowed: " << dm_borrowed_count
+			  << " ]" << std::endl;
+	}
+    };
+
+    /** Blob statistics for this process. */
+    Statistics debug_statistics;
+#endif
+
+}
+
+
+
 /**
  * Default constructor.
  *
@@ -39,7 +116,8 @@ using namespace OpenSpeedShop::Framework;
  */
 Blob::Blob() :
     dm_size(0),
-    dm_contents(NULL)
+    dm_contents(NULL),
+    dm_storage(NULL)
 {
 }
 
@@ -48,25 +126,18 @@ Blob::Blob() :
 /**
  * Copy constructor.
  *
- * Constructs a new Blob by copying the specified blob. The compiler provided
- * default is insufficient here because we need a deep, rather than shallow,
- * copy of the contents for correct object destruction.
+ * Constructs a new Blob by copying the specified blob. The contents of a blob
+ * owning its contents are shared rather than copied. The contents of a blob
+ * borrowing its contents are copied.
  *
  * @param other    Blob to be copied.
  */
 Blob::Blob(const Blob& other) :
     dm_size(0),
-    dm_contents(NULL)
+    dm_contents(NULL),
+    dm_storage(NULL)
 {
-    // Only do an actual copy if the other blob is non-empty
-    if((other.dm_size > 0) && (other.dm_contents != NULL)) {
-	
-	// Make a copy of the blob
-	dm_size = other.dm_size;
-	dm_contents = new char[dm_size];
-	memcpy(dm_contents, other.dm_contents, dm_size);
-	
-    }
+    assign(other);
 }
 
 
@@ -74,23 +145,41 @@ Blob::Blob(const Blob& other) :
 /**
  * Constructor from size and contents.
  *
- * Constructs a new Blob from the specified size and contents. A copy of the
- * contents is made and is automatically release upon object destruction.
+ * Constructs a new Blob from the specified size and contents. By default a copy
+ * of the contents is made and is automatically released upon destruction of
+ * the last blob referencing it. Borrowed contents are not copied and are never
+ * released by the blob.
  *
- * @param size        Size of the blob (in bytes).
- * @param contents    Pointer to the blob's contents.
+ * @param size         Size of the blob (in bytes).
+ * @param contents     Pointer to the blob's contents.
+ * @param ownership    Treatment of the contents.
  */
-Blob::Blob(const unsigned& size, const void* contents) :
+Blob::Blob(const unsigned& size, const void* contents,
+	   const Ownership& ownership) :
     dm_size(0),
-    dm_contents(NULL)
+    dm_contents(NULL),
+    dm_storage(NULL)
 {
     // Only do initialization if the size and pointer are valid
     if((size > 0) && (contents != NULL)) {
     
-	// Make a copy of the blob's contents
-	dm_size = size;
-	dm_contents = new char[dm_size];
-	memcpy(dm_contents, contents, dm_size);
+	if(ownership == Borrow) {
+
+	    // Borrow the blob's contents
+	    dm_size = size;
+	    dm_contents = contents;
+#ifndef NDEBUG
+	    __sync_fetch_and_add(&debug_statistics.dm_borrowed_count, 1);
+#endif
+
+	}
+	else {
+
+	    // Make a copy of the blob's contents
+	    allocate(size);
+	    memcpy(const_cast<void*>(dm_contents), contents, dm_size);
+
+	}
 
     }
 }
@@ -115,37 +204,38 @@ Blob::Blob(const unsigned& size, const void* contents) :
  */
 Blob::Blob(const xdrproc_t xdrproc, const void* data) :
     dm_size(0),
-    dm_contents(NULL)
+    dm_contents(NULL),
+    dm_storage(NULL)
 {
     // Check assertions
     Assert(xdrproc != NULL);
     Assert(data != NULL);
     
     // Iteratively allocate increasingly large buffers to hold the XDR encoding
-    for(unsigned size = 1024; dm_contents == NULL; size *= 2) {
+    for(unsigned size = 1024; dm_storage == NULL; size *= 2) {
 	
 	// Allocate the encoding buffer
-	char* buffer = new char[size];
+	allocate(size);
 	
 	// Create an XDR stream using the encoding buffer
 	XDR xdrs;
-	xdrmem_create(&xdrs, buffer, size, XDR_ENCODE);
+	xdrmem_create(&xdrs, reinterpret_cast<char*>(
+			  const_cast<void*>(dm_contents)
+			  ), size, XDR_ENCODE);
 
 	// Attempt to encode the data structure to this stream
-	if((*xdrproc)(&xdrs, const_cast<void*>(data)) == TRUE) {
-	    
-	    // Success! Make this encoding the blob's contents
+	bool is_encoded = ((*xdrproc)(&xdrs, const_cast<void*>(data)) == TRUE);
+
+	// Success! Make this encoding the blob's contents
+	if(is_encoded)
 	    dm_size = xdr_getpos(&xdrs);
-	    dm_contents = buffer;
-	    
-	}
 	
 	// Close the XDR stream
 	xdr_destroy(&xdrs);
 	
 	// Destroy the encoding buffer if encoding failed
-	if(dm_contents == NULL)
-	    delete [] buffer;
+	if(!is_encoded)
+	    release();
 	
     }    
 }
@@ -155,12 +245,11 @@ Blob::Blob(const xdrproc_t xdrproc, const void* data) :
 /**
  * Destructor.
  *
- * Destroys the blob's contents if it had any.
+ * Releases the blob's contents if it had any.
  */
 Blob::~Blob()
 {    
-    // Destroy our contents (if any)
-    delete [] reinterpret_cast<char*>(dm_contents);
+    release();
 }
 
 
@@ -168,35 +257,65 @@ Blob::~Blob()
 /**
  * Assignment operator.
  *
- * Operator "=" defined for a Blob object. The compiler provided default is
- * insufficient here because we need a deep, rather than shallow, copy of the
- * contents for correct object destruction.
+ * Operator "=" defined for a Blob object. The contents of a blob owning its
+ * contents are shared rather than copied. The contents of a blob borrowing its
+ * contents are copied.
  *
  * @param other    Blob to be copied.
  */
 Blob& Blob::operator=(const Blob& other)
 {
     // Only do an assignment if the LHS and RHS differ
-    if((dm_size != other.dm_size) || (dm_contents != other.dm_contents)) {
-	
-	// Destroy our current contents (if any)
-	delete [] reinterpret_cast<char*>(dm_contents);
+    if(this != &other) {
+	release();
+	assign(other);
+    }
+
+    // Return ourselves to the caller
+    return *this;
+}
+
+
+
+#if __cplusplus >= 201103L
+/**
+ * Move constructor.
+ *
+ * Constructs a new Blob by taking the contents of the specified blob, which is
+ * left empty. Borrowed contents remain borrowed.
+ *
+ * @param other    Blob to be moved.
+ */
+Blob::Blob(Blob&& other) :
+    dm_size(0),
+    dm_contents(NULL),
+    dm_storage(NULL)
+{
+    swap(other);
+}
 
-	// Only do an actual copy if the RHS is a non-empty blob
-	if((other.dm_size > 0) && (other.dm_contents != NULL)) {
 
-	    // Copy the RHS blob
-	    dm_size = other.dm_size;
-	    dm_contents = new char[dm_size];
-	    memcpy(dm_contents, other.dm_contents, dm_size);
-	
-	}
 
+/**
+ * Move assignment operator.
+ *
+ * Operator "=" defined for a Blob object. Takes the contents of the specified
+ * blob, which is left empty. Borrowed contents remain borrowed.
+ *
+ * @param other    Blob to be moved.
+ */
+Blob& Blob::operator=(Blob&& other)
+{
+    // Only do an assignment if the LHS and RHS differ
+    if(this != &other) {
+	release();
+	swap(other);
     }
 
     // Return ourselves to the caller
     return *this;
 }
+#endif
 
 
 
@@ -234,8 +353,9 @@ unsigned Blob::getXDRDecoding(const xdrproc_t xdrproc, void* data) const
 
     // Open an XDR stream using our contents
     XDR xdrs;
-    xdrmem_create(&xdrs, reinterpret_cast<char*>(dm_contents),
-		  dm_size, XDR_DECODE);
+    xdrmem_create(&xdrs, reinterpret_cast<char*>(
+		      const_cast<void*>(dm_contents)
+		      ), dm_size, XDR_DECODE);
     
     // Decode the data structure from this stream
     Assert((*xdrproc)(&xdrs, data) == TRUE);
@@ -271,8 +391,9 @@ unsigned Blob::getAndVerifyXDRDecoding(const xdrproc_t xdrproc, void* data) cons
 
     // Open an XDR stream using our contents
     XDR xdrs;
-    xdrmem_create(&xdrs, reinterpret_cast<char*>(dm_contents),
-		  dm_size, XDR_DECODE);
+    xdrmem_create(&xdrs, reinterpret_cast<char*>(
+		      const_cast<void*>(dm_contents)
+		      ), dm_size, XDR_DECODE);
 
     // Decode the data structure from this stream
     // Return 0 if this fails and calling code must decide what to do.
@@ -348,3 +469,130 @@ bool Blob::isEmpty() const
 {
     return (dm_size == 0) || (dm_contents == NULL);
 }
+
+
+
+/**
+ * Test if borrowed.
+ *
+ * Returns a boolean value indicating if the blob borrows, rather than owns,
+ * its contents.
+ *
+ * @return    Boolean "true" if the blob borrows its contents, "false"
+ *            otherwise.
+ */
+bool Blob::isBorrowed() const
+{
+    return (dm_contents != NULL) && (dm_storage == NULL);
+}
+
+
+
+/**
+ * Swap contents.
+ *
+ * Exchanges the contents of this blob with those of another blob without
+ * copying either blob's contents. Used to transfer ownership of a (possibly
+ * large) blob into a container that already holds an empty blob.
+ *
+ * @param other    Blob whose contents are to be exchanged with this blob.
+ */
+void Blob::swap(Blob& other)
+{
+    std::swap(dm_size, other.dm_size);
+    std::swap(dm_contents, other.dm_contents);
+    std::swap(dm_storage, other.dm_storage);
+}
+
+
+
+/**
+ * Allocate contents.
+ *
+ * Allocates new, uninitialized, contents of the specified size for this empty
+ * blob. The storage header and contents are allocated together.
+ *
+ * @param size    Size of the contents (in bytes).
+ */
+void Blob::allocate(const unsigned& size)
+{
+    // Check assertions
+    Assert(dm_storage == NULL);
+
+    // Allocate the storage and initialize its header
+    char* buffer = new char[HeaderSize + size];
+    dm_storage = reinterpret_cast<Storage*>(buffer);
+    dm_storage->dm_references = 1;
+
+    dm_size = size;
+    dm_contents = buffer + HeaderSize;
+
+#ifndef NDEBUG
+    __sync_fetch_and_add(&debug_statistics.dm_allocated_count, 1);
+    __sync_fetch_and_add(&debug_statistics.dm_allocated_bytes, size);
+#endif
+}
+
+
+
+/**
+ * Assign contents.
+ *
+ * Makes this empty blob refer to the contents of the specified blob. Owned
+ * contents are shared by incrementing their reference count. Borrowed contents
+ * are copied, so that this blob doesn't depend on the lifetime of the borrowed
+ * contents.
+ *
+ * @param other    Blob whose contents are to be assigned.
+ */
+void Blob::assign(const Blob& other)
+{
+    // Check assertions
+    Assert(dm_storage == NULL);
+
+    if(other.dm_storage != NULL) {
+
+	// Share the other blob's contents
+	__sync_fetch_and_add(&other.dm_storage->dm_references, 1);
+	dm_size = other.dm_size;
+	dm_contents = other.dm_contents;
+	dm_storage = other.dm_storage;
+#ifndef NDEBUG
+	__sync_fetch_and_add(&debug_statistics.dm_shared_count, 1);
+#endif
+
+    }
+    else if((other.dm_size > 0) && (other.dm_contents != NULL)) {
+
+	// Copy the other blob's borrowed contents
+	allocate(other.dm_size);
+	memcpy(const_cast<void*>(dm_contents), other.dm_contents, dm_size);
+
+    }
+    else {
+
+	dm_size = 0;
+	dm_contents = NULL;
+
+    }
+}
+
+
+
+/**
+ * Release contents.
+ *
+ * Releases this blob's reference to its contents, destroying the contents if
+ * this blob was the last to reference them, and leaves this blob empty.
+ */
+void Blob::release()
+{
+    // Destroy our contents if we were the last reference
+    if((dm_storage != NULL) &&
+       (__sync_sub_and_fetch(&dm_storage->dm_references, 1) == 0))
+	delete [] reinterpret_cast<char*>(dm_storage);
+
+    dm_size = 0;
+    dm_contents = NULL;
+    dm_storage = NULL;
+}
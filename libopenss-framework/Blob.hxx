@@ -44,6 +44,14 @@ namespace OpenSpeedShop { namespace Framework {
      * unknown structure. Mechanisms are also provided here for performing XDR
      * encoding/decoding of typed data structures to/from such blobs.
      *
+     * The contents of a blob are immutable. Copies of a blob therefore share a
+     * single, reference counted, copy of the contents rather than each making
+     * their own. A blob may also be constructed as a view that borrows, rather
+     * than copies, existing contents such as the current result row of a SQL
+     * statement. Such contents must remain valid for the lifetime of the view.
+     * Copying a view yields a blob owning its own copy of the contents, so only
+     * the view itself (or a blob it was moved into) borrows the contents.
+     *
      * @sa    http://www.hyperdictionary.com/computing/binary+large+object
      *
      * @ingroup Utility
@@ -53,13 +61,24 @@ namespace OpenSpeedShop { namespace Framework {
 
     public:
 
+	/** Treatment of the contents passed to a constructor. */
+	enum Ownership {
+	    Copy,   /**< Contents are copied into the blob. */
+	    Borrow  /**< Contents are borrowed by the blob. */
+	};
+
 	Blob();
 	Blob(const Blob&);
-	Blob(const unsigned&, const void*);
+	Blob(const unsigned&, const void*, const Ownership& = Copy);
 	Blob(const xdrproc_t, const void*);	
 	~Blob();
 	
 	Blob& operator=(const Blob&);
+
+#if __cplusplus >= 201103L
+	Blob(Blob&&);
+	Blob& operator=(Blob&&);
+#endif
 	
 	/** Read-only data member accessor function. */
 	const unsigned& getSize() const
@@ -78,14 +97,27 @@ namespace OpenSpeedShop { namespace Framework {
 	std::string getStringEncoding() const;
 
 	bool isEmpty() const;
+	bool isBorrowed() const;
+
+	void swap(Blob&);
 
     private:
 
+	/** Shared storage of a blob's contents. */
+	struct Storage;
+
 	/** Size of the blob (in bytes). */
 	unsigned dm_size;
 
 	/** Pointer to the blob's contents. */
-	void* dm_contents;
+	const void* dm_contents;
+
+	/** Shared storage of the contents (null when empty or borrowed). */
+	Storage* dm_storage;
+
+	void allocate(const unsigned&);
+	void assign(const Blob&);
+	void release();
 	
     };
     
@@ -31,12 +31,30 @@
 #include "ThreadGroup.hxx"
 #include "PCBuffer.hxx"
 
+#include <stdlib.h>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 using namespace OpenSpeedShop::Framework;
 
 
 
+namespace {
+
+    /** Query for a single performance data blob. */
+    const Database::RegisteredStatement DataBlobQuery(
+	"SELECT time_begin, time_end, "
+	"       addr_begin, addr_end, "
+	"       data "
+	"FROM Data "
+	"WHERE ROWID = ?;"
+	);
+
+}
+
+
+
 /**
  * Get all available collectors.
  *
@@ -888,13 +906,7 @@ void Collector::getMetricValues(const std::string& unique_id,
 
     // Find the specified performance data blob
     BEGIN_TRANSACTION(dm_database);
-    dm_database->prepareStatement(
-	"SELECT time_begin, time_end, "
-	"       addr_begin, addr_end, "
-	"       data "
-	"FROM Data "
-	"WHERE ROWID = ?;"
-        );
+    dm_database->prepareStatement(DataBlobQuery);
     dm_database->bindArgument(1, identifier);
     while(dm_database->executeStatement())
 
@@ -905,13 +917,300 @@ void Collector::getMetricValues(const std::string& unique_id,
 				dm_database->getResultAsTime(2)),
 		   AddressRange(dm_database->getResultAsAddress(3),
 				dm_database->getResultAsAddress(4))),
-	    dm_database->getResultAsBlob(5), subextents, ptr
+	    dm_database->getResultAsBlob(5, Blob::Borrow), subextents, ptr
 	    );
     
     END_TRANSACTION(dm_database);
 }
 
 
+/**
+ * Aggregate our metric values.
+ *
+ * Aggregates, and stores in the database, the values of the specified metric
+ * for any of a particular thread's performance data blobs that haven't been
+ * aggregated yet. Only those metrics which the collector plugin indicates are
+ * additive over individual addresses can be aggregated. Must be called without
+ * the database locked, and before getAggregatedMetricValues(), since it may
+ * write to the database.
+ *
+ * @note    Aggregation may be disabled, and the metric values computed from
+ *          the performance data blobs, by setting the environment variable
+ *          OPENSS_DISABLE_METRIC_AGGREGATES.
+ *
+ * @param unique_id    Unique identifier of the metric to aggregate.
+ * @param thread       Thread for which to aggregate the metric.
+ * @return             Boolean "true" if the metric's values can be computed
+ *                     from the aggregates, "false" otherwise.
+ */
+bool Collector::aggregateMetricValues(const std::string& unique_id,
+				      const Thread& thread) const
+{
+    // Check assertions
+    Assert(inSameDatabase(thread));
+
+    // Can this metric be aggregated?
+    if(getenv("OPENSS_DISABLE_METRIC_AGGREGATES") != NULL)
+	return false;
+    if(dm_impl == NULL) {
+	instantiateImpl();
+	if(dm_impl == NULL)
+	    return false;
+    }
+    if(!dm_impl->isAggregatable(unique_id))
+	return false;
+
+    // Aggregate any performance data blobs that haven't been aggregated yet
+    bool has_aggregates = false;
+    BEGIN_TRANSACTION(dm_database);
+    has_aggregates = dm_database->hasTable("MetricAggregates");
+    END_TRANSACTION(dm_database);
+    if(!has_aggregates)
+	return false;
+    try {
+	updateMetricAggregates(unique_id, thread);
+    }
+    catch(const Exception& error) {
+	if(error.getCode() != Exception::DatabaseReadOnly)
+	    throw;
+	return false;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * Get our aggregated metric values.
+ *
+ * Returns metric values for this collector computed from the persistent per-
+ * address aggregates of the performance data blobs rather than from the blobs
+ * themselves. Only reads the database, so it may be called with the database
+ * locked. The thread's blobs must first have been aggregated by a successful
+ * call to aggregateMetricValues(). Any blobs stored after that call, and so not
+ * yet aggregated, are evaluated directly instead.
+ *
+ * @param unique_id     Unique identifier of the metric to get.
+ * @param thread        Thread for which to get values.
+ * @param subextents    Subextents for which to get values.
+ * @retval values       Values of the metric.
+ */
+void Collector::getAggregatedMetricValues(const std::string& unique_id,
+					  const Thread& thread,
+					  const ExtentGroup& subextents,
+					  std::vector<double>& values) const
+{
+    // Check assertions
+    Assert(inSameDatabase(thread));
+    Assert(values.size() >= subextents.size());
+
+    // Nothing more to do if there are no subextents
+    if(subextents.empty())
+	return;
+    Extent bounds = subextents.getBounds();
+
+    // Indicies of the subextents containing each aggregated address
+    std::vector<ExtentGroup::size_type> containing;
+
+    // Iterate over each aggregate intersecting the subextents
+    BEGIN_TRANSACTION(dm_database);
+    dm_database->prepareStatement(
+	"SELECT Data.time_begin, "
+	"       Data.time_end, "
+	"       MetricAggregates.addr, "
+	"       MetricAggregates.value "
+	"FROM MetricAggregates "
+	"  JOIN Data ON MetricAggregates.data = Data.id "
+	"WHERE Data.collector = ? "
+	"  AND Data.thread = ? "
+	"  AND MetricAggregates.metric = ? "
+	"  AND ? < Data.time_end "
+	"  AND Data.time_begin < ? "
+	"  AND ? <= MetricAggregates.addr "
+	"  AND MetricAggregates.addr < ?;"
+	);
+    dm_database->bindArgument(1, dm_entry);
+    dm_database->bindArgument(2, EntrySpy(thread).getEntry());
+    dm_database->bindArgument(3, unique_id);
+    dm_database->bindArgument(4, bounds.getTimeInterval().getBegin());
+    dm_database->bindArgument(5, bounds.getTimeInterval().getEnd());
+    dm_database->bindArgument(6, bounds.getAddressRange().getBegin());
+    dm_database->bindArgument(7, bounds.getAddressRange().getEnd());
+    while(dm_database->executeStatement()) {
+	TimeInterval interval(dm_database->getResultAsTime(1),
+			      dm_database->getResultAsTime(2));
+	Address address = dm_database->getResultAsAddress(3);
+	double value = dm_database->getResultAsReal(4);
+
+	// Calculate time (in nS) of the aggregated data blob's extent
+	double t_blob = static_cast<double>(interval.getWidth());
+
+	// Iterate over each subextent containing this address
+	subextents.getIntersectionWith(Extent(interval, AddressRange(address)),
+				       containing);
+	for(std::vector<ExtentGroup::size_type>::const_iterator
+		i = containing.begin(); i != containing.end(); ++i) {
+
+	    // Calculate intersection time (in nS) of subextent and data blob
+	    double t_intersection = static_cast<double>
+		((interval & subextents[*i].getTimeInterval()).getWidth());
+
+	    // Add (to the subextent's metric value) the appropriate fraction
+	    // of the total value aggregated at this address
+	    values[*i] += value * (t_intersection / t_blob);
+
+	}
+    }
+
+    // Find any performance data blobs stored since the aggregates were updated
+    std::vector<int> identifiers;
+    dm_database->prepareStatement(
+	"SELECT id "
+	"FROM Data "
+	"WHERE collector = ? "
+	"  AND thread = ? "
+	"  AND ? < time_end "
+	"  AND time_begin < ? "
+	"  AND id NOT IN ("
+	"    SELECT data FROM MetricAggregates WHERE metric = ?"
+	"  );"
+	);
+    dm_database->bindArgument(1, dm_entry);
+    dm_database->bindArgument(2, EntrySpy(thread).getEntry());
+    dm_database->bindArgument(3, bounds.getTimeInterval().getBegin());
+    dm_database->bindArgument(4, bounds.getTimeInterval().getEnd());
+    dm_database->bindArgument(5, unique_id);
+    while(dm_database->executeStatement())
+	identifiers.push_back(dm_database->getResultAsInteger(1));
+
+    // Evaluate those blobs directly rather than leaving them out
+    for(std::vector<int>::const_iterator
+	    i = identifiers.begin(); i != identifiers.end(); ++i)
+	getMetricValues(unique_id, thread, subextents, *i, &values);
+
+    END_TRANSACTION(dm_database);
+}
+
+
+
+/**
+ * Update our metric aggregates.
+ *
+ * Aggregates the values of the specified metric for each of the performance
+ * data blobs of a particular thread that haven't been aggregated yet. A blob's
+ * aggregates are its metric values at each of the unique addresses it contains,
+ * over the blob's entire time interval. Blobs are marked as having been
+ * aggregated by an additional aggregate with no address, so that blobs without
+ * any non-zero metric values aren't aggregated repeatedly.
+ *
+ * @param unique_id    Unique identifier of the metric to aggregate.
+ * @param thread       Thread for which to aggregate the metric.
+ */
+void Collector::updateMetricAggregates(const std::string& unique_id,
+				       const Thread& thread) const
+{
+    // Check assertions
+    Assert(dm_impl != NULL);
+
+    // Aggregates (address and value) of each newly aggregated data blob
+    std::vector<std::pair<int, std::vector<std::pair<Address, double> > > >
+	aggregates;
+
+    // Begin a multi-statement transaction
+    BEGIN_WRITE_TRANSACTION(dm_database);
+
+    // Iterate over each performance data blob not yet aggregated
+    dm_database->prepareStatement(
+	"SELECT id, "
+	"       time_begin, "
+	"       time_end, "
+	"       addr_begin, "
+	"       addr_end, "
+	"       data "
+	"FROM Data "
+	"WHERE collector = ? "
+	"  AND thread = ? "
+	"  AND id NOT IN ("
+	"    SELECT data FROM MetricAggregates WHERE metric = ?"
+	"  );"
+	);
+    dm_database->bindArgument(1, dm_entry);
+    dm_database->bindArgument(2, EntrySpy(thread).getEntry());
+    dm_database->bindArgument(3, unique_id);
+    while(dm_database->executeStatement()) {
+	Extent extent(TimeInterval(dm_database->getResultAsTime(2),
+				   dm_database->getResultAsTime(3)),
+		      AddressRange(dm_database->getResultAsAddress(4),
+				   dm_database->getResultAsAddress(5)));
+	Blob blob = dm_database->getResultAsBlob(6, Blob::Borrow);
+
+	aggregates.push_back(
+	    std::make_pair(dm_database->getResultAsInteger(1),
+			   std::vector<std::pair<Address, double> >())
+	    );
+
+	// Construct one subextent for each unique address in this data blob
+	std::set<Address> addresses;
+	dm_impl->getUniquePCValues(thread, blob, addresses);
+	ExtentGroup subextents;
+	for(std::set<Address>::const_iterator
+		i = addresses.begin(); i != addresses.end(); ++i)
+	    if(*i < Address::TheHighest())
+		subextents.push_back(
+		    Extent(extent.getTimeInterval(), AddressRange(*i))
+		    );
+	if(subextents.empty())
+	    continue;
+
+	// Evaluate the metric values for these subextents
+	std::vector<double> values(subextents.size(), 0.0);
+	dm_impl->getMetricValues(unique_id, *this, thread,
+				 extent, blob, subextents, &values);
+
+	// Keep only the non-zero metric values
+	for(ExtentGroup::size_type i = 0; i < subextents.size(); ++i)
+	    if(values[i] != 0.0)
+		aggregates.back().second.push_back(
+		    std::make_pair(subextents[i].getAddressRange().getBegin(),
+				   values[i])
+		    );
+    }
+
+    // Store the aggregates of each newly aggregated data blob
+    for(std::vector<
+	    std::pair<int, std::vector<std::pair<Address, double> > >
+	    >::const_iterator i = aggregates.begin(); i != aggregates.end(); ++i) {
+
+	dm_database->prepareStatement(
+	    "INSERT INTO MetricAggregates (data, metric) VALUES (?, ?);"
+	    );
+	dm_database->bindArgument(1, i->first);
+	dm_database->bindArgument(2, unique_id);
+	while(dm_database->executeStatement());
+
+	for(std::vector<std::pair<Address, double> >::const_iterator
+		j = i->second.begin(); j != i->second.end(); ++j) {
+	    dm_database->prepareStatement(
+		"INSERT INTO MetricAggregates "
+		"  (data, metric, addr, value) "
+		"VALUES (?, ?, ?, ?);"
+		);
+	    dm_database->bindArgument(1, i->first);
+	    dm_database->bindArgument(2, unique_id);
+	    dm_database->bindArgument(3, j->first);
+	    dm_database->bindArgument(4, j->second);
+	    while(dm_database->executeStatement());
+	}
+
+    }
+
+    // End this multi-statement transaction
+    END_TRANSACTION(dm_database);
+}
+
+
+
 // The Offline Experiment code that converts raw data to
 // an OpenSpeedShop database uses this method to restict
 // database entries to only those related to a sampled address.
@@ -939,7 +1238,7 @@ void Collector::getUniquePCValues(const Thread& thread,
 	dm_database->bindArgument(1, *i);
 	while(dm_database->executeStatement()) {
 
-	    Blob blob = dm_database->getResultAsBlob(1);
+	    Blob blob = dm_database->getResultAsBlob(1, Blob::Borrow);
 	    // Defer to our implementation
 	    dm_impl->getUniquePCValues(thread,blob,buf); 
 	}
@@ -970,7 +1269,7 @@ void Collector::getUniquePCValues(const Thread& thread,
 	dm_database->bindArgument(1, *i);
 	while(dm_database->executeStatement()) {
 
-	    Blob blob = dm_database->getResultAsBlob(1);
+	    Blob blob = dm_database->getResultAsBlob(1, Blob::Borrow);
 	    // Defer to our implementation
 	    dm_impl->getUniquePCValues(thread,blob,uaddresses); 
 	}
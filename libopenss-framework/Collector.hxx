@@ -132,6 +132,11 @@ namespace OpenSpeedShop { namespace Framework {
 				const ExtentGroup&,
 				std::set<Address>& ) const;
 
+	bool aggregateMetricValues(const std::string&, const Thread&) const;
+	void getAggregatedMetricValues(const std::string&, const Thread&,
+				       const ExtentGroup&,
+				       std::vector<double>&) const;
+
 	Extent getExtentIn(const Thread&) const;
 	
 	ThreadGroup getThreads() const;
@@ -157,6 +162,7 @@ namespace OpenSpeedShop { namespace Framework {
 			     const ExtentGroup&, void*) const;
 	void getMetricValues(const std::string&, const Thread&,
 			     const ExtentGroup&, const int&, void*) const;
+	void updateMetricAggregates(const std::string&, const Thread&) const;
 	
 	/** Collector's implementation. */
 	mutable CollectorImpl* dm_impl;
@@ -23,6 +23,7 @@
  *
  */
 
+#include "Assert.hxx"
 #include "Collector.hxx"
 #include "CollectorImpl.hxx"
 #include "DataQueues.hxx"
@@ -32,10 +33,37 @@
 #include "ThreadGroup.hxx"
 #include "Function.hxx"
 
+#include <pthread.h>
+
 using namespace OpenSpeedShop::Framework;
 
 
 
+namespace {
+
+    /** Once-only initialization control for the subextent cache key. */
+    pthread_once_t subextent_cache_key_once = PTHREAD_ONCE_INIT;
+
+    /** Key for the subextent cache of each thread. */
+    pthread_key_t subextent_cache_key;
+
+    /** Destroy a thread's subextent cache when that thread exits. */
+    void destroySubextentCache(void* cache)
+    {
+	delete reinterpret_cast<SubextentCache*>(cache);
+    }
+
+    /** Create the subextent cache key. */
+    void createSubextentCacheKey()
+    {
+	Assert(pthread_key_create(&subextent_cache_key,
+				  destroySubextentCache) == 0);
+    }
+
+}
+
+
+
 /**
  * Get experiment identifier.
  *
@@ -392,3 +420,109 @@ CollectorImpl::getMPIRuntimeUsageMap(const ThreadGroup& threads) const
     // Return the MPI runtime usage map
     return runtime_usage_map;
 }
+
+
+
+/**
+ * Get the subextent cache.
+ *
+ * Returns the subextent cache for the calling thread, prepared for the given
+ * subextents. Called by derived classes from getMetricValues() to resolve each
+ * address only once. Each thread has its own cache, allowing metric values to
+ * be computed concurrently without locking, and the returned cache remains in
+ * use only by the calling thread. It is destroyed when that thread exits.
+ *
+ * @param subextents    Subextents to be searched.
+ * @return              Subextent cache for the calling thread.
+ */
+SubextentCache&
+CollectorImpl::getSubextentCache(const ExtentGroup& subextents) const
+{
+    // Find or create the cache for the calling thread
+    Assert(pthread_once(&subextent_cache_key_once,
+			createSubextentCacheKey) == 0);
+    SubextentCache* cache = reinterpret_cast<SubextentCache*>(
+	pthread_getspecific(subextent_cache_key)
+	);
+    if(cache == NULL) {
+	cache = new SubextentCache();
+	Assert(pthread_setspecific(subextent_cache_key, cache) == 0);
+    }
+
+    // Prepare the cache for these subextents
+    cache->setSubextents(subextents);
+    return *cache;
+}
+
+
+
+/**
+ * Default constructor.
+ *
+ * Constructs an empty subextent cache.
+ */
+SubextentCache::SubextentCache() :
+    dm_subextents(NULL),
+    dm_identifier(0),
+    dm_entries()
+{
+}
+
+
+
+/**
+ * Set the subextents.
+ *
+ * Sets the subextents to be searched by this cache. The cached entries are kept
+ * if the subextents are the same (or a copy of the same) subextents for which
+ * the entries were computed, and are discarded otherwise.
+ *
+ * @param subextents    Subextents to be searched.
+ */
+void SubextentCache::setSubextents(const ExtentGroup& subextents)
+{
+    uint64_t identifier = subextents.getIdentifier();
+    if((dm_subextents == NULL) || (identifier != dm_identifier))
+	dm_entries.clear();
+    dm_subextents = &subextents;
+    dm_identifier = identifier;
+}
+
+
+
+/**
+ * Get the subextents containing an address.
+ *
+ * Returns the subextents whose address range contains the specified address.
+ * The subextents are searched only upon the first request for an address, with
+ * subsequent requests returning the cached result.
+ *
+ * @pre    The subextents must have been set. An assertion failure occurs if
+ *         this cache is used before setSubextents() is called.
+ *
+ * @param address    Address to be found.
+ * @return           Subextents (by index, in ascending order) containing the
+ *                   address.
+ */
+const std::vector<ExtentGroup::size_type>&
+SubextentCache::getSubextentsAt(const Address& address)
+{
+    Assert(dm_subextents != NULL);
+
+    // Return the cached entry for this address when present
+    std::map<Address, std::vector<ExtentGroup::size_type> >::iterator
+	i = dm_entries.lower_bound(address);
+    if((i != dm_entries.end()) && (i->first == address))
+	return i->second;
+
+    // Otherwise search the subextents over all time for this address
+    i = dm_entries.insert(
+	i, std::make_pair(address, std::vector<ExtentGroup::size_type>())
+	);
+    dm_subextents->getIntersectionWith(
+	Extent(TimeInterval(Time::TheBeginning(), Time::TheEnd()),
+	       AddressRange(address)),
+	i->second
+	);
+    return i->second;
+}
@@ -30,7 +30,9 @@
 #include "config.h"
 #endif
 
+#include "Address.hxx"
 #include "AddressRange.hxx"
+#include "ExtentGroup.hxx"
 #include "Metadata.hxx"
 #include "TimeInterval.hxx"
 #include "PCBuffer.hxx"
@@ -38,6 +40,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 
 namespace OpenSpeedShop { namespace Framework {
@@ -45,10 +48,48 @@ namespace OpenSpeedShop { namespace Framework {
     class Blob;
     class Collector;
     class Extent;
-    class ExtentGroup;
     class Function;
     class Thread;
     class ThreadGroup;
+
+    /**
+     * Subextent cache.
+     *
+     * Memoizes which subextents of an extent group contain a given address.
+     * Collector plugins resolve every sampled PC, or every frame of every call
+     * stack, against the same subextents. And the same addresses occur again
+     * and again within (and across) performance data blobs. Caching the result
+     * allows each unique address to be searched for only once per query rather
+     * than once per occurrence.
+     *
+     * Only the address range of the subextents is considered. The caller must
+     * still check the time interval of each returned subextent.
+     *
+     * @ingroup CollectorAPI
+     */
+    class SubextentCache
+    {
+
+    public:
+
+	SubextentCache();
+
+	void setSubextents(const ExtentGroup&);
+	const std::vector<ExtentGroup::size_type>&
+	getSubextentsAt(const Address&);
+
+    private:
+
+	/** Subextents being cached. */
+	const ExtentGroup* dm_subextents;
+
+	/** Identifier of the subextents' Kd-tree. */
+	uint64_t dm_identifier;
+
+	/** Subextents (by index) containing each cached address. */
+	std::map<Address, std::vector<ExtentGroup::size_type> > dm_entries;
+
+    };
     
     /**
      * Performance data collector implementation.
@@ -193,6 +234,26 @@ namespace OpenSpeedShop { namespace Framework {
 				     const ExtentGroup& subextents,
 				     void* ptr) const = 0;
 
+	/**
+	 * Test if a metric can be aggregated.
+	 *
+	 * Virtual member function that defines the interface by which a
+	 * collector plugin indicates that one of its metrics, of type double,
+	 * is additive over individual addresses. I.e. that the metric value of
+	 * any subextent equals the sum of the metric values of the individual
+	 * addresses it contains. Such metrics may be computed from persistent
+	 * per-address aggregates of the performance data blobs rather than the
+	 * blobs themselves. Default implementation returns "false".
+	 *
+	 * @param metric    Unique identifier of the metric.
+	 * @return          Boolean "true" if the metric can be aggregated,
+	 *                  "false" otherwise.
+	 */
+	virtual bool isAggregatable(const std::string& /* metric */) const
+	{
+	    return false;
+	}
+
 	virtual void getUniquePCValues( const Thread& thread, const Blob& blob,
 		PCBuffer *buf) const = 0;
 	virtual void getUniquePCValues( const Thread& thread, const Blob& blob,
@@ -240,6 +301,8 @@ namespace OpenSpeedShop { namespace Framework {
 
 	RuntimeUsageMap getMPIRuntimeUsageMap(const ThreadGroup&) const;
 
+	SubextentCache& getSubextentCache(const ExtentGroup&) const;
+
     private:
 
 	/** Set of parameters. */
@@ -43,10 +43,13 @@
 #include "KrellInstitute/Messages/DataHeader.h"
 #endif
 
+#include <algorithm>
 #include <deque>
 #include <pthread.h>
 #include <map>
+#include <set>
 #include <sstream>
+#include <vector>
 
 using namespace OpenSpeedShop::Framework;
 
@@ -70,6 +73,150 @@ namespace {
     /** Map identifiers to their queue. */
     std::map<int, SmartPtr<std::deque<Blob> > > identifier_to_queue;
 
+    /** Maximum number of blobs stored into the database as one batch. */
+    const unsigned BlobsPerBatch = 256;
+
+
+
+    /**
+     * Thread and collector resolver.
+     *
+     * In-memory table mapping the host name, process identifier, and POSIX
+     * thread identifier found in each performance data header to the unique
+     * identifier of the corresponding thread. The set of valid collector
+     * identifiers is kept as well. A resolver is rebuilt, with one query per
+     * table, at the start of each flush of a database's queue. Storing a blob
+     * then only requires a single insert into the database.
+     *
+     * @note    Threads whose POSIX thread identifier is null are recorded
+     *          under a separate key so that the fallback searches performed
+     *          by storePerformanceData() match those previously made directly
+     *          against the database. When more than one thread matches a key,
+     *          the thread with the largest identifier is used, again matching
+     *          the previous behavior.
+     */
+    class Resolver
+    {
+
+    public:
+
+	/** Key identifying a thread: (host, pid, has_tid, posix_tid). */
+	typedef std::pair<std::pair<std::string, pid_t>,
+			  std::pair<bool, pthread_t> > Key;
+
+	/**
+	 * Constructor from a database.
+	 *
+	 * Constructs a new resolver containing all the threads and collectors
+	 * currently found in the specified database.
+	 *
+	 * @param database    Database from which to build the resolver.
+	 */
+	explicit Resolver(const SmartPtr<Database>& database) :
+	    dm_collectors(),
+	    dm_threads()
+	{
+	    BEGIN_TRANSACTION(database);
+
+	    database->prepareStatement("SELECT id FROM Collectors;");
+	    while(database->executeStatement())
+		dm_collectors.insert(database->getResultAsInteger(1));
+
+	    database->prepareStatement(
+		"SELECT id, host, pid, posix_tid FROM Threads ORDER BY id;"
+		);
+	    while(database->executeStatement()) {
+		bool has_tid = !database->getResultIsNull(4);
+		addThread(database->getResultAsString(2),
+			  static_cast<pid_t>(database->getResultAsInteger(3)),
+			  has_tid,
+			  has_tid ? database->getResultAsPosixThreadId(4) :
+			            static_cast<pthread_t>(0),
+			  database->getResultAsInteger(1));
+	    }
+
+	    END_TRANSACTION(database);
+	}
+
+	/**
+	 * Add a thread.
+	 *
+	 * Adds the specified thread to this resolver. Any previous thread with
+	 * the same key is replaced.
+	 *
+	 * @param host         Canonical name of the thread's host.
+	 * @param pid          Process identifier of the thread.
+	 * @param has_tid      Boolean "true" if the thread has a POSIX thread
+	 *                     identifier, "false" otherwise.
+	 * @param tid          POSIX thread identifier of the thread.
+	 * @param thread       Unique identifier of the thread.
+	 */
+	void addThread(const std::string& host, const pid_t& pid,
+		       const bool& has_tid, const pthread_t& tid,
+		       const int& thread)
+	{
+	    dm_threads[std::make_pair(
+		std::make_pair(host, pid),
+		std::make_pair(has_tid, has_tid ? tid : static_cast<pthread_t>(0))
+		)] = thread;
+	}
+
+	/**
+	 * Test if a collector exists.
+	 *
+	 * @param collector    Unique identifier of the collector.
+	 * @return             Boolean "true" if the collector exists,
+	 *                     "false" otherwise.
+	 */
+	bool hasCollector(const int& collector) const
+	{
+	    return dm_collectors.find(collector) != dm_collectors.end();
+	}
+
+	/**
+	 * Find a thread.
+	 *
+	 * Returns the unique identifier of the specified thread. The thread is
+	 * searched for first by its POSIX thread identifier, then as a thread
+	 * with a null POSIX thread identifier, and finally as a thread with a
+	 * POSIX thread identifier of zero (see storePerformanceData()).
+	 *
+	 * @param host    Canonical name of the thread's host.
+	 * @param pid     Process identifier of the thread.
+	 * @param tid     POSIX thread identifier of the thread.
+	 * @return        Unique identifier of the thread, or zero if no
+	 *                such thread was found.
+	 */
+	int getThread(const std::string& host, const pid_t& pid,
+		      const pthread_t& tid) const
+	{
+	    std::pair<std::string, pid_t> process = std::make_pair(host, pid);
+
+	    std::map<Key, int>::const_iterator i = dm_threads.find(
+		std::make_pair(process, std::make_pair(true, tid))
+		);
+	    if(i == dm_threads.end())
+		i = dm_threads.find(std::make_pair(
+		    process, std::make_pair(false, static_cast<pthread_t>(0))
+		    ));
+	    if(i == dm_threads.end())
+		i = dm_threads.find(std::make_pair(
+		    process, std::make_pair(true, static_cast<pthread_t>(0))
+		    ));
+
+	    return (i == dm_threads.end()) ? 0 : i->second;
+	}
+
+    private:
+
+	/** Identifiers of the existing collectors. */
+	std::set<int> dm_collectors;
+
+	/** Map thread keys to their unique identifier. */
+	std::map<Key, int> dm_threads;
+
+    };
+
 #ifndef NDEBUG
     /** Flag indicating if debugging for this namespace is enabled. */
     bool is_debug_enabled = (getenv("OPENSS_DEBUG_DATAQUEUES") != NULL);
@@ -94,18 +241,25 @@ namespace {
      * Displays performance statistics for the passed flush operation to the
      * standard error stream. Reported information includes cumulative number
      * of data blobs entering/leaving the data queues, and the instantaneous
-     * write rate for the flush.
+     * write rates (in bytes and in blobs) for the flush.
      *
      * @param interval    Time interval over which data was flushed.
      * @param bytes       Number of bytes flushed.
+     * @param count       Number of blobs flushed.
      */
     void debugPerformanceStatistics(const TimeInterval& interval,
-				    const uint64_t& bytes)
+				    const uint64_t& bytes,
+				    const uint64_t& count)
     {
 	// Calculate the write rate in kilobytes/second
 	double write_rate = 
 	    (static_cast<double>(bytes) * 1000000000.0) /
 	    (static_cast<double>(interval.getWidth()) * 1024.0);
+
+	// Calculate the write rate in blobs/second
+	double blob_rate =
+	    (static_cast<double>(count) * 1000000000.0) /
+	    static_cast<double>(interval.getWidth());
 	
 	// Build the string to be displayed
 	std::stringstream output;
@@ -125,6 +279,8 @@ namespace {
 	    output << (write_rate / 1024.0) << " MB/s";
 	else
 	    output << (write_rate / (1024.0 * 1024.0)) << " GB/s";
+
+	output << ", " << count << " blobs, " << blob_rate << " blobs/s";
 	
 	output << std::endl;
 	
@@ -139,25 +295,17 @@ namespace {
      * Store performance data.
      *
      * Stores the specified performance data into the specified experiment
-     * database. The blob is assumed to have been encoded by OpenSS_Send and is
+     * database. Each blob is assumed to have been encoded by OpenSS_Send and is
      * thus prepended with a performance data header. That header is decoded in
-     * order to create a properly indexed entry for the actual data.
+     * order to create a properly indexed entry for the actual data. The entries
+     * for all the blobs are inserted into the database as a single batch.
      *
-     * @todo    Collector runtimes used to pass a thread identifier directly
-     *          within the performance data header. When the instrumentor API
-     *          was changed to support direct instrumentation of thread groups,
-     *          rather than individual threads, this changed. Since collectors
-     *          could no longer directly give their runtimes a single thread
-     *          identifier specifying the thread for which data was gathered,
-     *          the runtimes now have to obtain the thread identification data
-     *          themselves. The only such information they have available is
-     *          the host name, process identifier, and POSIX thread identifier
-     *          and that is what is now passed in the performance data header.
-     *          Thus this routine must now do a search for every blob to find
-     *          the correct thread identifier from this information. Currently
-     *          the search is done directly on the database every time. This
-     *          may prove too slow and an in-memory cache in the same spirit
-     *          as the DataCache class may be required.
+     * @note    Collector runtimes only know the host name, process identifier,
+     *          and POSIX thread identifier of the thread for which data was
+     *          gathered, and that is what is passed in the performance data
+     *          header. The thread's unique identifier is found from these by
+     *          the passed resolver rather than by searching the database for
+     *          every blob.
      *
      * @note    Various timing issues can result in cases where, for example,
      *          data arrives after a particular collector, or thread has been
@@ -165,186 +313,159 @@ namespace {
      *          data under these circumstances.
      *
      * @param database    Database to contain the performance data.
-     * @param blob        Blob containing the performance data.
+     * @param resolver    Thread and collector resolver for this database.
+     * @param begin       Beginning of the blobs containing the performance data.
+     * @param end         End of the blobs containing the performance data.
      */
     void storePerformanceData(const SmartPtr<Database>& database,
-			      const Blob& blob)
+			      const Resolver& resolver,
+			      const std::deque<Blob>::const_iterator& begin,
+			      const std::deque<Blob>::const_iterator& end)
     {
-	bool ignore_data = false;
+	static const char* DataColumns[] = {
+	    "collector", "thread", "time_begin", "time_end",
+	    "addr_begin", "addr_end", "data"
+	};
+	static const std::vector<std::string> columns(
+	    DataColumns, DataColumns + (sizeof(DataColumns) / sizeof(char*))
+	    );
+
+	// Rows to be inserted and their corresponding data cache entries
+	std::vector<Database::Row> rows;
+	std::vector<std::pair<std::pair<int, int>, Extent> > entries;
 
 	// Begin a multi-statement transaction
 	BEGIN_WRITE_TRANSACTION(database);	
+
+	// Iterate over each blob
+	for(std::deque<Blob>::const_iterator 
+		blob = begin; blob != end; ++blob) {
+	    bool ignore_data = false;
 	
-	// Decode the performance data header
+	    // Decode the performance data header
 #if defined(BUILD_CBTF)
-	CBTF_DataHeader header;
-	memset(&header, 0, sizeof(header));
-	unsigned header_size = blob.getXDRDecoding(
-	    reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
-	    );
+	    CBTF_DataHeader header;
+	    memset(&header, 0, sizeof(header));
+	    unsigned header_size = blob->getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader), &header
+		);
 #else
-	OpenSS_DataHeader header;
-	memset(&header, 0, sizeof(header));
-	unsigned header_size = blob.getXDRDecoding(
-	    reinterpret_cast<xdrproc_t>(xdr_OpenSS_DataHeader), &header
-	    );
+	    OpenSS_DataHeader header;
+	    memset(&header, 0, sizeof(header));
+	    unsigned header_size = blob->getXDRDecoding(
+		reinterpret_cast<xdrproc_t>(xdr_OpenSS_DataHeader), &header
+		);
 #endif
 	
-	// Silently ignore the data if the address range is invalid
-	if(header.addr_begin >= header.addr_end) {
-	    ignore_data = true;
+	    // Silently ignore the data if the address range is invalid
+	    if(header.addr_begin >= header.addr_end) {
+		ignore_data = true;
 
 #ifndef NDEBUG
-	    if (is_debug_enabled) {
-	    std::cerr << "storePerformanceData: IGNORE DATA header.addr_begin "
-		<< Address(header.addr_begin)
-		<< " >= header.addr_end "
-		<< Address(header.addr_end)
-		<< std::endl;
-	    }
+		if (is_debug_enabled) {
+		std::cerr << "storePerformanceData: IGNORE DATA header.addr_begin "
+		    << Address(header.addr_begin)
+		    << " >= header.addr_end "
+		    << Address(header.addr_end)
+		    << std::endl;
+		}
 #endif
-	}
+	    }
 	
-	// Silently ignore the data if the time interval is invalid
-	if(header.time_begin >= header.time_end) {
-	    ignore_data = true;
+	    // Silently ignore the data if the time interval is invalid
+	    if(header.time_begin >= header.time_end) {
+		ignore_data = true;
 #ifndef NDEBUG
-	    if (is_debug_enabled) {
-	    std::cerr << "storePerformanceData: IGNORE DATA header.time_begin "
-		<< Time(header.time_begin) << ">= header.time_end "
-		<< Time(header.time_end) << std::endl;
-	    }
+		if (is_debug_enabled) {
+		std::cerr << "storePerformanceData: IGNORE DATA header.time_begin "
+		    << Time(header.time_begin) << ">= header.time_end "
+		    << Time(header.time_end) << std::endl;
+		}
 #endif
-	}
+	    }
 	
-	// Note: It is assumed here that the experiment identifier for this
-	//       blob corresponds to the database into which we are writing
-	//       this data.
+	    // Note: It is assumed here that the experiment identifier for this
+	    //       blob corresponds to the database into which we are writing
+	    //       this data.
 	
-	// Validate that the specified collector exists
-	int collector_rows = 0;
-	database->prepareStatement(
-	    "SELECT COUNT(*) FROM Collectors WHERE id = ?;"
-	    );
-	database->bindArgument(1, header.collector);
-	while(database->executeStatement())		
-	    collector_rows = database->getResultAsInteger(1);
-	if(collector_rows != 1) {
-	    ignore_data = true;
+	    // Validate that the specified collector exists
+	    if(!resolver.hasCollector(header.collector)) {
+		ignore_data = true;
 #ifndef NDEBUG
-	    if (is_debug_enabled) {
-	    std::cerr << "storePerformanceData: IGNORE DATA"
-		<< " collector_rows != 1 " << std::endl;
-	    }
+		if (is_debug_enabled) {
+		std::cerr << "storePerformanceData: IGNORE DATA"
+		    << " collector_rows != 1 " << std::endl;
+		}
 #endif
-	}
-
-	// Note: See the "todo" item in this function's description.
-
-	// Find the identifier of the specified thread
-	std::string host = Experiment::getCanonicalName(header.host);
-	int thread = 0;
-	database->prepareStatement(
-	    "SELECT id "
-	    "FROM Threads "
-	    "WHERE host = ? "
-	    "  AND pid = ? "
-	    "  AND posix_tid = ?;"
-	    );
-	database->bindArgument(1, host);
-	database->bindArgument(2, static_cast<int>(header.pid));
-	database->bindArgument(3, static_cast<pthread_t>(header.posix_tid));
-	while(database->executeStatement())
-	    thread = database->getResultAsInteger(1);
-	if(thread == 0) {
-	    database->prepareStatement(
-	        "SELECT id "
-		"FROM Threads "
-		"WHERE host = ? "
-		"  AND pid = ? "
-		"  AND posix_tid IS NULL;"
-		);
-	    database->bindArgument(1, host);
-	    database->bindArgument(2, static_cast<int>(header.pid));
-	    while(database->executeStatement())
-		thread = database->getResultAsInteger(1); 
-	}
+	    }
 
-	//
-	// TEMPORARY HACK (WDH APR-26-2008)
-	//
-	// The following code temporarily handles the fact that we are seeing
-	// forked processes for which Dyninst provides a TID of zero, and the
-	// thread's database entry is created with posix_tid=0. Later when the
-	// collector applies a TID to the performance data blob, it finds the
-	// real TID and uses it. Thus the TIDs don't match and this function
-	// tosses the data.
-	//
-	// I believe Dyninst's reporting of the TID is in error and needs to
-	// be fixed. But until then, we'll assume that only the first thread
-	// in each process may be misidentified, and if are unable to find an
-	// appropriate thread using the usual means above, we'll accept one
-	// that has posix_tid=0 (iff the host name and PID match correctly).
-	//
-	if(thread == 0) {
-	    database->prepareStatement(
-	        "SELECT id "
-		"FROM Threads "
-		"WHERE host = ? "
-		"  AND pid = ? "
-		"  AND posix_tid = ?;"
+	    //
+	    // Find the identifier of the specified thread. The resolver falls back
+	    // to threads with a null POSIX thread identifier, and then to threads
+	    // with a POSIX thread identifier of zero. The latter handles the fact
+	    // that we are seeing forked processes for which Dyninst provides a TID
+	    // of zero, and the thread's database entry is created with posix_tid=0.
+	    // Later when the collector applies a TID to the performance data blob,
+	    // it finds the real TID and uses it. Thus the TIDs don't match. (This
+	    // was originally a TEMPORARY HACK by WDH on APR-26-2008.)
+	    //
+	    int thread = resolver.getThread(
+		Experiment::getCanonicalName(header.host),
+		static_cast<pid_t>(header.pid),
+		static_cast<pthread_t>(header.posix_tid)
 		);
-	    database->bindArgument(1, host);
-	    database->bindArgument(2, static_cast<int>(header.pid));
-	    database->bindArgument(3, static_cast<pthread_t>(0));
-	    while(database->executeStatement())
-		thread = database->getResultAsInteger(1); 
-	}
 
-	if(thread == 0) {
-	    ignore_data = true;
+	    if(thread == 0) {
+		ignore_data = true;
 #ifndef NDEBUG
-	    if (is_debug_enabled) {
-	    std::cerr << "storePerformanceData: IGNORE DATA thread is  0 ??? "
-		<< thread << " ignore_data is " << ignore_data << std::endl;
-	    }
+		if (is_debug_enabled) {
+		std::cerr << "storePerformanceData: IGNORE DATA thread is  0 ??? "
+		    << thread << " ignore_data is " << ignore_data << std::endl;
+		}
 #endif
-	}
+	    }
 
-	// Calculate the size and location of the actual data
-	unsigned data_size = blob.getSize() - header_size;
-	const void* data_ptr =
-	    &(reinterpret_cast<const char*>(blob.getContents())[header_size]);
-	
-	//
-	// Create an entry for this data
-	if(!ignore_data) {
-	    database->prepareStatement(
-		"INSERT INTO Data "
-		"(collector, thread, time_begin, time_end, "
-		"  addr_begin, addr_end, data) "
-		"VALUES (?, ?, ?, ?, ?, ?, ?);"
-		);
-	    database->bindArgument(1, header.collector);
-	    database->bindArgument(2, thread);
-	    database->bindArgument(3, Time(header.time_begin));
-	    database->bindArgument(4, Time(header.time_end));
-	    database->bindArgument(5, Address(header.addr_begin));
-	    database->bindArgument(6, Address(header.addr_end));
-	    database->bindArgument(7, Blob(data_size, data_ptr));
-	    while(database->executeStatement());  
-	}
+	    // Go no further if this data is to be ignored
+	    if(ignore_data)
+		continue;
+
+	    // Calculate the size and location of the actual data
+	    unsigned data_size = blob->getSize() - header_size;
+	    const void* data_ptr = &(reinterpret_cast<const char*>(
+		blob->getContents()
+		)[header_size]);
 	
-	// Add this data to the performance data cache
-	if(!ignore_data)
-	    DataQueues::TheCache.addIdentifier(
-		database, header.collector, thread,
+	    // Add a row for this data
+	    rows.push_back(Database::Row());
+	    rows.back() << static_cast<int>(header.collector) << thread
+			<< Time(header.time_begin) << Time(header.time_end)
+			<< Address(header.addr_begin) << Address(header.addr_end);
+	    rows.back().appendBlob(data_size, data_ptr);
+
+	    // Add a data cache entry for this data
+	    entries.push_back(std::make_pair(
+		std::make_pair(static_cast<int>(header.collector), thread),
 		Extent(TimeInterval(Time(header.time_begin),
 				    Time(header.time_end)),
 		       AddressRange(Address(header.addr_begin),
-				    Address(header.addr_end))),
-		database->getLastInsertedUID()
-		);
+				    Address(header.addr_end)))
+		));
+
+	}
+
+	// Create the entries for this data
+	if(!rows.empty()) {
+	    database->insertRows("Data", columns, rows);
+
+	    // Add this data to the performance data cache
+	    int identifier = database->getLastInsertedUID() - entries.size() + 1;
+	    for(std::vector<std::pair<std::pair<int, int>, Extent> >::
+		    const_iterator i = entries.begin(); i != entries.end(); ++i)
+		DataQueues::TheCache.addIdentifier(
+		    database, i->first.first, i->first.second, i->second,
+		    identifier++
+		    );
+	}
 	
 	// End this multi-statement transaction
 	END_TRANSACTION(database);
@@ -518,6 +639,7 @@ void DataQueues::flushDatabase(const SmartPtr<Database>& database)
 #ifndef NDEBUG
     // Performance statistics
     uint64_t debug_written_bytes = 0;
+    uint64_t debug_written_count = 0;
     Time debug_start_time = Time::Now();
 #endif
 
@@ -536,21 +658,31 @@ void DataQueues::flushDatabase(const SmartPtr<Database>& database)
 	// Begin a multi-statement transaction
 	BEGIN_WRITE_TRANSACTION(database);
 
-	// Iterate over each blob in the queue
+	// Build the thread and collector resolver for this flush
+	Resolver resolver(database);
+
+	// Iterate over each batch of blobs in the queue
 	while(!queue->empty()) {
+	    std::deque<Blob>::iterator batch_end = 
+		queue->begin() + std::min<std::size_t>(queue->size(),
+						       BlobsPerBatch);
 
 #ifndef NDEBUG
 	    // Update performance statistics
-	    debug_written_bytes += queue->front().getSize();
-	    debug_stored_count++;
-	    debug_stored_bytes += queue->front().getSize();
+	    for(std::deque<Blob>::const_iterator
+		    j = queue->begin(); j != batch_end; ++j) {
+		debug_written_bytes += j->getSize();
+		debug_written_count++;
+		debug_stored_count++;
+		debug_stored_bytes += j->getSize();
+	    }
 #endif
 
-	    // Store this blob in the correct database
-	    storePerformanceData(database, queue->front());
+	    // Store this batch of blobs in the correct database
+	    storePerformanceData(database, resolver, queue->begin(), batch_end);
 
-	    // Pop this blob off the queue
-	    queue->pop_front();
+	    // Pop this batch of blobs off the queue
+	    queue->erase(queue->begin(), batch_end);
 	    
 	}
 
@@ -568,7 +700,7 @@ void DataQueues::flushDatabase(const SmartPtr<Database>& database)
     if(is_debug_enabled && (debug_written_bytes > 0))
 	debugPerformanceStatistics(TimeInterval(debug_start_time, 
 						debug_stop_time),
-				   debug_written_bytes);    
+				   debug_written_bytes, debug_written_count);
 #endif    
 
     // Release exclusive access to our unnamed namespace variables
@@ -631,6 +763,69 @@ void DataQueues::enqueuePerformanceData(const Blob& blob)
 
 
 
+/**
+ * Enqueue multiple performance data.
+ *
+ * Enqueues the specified performance data for the correct experiment databases
+ * exactly as if each blob had been passed individually to the single blob form
+ * of enqueuePerformanceData(), but acquires exclusive access only once for the
+ * entire batch. The contents of the blobs are moved, rather than copied, into
+ * the queues. Upon return the passed container is empty.
+ *
+ * @param blobs    Blobs containing the performance data.
+ */
+void DataQueues::enqueuePerformanceData(std::deque<Blob>& blobs)
+{
+    // Decode the performance data header of each blob
+    std::vector<int> experiments;
+    experiments.reserve(blobs.size());
+    for(std::deque<Blob>::const_iterator
+	    i = blobs.begin(); i != blobs.end(); ++i) {
+#if defined(BUILD_CBTF)
+	CBTF_DataHeader header;
+	memset(&header, 0, sizeof(header));
+	i->getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_CBTF_DataHeader),
+			  &header);
+#else
+	OpenSS_DataHeader header;
+	memset(&header, 0, sizeof(header));
+	i->getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_OpenSS_DataHeader),
+			  &header);
+#endif
+	experiments.push_back(header.experiment);
+    }
+    
+    // Acquire exclusive access to our unnamed namespace variables
+    Assert(pthread_mutex_lock(&exclusive_access_lock) == 0);
+    
+    for(std::deque<Blob>::size_type i = 0; i < blobs.size(); ++i) {
+
+	// Find the database's queue
+	std::map<int, SmartPtr<std::deque<Blob> > >::iterator
+	    j = identifier_to_queue.find(experiments[i]);
+	if(j == identifier_to_queue.end())
+	    continue;
+
+#ifndef NDEBUG
+	// Update performance statistics
+	debug_enqueued_count++;
+	debug_enqueued_bytes += blobs[i].getSize();	
+#endif
+
+	// Move this blob into the database's queue
+	j->second->push_back(Blob());
+	j->second->back().swap(blobs[i]);
+
+    }
+    
+    // Release exclusive access to our unnamed namespace variables
+    Assert(pthread_mutex_unlock(&exclusive_access_lock) == 0);
+
+    blobs.clear();
+}
+
+
+
 /**
  * Flush performance data.
  *
@@ -656,6 +851,7 @@ void DataQueues::flushPerformanceData()
 #ifndef NDEBUG
     // Performance statistics
     uint64_t debug_written_bytes = 0;
+    uint64_t debug_written_count = 0;
     Time debug_start_time = Time::Now();
 #endif
     
@@ -671,29 +867,39 @@ void DataQueues::flushPerformanceData()
 	    // Begin a multi-statement transaction
 	    BEGIN_WRITE_TRANSACTION(identifier_to_database[i->first]);	
 
-	    // Iterate over each blob in the queue
+	    // Build the thread and collector resolver for this flush
+	    Resolver resolver(identifier_to_database[i->first]);
+
+	    // Iterate over each batch of blobs in the queue
 	    while(!is_time_up && !i->second->empty()) {
+		std::deque<Blob>::iterator batch_end = 
+		    i->second->begin() + 
+		    std::min<std::size_t>(i->second->size(), BlobsPerBatch);
 		
 #ifndef NDEBUG
 		// Update performance statistics
-		debug_written_bytes += i->second->front().getSize();
-		debug_stored_count++;
-		debug_stored_bytes += i->second->front().getSize();
+		for(std::deque<Blob>::const_iterator
+			j = i->second->begin(); j != batch_end; ++j) {
+		    debug_written_bytes += j->getSize();
+		    debug_written_count++;
+		    debug_stored_count++;
+		    debug_stored_bytes += j->getSize();
+		}
 #endif
 		
-		// Store this blob in the correct database
+		// Store this batch of blobs in the correct database
 		storePerformanceData(identifier_to_database[i->first],
-				     i->second->front());
+				     resolver, i->second->begin(), batch_end);
 
-		// Pop this blob off the queue
-		i->second->pop_front();
+		// Pop this batch of blobs off the queue
+		i->second->erase(i->second->begin(), batch_end);
 
 		// Has the maximum flush time been exceeded?
 		if((Time::Now() - start_time) > maximumFlushTime)
 		    is_time_up == true;
 		
 	    }
- 
+
 	    // End this multi-statement transaction
 	    END_TRANSACTION(identifier_to_database[i->first]);
 	    
@@ -710,7 +916,7 @@ void DataQueues::flushPerformanceData()
     if(is_debug_enabled && (debug_written_bytes > 0))
 	debugPerformanceStatistics(TimeInterval(debug_start_time, 
 						debug_stop_time),
-				   debug_written_bytes);    
+				   debug_written_bytes, debug_written_count);
 #endif    
 
     // Release exclusive access to our unnamed namespace variables
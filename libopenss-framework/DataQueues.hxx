@@ -29,6 +29,7 @@
 #include "config.h"
 #endif
 
+#include <deque>
 
 
 namespace OpenSpeedShop { namespace Framework {
@@ -74,6 +75,7 @@ namespace OpenSpeedShop { namespace Framework {
 	void flushDatabase(const SmartPtr<Database>&);
 	
 	void enqueuePerformanceData(const Blob&);
+	void enqueuePerformanceData(std::deque<Blob>&);
 	void flushPerformanceData();
 
     }
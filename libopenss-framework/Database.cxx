@@ -34,6 +34,7 @@
 #include <fcntl.h>
 #include <limits>
 #include <sqlite3.h>
+#include <sstream>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
@@ -76,6 +77,85 @@ namespace {
 
 
 
+    /** Next available database handle serial number. */
+    uint64_t next_serial = 0;
+
+
+
+    /**
+     * Registry of SQL statements.
+     *
+     * Table assigning each distinct registered SQL statement a small integer
+     * identifier, and mapping those identifiers back to the statement text.
+     * Statements are never removed, so the identifiers remain valid for the
+     * life of the process.
+     */
+    class StatementRegistry :
+	public Lockable
+    {
+
+    public:
+
+	/** Default constructor. */
+	StatementRegistry() :
+	    Lockable(),
+	    dm_identifiers(),
+	    dm_statements()
+	{
+	}
+
+	/** Register a statement, returning its identifier. */
+	unsigned add(const std::string& statement)
+	{
+	    Guard guard_myself(this);
+	    std::map<std::string, unsigned>::const_iterator
+		i = dm_identifiers.find(statement);
+	    if(i != dm_identifiers.end())
+		return i->second;
+	    dm_statements.push_back(statement);
+	    dm_identifiers.insert(
+		std::make_pair(statement, dm_statements.size() - 1)
+		);
+	    return dm_statements.size() - 1;
+	}
+
+	/** Get the text of the statement with the given identifier. */
+	std::string get(const unsigned& identifier) const
+	{
+	    Guard guard_myself(this);
+	    Assert(identifier < dm_statements.size());
+	    return dm_statements[identifier];
+	}
+
+    private:
+
+	/** Map statement text to their identifier. */
+	std::map<std::string, unsigned> dm_identifiers;
+
+	/** Statement text of each identifier. */
+	std::vector<std::string> dm_statements;
+
+    };
+
+
+
+    /**
+     * Get the statement registry.
+     *
+     * Returns the registry of SQL statements. The registry is constructed on
+     * first use so that statements may be registered during the static
+     * initialization of other translation units.
+     *
+     * @return    Registry of SQL statements.
+     */
+    StatementRegistry& getStatementRegistry()
+    {
+	static StatementRegistry registry;
+	return registry;
+    }
+
+
+
 }
 
 
@@ -218,6 +298,8 @@ Database::Database(const std::string& name) :
 #endif
     dm_name(name),
     dm_transaction_lock(),
+    dm_generation(0),
+    dm_serial(__sync_add_and_fetch(&next_serial, 1)),
     dm_handles()
 {
     // Initialize the transaction lock
@@ -407,6 +489,48 @@ std::string Database::getName() const
 
 
 
+/**
+ * Get our generation.
+ *
+ * Returns the number of completed transactions that changed this database
+ * through this object. Caches of the database's contents can compare this
+ * value against the one at which they were filled to detect when they have
+ * become stale.
+ *
+ * @return    Generation of this database.
+ */
+uint64_t Database::getGeneration() const
+{
+    return __sync_fetch_and_add(const_cast<uint64_t*>(&dm_generation), 0);
+}
+
+
+
+/**
+ * Test for uncommitted changes.
+ *
+ * Returns a boolean value indicating if the calling thread has a transaction
+ * in-progress on this database that has already changed the database. These
+ * changes are not reflected in our generation until the transaction commits.
+ *
+ * @return    Boolean "true" if this thread has uncommitted changes, "false"
+ *            otherwise.
+ */
+bool Database::hasUncommittedChanges()
+{
+    // Get our per-thread database handle
+    Handle& handle = getHandle();
+
+    // Check assertions
+    Assert(handle.dm_database != NULL);
+
+    // Has the in-progress transaction (if any) changed the database?
+    return !handle.dm_transaction.empty() &&
+	(sqlite3_total_changes(handle.dm_database) != handle.dm_total_changes);
+}
+
+
+
 /**
  * Begin a new transaction.
  *
@@ -458,6 +582,9 @@ void Database::beginTransaction(const bool& will_modify)
 	
 	// Indicate the transaction can be committed
 	handle.dm_is_committable = true;
+
+	// Note the changes made before this transaction
+	handle.dm_total_changes = sqlite3_total_changes(handle.dm_database);
 	
     }
 
@@ -515,46 +642,62 @@ void Database::prepareStatement(const std::string& statement)
 		     i->second) == handle.dm_transaction.end())
 	    stmt = i->second;
     
-    // Do we need to prepare a new statement for execution?
-    if(stmt == NULL) {
-	
-	// Prepare this statement for execution
-	const char* tail = NULL;
-
-        // switched to sqlite3_prepare_v2 from sqlite3_prepare on July 7, 2014
-        // this change appears to have fixed database version update problems that
-        // had been occurring when old databases were read with a newer version of 
-        // OpenSpeedShop that supported a different database schema.
-
-	int retval = sqlite3_prepare_v2(handle.dm_database, 
-				        statement.c_str(), statement.size(),
-				        &stmt, &tail);
-	if(retval == SQLITE_ERROR) {
-	    std::string errmsg = sqlite3_errmsg(handle.dm_database);
-	    if(errmsg.find("syntax error") == std::string::npos)
-		throw Exception(Exception::DatabaseInvalid, getName(), errmsg);
-	}
-	Assert(retval == SQLITE_OK);
-	Assert((tail != NULL) && (*tail == '\0'));
-	
-	// Cache this prepared statement for future use
-	handle.dm_cache.insert(std::make_pair(statement, stmt));
+    // Prepare a new statement for execution if necessary
+    if(stmt == NULL)
+	stmt = compileStatement(handle, statement);
+
+    // Push this statement onto the transaction stack
+    pushStatement(handle, stmt);
+}
 
-    }
 
+
+/**
+ * Prepare a registered SQL statement.
+ *
+ * Prepares the passed registered SQL statement for execution. Identical to the
+ * prepareStatement() taking the SQL statement itself, except that the cached
+ * prepared copies of the statement are found by the statement's identifier.
+ * The statement's text is needed only when a new copy must be prepared.
+ *
+ * @param statement    Registered SQL statement to be executed.
+ */
+void Database::prepareStatement(const RegisteredStatement& statement)
+{
+    // Get our per-thread database handle
+    Handle& handle = getHandle();
+    
     // Check assertions
-    Assert(stmt != NULL);
+    Assert(handle.dm_database != NULL);
+    Assert(!handle.dm_transaction.empty());
+
+    // Find the cached prepared copies of this statement
+    if(statement.dm_identifier >= handle.dm_registered.size())
+	handle.dm_registered.resize(statement.dm_identifier + 1);
+    std::vector<sqlite3_stmt*>& cache =
+	handle.dm_registered[statement.dm_identifier];
+
+    // Pointer to the statement being used
+    sqlite3_stmt* stmt = NULL;
     
-    // Bind NULL values to all arguments of this statement
-    for(int i = 1; i <= sqlite3_bind_parameter_count(stmt); ++i)
-	Assert(sqlite3_bind_null(stmt, i) == SQLITE_OK);
+    // Use the first cached copy that is unused within the transaction
+    for(std::vector<sqlite3_stmt*>::const_iterator
+	    i = cache.begin(); (stmt == NULL) && (i != cache.end()); ++i)
+	if(std::find(handle.dm_transaction.begin(),
+		     handle.dm_transaction.end(),
+		     *i) == handle.dm_transaction.end())
+	    stmt = *i;
 
+    // Prepare a new statement for execution if necessary
+    if(stmt == NULL) {
+	stmt = compileStatement(
+	    handle, getStatementRegistry().get(statement.dm_identifier)
+	    );
+	cache.push_back(stmt);
+    }
+    
     // Push this statement onto the transaction stack
-    handle.dm_transaction.push_back(stmt);
-#ifndef NDEBUG
-    if(is_debug_enabled)
-	handle.dm_debug_start.push_back(Time::Now());
-#endif	
+    pushStatement(handle, stmt);
 }
 
 
@@ -1047,10 +1190,17 @@ double Database::getResultAsReal(const unsigned& index)
  *          or greater than the number of columns in the currently prepared
  *          statement will result in an assertion failure.
  *
- * @param index    Index (number) of column to obtain.
- * @return         Blob result from this column.
+ * @note    Borrowed blob results reference the contents of the active row
+ *          directly instead of copying them. Such blobs are only valid until
+ *          the statement is executed again or the transaction is ended. They
+ *          are intended for results that are decoded and then discarded.
+ *
+ * @param index        Index (number) of column to obtain.
+ * @param ownership    Treatment of the blob's contents.
+ * @return             Blob result from this column.
  */
-Blob Database::getResultAsBlob(const unsigned& index)
+Blob Database::getResultAsBlob(const unsigned& index,
+			       const Blob::Ownership& ownership)
 {
     // Get our per-thread database handle
     Handle& handle = getHandle();
@@ -1063,7 +1213,8 @@ Blob Database::getResultAsBlob(const unsigned& index)
     
     // Return the result to the caller
     return Blob(sqlite3_column_bytes(handle.dm_transaction.back(), index - 1),
-		sqlite3_column_blob(handle.dm_transaction.back(), index - 1));
+		sqlite3_column_blob(handle.dm_transaction.back(), index - 1),
+		ownership);
 }
 
 
@@ -1207,6 +1358,42 @@ int Database::getLastInsertedUID()
 
 
 
+/**
+ * Test for a table.
+ *
+ * Returns a boolean value indicating if the specified table exists within this
+ * database. Used to check for tables that are only optionally present, such as
+ * those added to existing databases without a schema version update.
+ *
+ * @note    Tables may be tested within the context of a transaction. Any
+ *          attempt to test a table before beginning a transaction will result
+ *          in an assertion failure. The test replaces any statement previously
+ *          prepared within the transaction.
+ *
+ * @param table    Name of the table to be tested.
+ * @return         Boolean "true" if the table exists, "false" otherwise.
+ */
+bool Database::hasTable(const std::string& table)
+{
+    bool has_table = false;
+
+    // Find the table in the schema
+    prepareStatement(
+	"SELECT COUNT(*) "
+	"FROM sqlite_master "
+	"WHERE type = 'table' "
+	"  AND name = ?;"
+	);
+    bindArgument(1, table);
+    while(executeStatement())
+	has_table = (getResultAsInteger(1) > 0);
+
+    // Return the test result to the caller
+    return has_table;
+}
+
+
+
 /**
  * Commit a transaction.
  *
@@ -1257,6 +1444,12 @@ void Database::commitTransaction()
 	Assert(sqlite3_exec(handle.dm_database, handle.dm_is_committable ?
 			    "COMMIT TRANSACTION;" : "ROLLBACK TRANSACTION;",
 			    NULL, NULL, NULL) == SQLITE_OK);
+
+	// Advance our generation if the transaction changed the database
+	if(handle.dm_is_committable &&
+	   (sqlite3_total_changes(handle.dm_database) !=
+	    handle.dm_total_changes))
+	    __sync_fetch_and_add(&dm_generation, 1);
 	
     }
 
@@ -1349,6 +1542,362 @@ void Database::rollbackTransaction()
 
 
 
+/**
+ * Begin a bulk load.
+ *
+ * Begins a bulk load of this database by the calling thread. For the duration
+ * of the bulk load, the journal is kept in memory and SQLite does not wait for
+ * data to reach the disk before continuing. This greatly improves the speed of
+ * large inserts, such as those performed when converting raw data files into
+ * an experiment database, at the cost of possibly corrupting the database if
+ * the process or system crashes before the bulk load ends. Bulk loads may be
+ * nested and the original settings are restored when the outer-most bulk load
+ * ends.
+ *
+ * @note    These settings only apply to the calling thread's database handle.
+ *          Bulk loads may only be begun outside of a transaction. Any attempt
+ *          to begin a bulk load within a transaction will result in an
+ *          assertion failure.
+ */
+void Database::beginBulkLoad()
+{
+    // Get our per-thread database handle
+    Handle& handle = getHandle();
+
+    // Check assertions
+    Assert(handle.dm_database != NULL);
+    Assert(handle.dm_transaction.empty());
+
+    // Is this the outermost bulk load?
+    if(handle.dm_bulk_load_depth++ == 0) {
+
+	sqlite3_stmt* stmt = NULL;
+
+	// Save the current synchronous setting
+	Assert(sqlite3_prepare_v2(handle.dm_database, "PRAGMA synchronous;",
+				  -1, &stmt, NULL) == SQLITE_OK);
+	if(sqlite3_step(stmt) == SQLITE_ROW)
+	    handle.dm_saved_synchronous = sqlite3_column_int(stmt, 0);
+	Assert(sqlite3_finalize(stmt) == SQLITE_OK);
+
+	// Save the current journal mode
+	Assert(sqlite3_prepare_v2(handle.dm_database, "PRAGMA journal_mode;",
+				  -1, &stmt, NULL) == SQLITE_OK);
+	if(sqlite3_step(stmt) == SQLITE_ROW)
+	    handle.dm_saved_journal_mode = reinterpret_cast<const char*>(
+		sqlite3_column_text(stmt, 0)
+		);
+	Assert(sqlite3_finalize(stmt) == SQLITE_OK);
+
+	// Tune the journal and synchronous settings for the bulk load
+	Assert(sqlite3_exec(handle.dm_database, "PRAGMA synchronous = OFF;",
+			    NULL, NULL, NULL) == SQLITE_OK);
+	Assert(sqlite3_exec(handle.dm_database, "PRAGMA journal_mode = MEMORY;",
+			    NULL, NULL, NULL) == SQLITE_OK);
+
+    }
+}
+
+
+
+/**
+ * Insert rows into a table.
+ *
+ * Inserts the passed rows into the specified columns of a table. Multiple rows
+ * are inserted by each execution of a single, cached, prepared statement. This
+ * is significantly faster than preparing, binding, and executing a statement
+ * for every row. The rows are given consecutive unique IDs in the same order
+ * as they are passed. The unique ID of the first row is thus given by the
+ * value of getLastInsertedUID(), following the insert, minus the number of
+ * rows plus one.
+ *
+ * @note    Rows may only be inserted within the context of a transaction. Any
+ *          attempt to insert rows before beginning a transaction will result in
+ *          an assertion failure. Every row must have one value for each column
+ *          or an assertion failure will result.
+ *
+ * @param table      Name of the table into which rows are to be inserted.
+ * @param columns    Names of the columns for which values are given.
+ * @param rows       Rows to be inserted.
+ */
+void Database::insertRows(const std::string& table,
+			  const std::vector<std::string>& columns,
+			  const std::vector<Row>& rows)
+{
+    const unsigned MaximumRowsPerStatement = 64;
+
+    // Get our per-thread database handle
+    Handle& handle = getHandle();
+
+    // Check assertions
+    Assert(handle.dm_database != NULL);
+    Assert(!handle.dm_transaction.empty());
+    Assert(!columns.empty());
+
+    // Determine the number of rows that can be inserted by each statement
+    unsigned rows_per_statement = std::min<unsigned>(
+	MaximumRowsPerStatement,
+	sqlite3_limit(handle.dm_database, SQLITE_LIMIT_VARIABLE_NUMBER, -1) /
+	columns.size()
+	);
+    if(rows_per_statement == 0)
+	rows_per_statement = 1;
+
+    // Construct the column list and the placeholder for a single row
+    std::string column_list, row_placeholder;
+    for(std::vector<std::string>::const_iterator
+	    i = columns.begin(); i != columns.end(); ++i) {
+	column_list += (i == columns.begin()) ? "" : ", ";
+	column_list += *i;
+	row_placeholder += (i == columns.begin()) ? "(?" : ", ?";
+    }
+    row_placeholder += ")";
+
+    // Iterate over the rows to be inserted, one statement's worth at a time
+    std::string statement;
+    unsigned statement_rows = 0;
+    for(std::vector<Row>::size_type i = 0; i < rows.size();) {
+	unsigned n = std::min<unsigned>(rows_per_statement, rows.size() - i);
+
+	// Construct the statement to insert this number of rows (if necessary)
+	if(n != statement_rows) {
+	    statement = "INSERT INTO " + table + " (" + column_list + ") VALUES ";
+	    for(unsigned j = 0; j < n; ++j)
+		statement += ((j == 0) ? "" : ", ") + row_placeholder;
+	    statement += ";";
+	    statement_rows = n;
+	}
+
+	// Prepare the statement (reusing the cached copy if possible)
+	prepareStatement(statement);
+	sqlite3_stmt* stmt = handle.dm_transaction.back();
+
+	// Bind the values of each of the rows
+	for(unsigned j = 0; j < n; ++i, ++j) {
+	    const std::vector<Row::Value>& values = rows[i].dm_values;
+	    Assert(values.size() == columns.size());
+	    for(std::vector<Row::Value>::size_type k = 0; k < values.size(); ++k) {
+		int index = (j * columns.size()) + k + 1;
+		switch(values[k].dm_type) {
+		case Row::Value::Integer:
+		    Assert(sqlite3_bind_int64(stmt, index, values[k].dm_integer)
+			   == SQLITE_OK);
+		    break;
+		case Row::Value::Text:
+		    Assert(sqlite3_bind_text(stmt, index,
+					     values[k].dm_text.data(),
+					     values[k].dm_text.size(),
+					     SQLITE_STATIC) == SQLITE_OK);
+		    break;
+		case Row::Value::Binary:
+		    Assert(sqlite3_bind_blob(stmt, index, values[k].dm_pointer,
+					     values[k].dm_size, SQLITE_STATIC)
+			   == SQLITE_OK);
+		    break;
+		default:
+		    break;
+		}
+	    }
+	}
+	
+	// Execute the statement
+	while(executeStatement());
+	
+    }
+}
+
+
+
+/**
+ * End a bulk load.
+ *
+ * Ends a bulk load of this database by the calling thread. The journal and
+ * synchronous settings in effect before the outer-most bulk load began are
+ * restored when that bulk load ends.
+ *
+ * @note    Any attempt to end a bulk load that was not first begun with a call
+ *          to beginBulkLoad(), or to end a bulk load within a transaction, will
+ *          result in an assertion failure.
+ */
+void Database::endBulkLoad()
+{
+    // Get our per-thread database handle
+    Handle& handle = getHandle();
+
+    // Check assertions
+    Assert(handle.dm_database != NULL);
+    Assert(handle.dm_transaction.empty());
+    Assert(handle.dm_bulk_load_depth > 0);
+
+    // Is this the outermost bulk load?
+    if(--handle.dm_bulk_load_depth == 0) {
+
+	// Restore the original journal and synchronous settings
+	std::stringstream synchronous;
+	synchronous << "PRAGMA synchronous = "
+		    << handle.dm_saved_synchronous << ";";
+	Assert(sqlite3_exec(handle.dm_database, synchronous.str().c_str(),
+			    NULL, NULL, NULL) == SQLITE_OK);
+	std::string journal_mode =
+	    "PRAGMA journal_mode = " + handle.dm_saved_journal_mode + ";";
+	Assert(sqlite3_exec(handle.dm_database, journal_mode.c_str(),
+			    NULL, NULL, NULL) == SQLITE_OK);
+
+    }
+}
+
+
+
+/**
+ * Constructor from a SQL statement.
+ *
+ * Registers the passed SQL statement, assigning it an identifier by which it
+ * may be repeatedly prepared. Registering the same statement more than once
+ * yields the same identifier.
+ *
+ * @param statement    SQL statement to be registered.
+ */
+Database::RegisteredStatement::RegisteredStatement(
+    const std::string& statement
+    ) :
+    dm_identifier(getStatementRegistry().add(statement))
+{
+}
+
+
+
+/**
+ * Append a string value.
+ *
+ * Appends a copy of the string, so temporaries may be appended.
+ *
+ * @param value    String value to be appended to this row.
+ * @return         This row.
+ */
+Database::Row& Database::Row::operator<<(const std::string& value)
+{
+    Value entry;
+    entry.dm_type = Value::Text;
+    entry.dm_integer = 0;
+    entry.dm_text = value;
+    entry.dm_pointer = NULL;
+    entry.dm_size = 0;
+    dm_values.push_back(entry);
+    return *this;
+}
+
+
+
+/**
+ * Append a signed integer value.
+ *
+ * @param value    Signed integer value to be appended to this row.
+ * @return         This row.
+ */
+Database::Row& Database::Row::operator<<(const int& value)
+{
+    return append(static_cast<int64_t>(value));
+}
+
+
+
+/**
+ * Append a blob value.
+ *
+ * @param value    Blob value to be appended to this row.
+ * @return         This row.
+ */
+Database::Row& Database::Row::operator<<(const Blob& value)
+{
+    return append(value.getContents(), value.getSize());
+}
+
+
+
+/**
+ * Append a blob value by its contents.
+ *
+ * Appends a blob value given only the location and size of its contents. Used
+ * to reference part of an existing buffer without first copying it into a new
+ * blob.
+ *
+ * @param size        Size of the blob's contents.
+ * @param contents    Pointer to the blob's contents.
+ * @return            This row.
+ */
+Database::Row& Database::Row::appendBlob(const unsigned& size,
+					 const void* contents)
+{
+    return append(contents, size);
+}
+
+
+
+/**
+ * Append an address value.
+ *
+ * @param value    Address value to be appended to this row.
+ * @return         This row.
+ */
+Database::Row& Database::Row::operator<<(const Address& value)
+{
+    return append(static_cast<int64_t>(value.getValue()) - signedOffset);
+}
+
+
+
+/**
+ * Append a time value.
+ *
+ * @param value    Time value to be appended to this row.
+ * @return         This row.
+ */
+Database::Row& Database::Row::operator<<(const Time& value)
+{
+    return append(static_cast<int64_t>(value.getValue()) - signedOffset);
+}
+
+
+
+/**
+ * Append an integer value.
+ *
+ * @param value    Integer value (already converted to signed) to be appended.
+ * @return         This row.
+ */
+Database::Row& Database::Row::append(const int64_t& value)
+{
+    Value entry;
+    entry.dm_type = Value::Integer;
+    entry.dm_integer = value;
+    entry.dm_pointer = NULL;
+    entry.dm_size = 0;
+    dm_values.push_back(entry);
+    return *this;
+}
+
+
+
+/**
+ * Append a binary value.
+ *
+ * @param pointer    Pointer to the value.
+ * @param size       Size of the value in bytes.
+ * @return           This row.
+ */
+Database::Row& Database::Row::append(const void* pointer, const int& size)
+{
+    Value entry;
+    entry.dm_type = (pointer == NULL) ? Value::Null : Value::Binary;
+    entry.dm_integer = 0;
+    entry.dm_pointer = pointer;
+    entry.dm_size = size;
+    dm_values.push_back(entry);
+    return *this;
+}
+
+
+
 /**
  * Copy a file.
  *
@@ -1407,15 +1956,52 @@ void Database::copyFile(const Path& source, const Path& destination)
 
 
 
+/** Per-thread cached database handles. */
+__thread Database::CachedHandle
+Database::the_cached_handles[Database::CachedHandleCount];
+
+
+
 /**
  * Get our per-thread database handle.
  *
  * Returns the per-thread database handle for the executing thread. A new handle
- * is created if the executing thread didn't already have a handle.
+ * is created if the executing thread didn't already have a handle. The handle
+ * is normally found, without acquiring any lock, in a small per-thread cache
+ * of the handles most recently used by the executing thread.
  *
  * @return    Database handle for the executing thread.
  */
 Database::Handle& Database::getHandle()
+{
+    uint64_t serial = __sync_fetch_and_add(&dm_serial, 0);
+    CachedHandle& cached = the_cached_handles[serial % CachedHandleCount];
+
+    // Use the executing thread's cached handle for this database if present
+    if((cached.dm_database == this) && (cached.dm_serial == serial))
+	return *cached.dm_handle;
+
+    // Otherwise find the handle and cache it
+    Handle& handle = getHandleSlowly();
+    cached.dm_database = this;
+    cached.dm_serial = serial;
+    cached.dm_handle = &handle;
+    return handle;
+}
+
+
+
+/**
+ * Find our per-thread database handle.
+ *
+ * Returns the per-thread database handle for the executing thread by searching
+ * the map of all per-thread handles. A new handle is created if the executing
+ * thread didn't already have a handle. Used by getHandle() when the executing
+ * thread hasn't cached its handle.
+ *
+ * @return    Database handle for the executing thread.
+ */
+Database::Handle& Database::getHandleSlowly()
 {
     Guard guard_myself(this);
     
@@ -1466,6 +2052,82 @@ Database::Handle& Database::getHandle()
 
 
 
+/**
+ * Compile a SQL statement.
+ *
+ * Parses the passed SQL statement into a new prepared statement and adds it to
+ * the prepared statement cache of the specified per-thread database handle.
+ *
+ * @note    An assertion failure occurs if the SQL statement contains a syntax
+ *          error. A DatabaseInvalid exception is thrown if the statement cannot
+ *          be prepared for any other reason (e.g. a query against a table that
+ *          doesn't exist).
+ *
+ * @param handle       Handle for which to compile the statement.
+ * @param statement    SQL statement to be compiled.
+ * @return             New prepared statement.
+ */
+sqlite3_stmt* Database::compileStatement(Handle& handle,
+					 const std::string& statement)
+{
+    sqlite3_stmt* stmt = NULL;
+    const char* tail = NULL;
+
+    // switched to sqlite3_prepare_v2 from sqlite3_prepare on July 7, 2014
+    // this change appears to have fixed database version update problems that
+    // had been occurring when old databases were read with a newer version of 
+    // OpenSpeedShop that supported a different database schema.
+
+    int retval = sqlite3_prepare_v2(handle.dm_database, 
+				    statement.c_str(), statement.size(),
+				    &stmt, &tail);
+    if(retval == SQLITE_ERROR) {
+	std::string errmsg = sqlite3_errmsg(handle.dm_database);
+	if(errmsg.find("syntax error") == std::string::npos)
+	    throw Exception(Exception::DatabaseInvalid, getName(), errmsg);
+    }
+    Assert(retval == SQLITE_OK);
+    Assert((tail != NULL) && (*tail == '\0'));
+    Assert(stmt != NULL);
+	
+    // Cache this prepared statement for future use
+    handle.dm_cache.insert(std::make_pair(statement, stmt));
+
+    // Return the prepared statement to the caller
+    return stmt;
+}
+
+
+
+/**
+ * Push a prepared statement.
+ *
+ * Clears any arguments of the passed prepared statement by binding them to
+ * null values and then pushes it onto the transaction stack of the specified
+ * per-thread database handle.
+ *
+ * @param handle    Handle onto which to push the statement.
+ * @param stmt      Prepared statement to be pushed.
+ */
+void Database::pushStatement(Handle& handle, sqlite3_stmt* stmt)
+{
+    // Check assertions
+    Assert(stmt != NULL);
+    
+    // Bind NULL values to all arguments of this statement
+    for(int i = 1; i <= sqlite3_bind_parameter_count(stmt); ++i)
+	Assert(sqlite3_bind_null(stmt, i) == SQLITE_OK);
+
+    // Push this statement onto the transaction stack
+    handle.dm_transaction.push_back(stmt);
+#ifndef NDEBUG
+    if(is_debug_enabled)
+	handle.dm_debug_start.push_back(Time::Now());
+#endif	
+}
+
+
+
 /**
  * Remove all per-thread database handles.
  * 
@@ -1496,8 +2158,9 @@ void Database::releaseAllHandles()
 	    ++j)
 	    Assert(sqlite3_finalize(j->second) == SQLITE_OK);
 	
-	// Clear the prepared statement cache
+	// Clear the prepared statement caches
 	i->second.dm_cache.clear();
+	i->second.dm_registered.clear();
 	
 	// Close the SQLite handle for this database
 	Assert(sqlite3_close(i->second.dm_database) == SQLITE_OK);    
@@ -1506,6 +2169,9 @@ void Database::releaseAllHandles()
     
     // Clear the per-thread database handles
     dm_handles.clear();
+
+    // Invalidate all per-thread cached handles for this database
+    __sync_lock_test_and_set(&dm_serial, __sync_add_and_fetch(&next_serial, 1));
 }
 
 void Database::vacuum()
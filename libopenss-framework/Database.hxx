@@ -29,6 +29,7 @@
 #include "config.h"
 #endif
 
+#include "Blob.hxx"
 #include "Lockable.hxx"
 #include "Time.hxx"
 
@@ -48,7 +49,6 @@ struct sqlite3_stmt;
 namespace OpenSpeedShop { namespace Framework {
 
     class Address;
-    class Blob;
     class Path;
 
     /**
@@ -82,6 +82,82 @@ namespace OpenSpeedShop { namespace Framework {
 
     public:
 
+	/**
+	 * Row of values.
+	 *
+	 * Row of values to be inserted into a table by insertRows(). Values are
+	 * appended, in the same order as the columns passed to insertRows(), by
+	 * using operator "<<". String values are copied. Blob values are
+	 * referenced, rather than copied, and must remain valid until
+	 * insertRows() returns.
+	 */
+	class Row
+	{
+	    friend class Database;
+
+	public:
+
+	    Row& operator<<(const std::string&);
+	    Row& operator<<(const int&);
+	    Row& operator<<(const Blob&);
+	    Row& operator<<(const Address&);
+	    Row& operator<<(const Time&);
+
+	    Row& appendBlob(const unsigned&, const void*);
+
+	private:
+
+	    /** Single value within a row. */
+	    struct Value
+	    {
+		/** Type of this value. */
+		enum { Null, Integer, Text, Binary } dm_type;
+
+		/** Integer value (when an integer). */
+		int64_t dm_integer;
+
+		/** Copy of the value (when text). */
+		std::string dm_text;
+
+		/** Pointer to the value (when binary). */
+		const void* dm_pointer;
+
+		/** Size of the value in bytes (when binary). */
+		int dm_size;
+	    };
+
+	    /** Values in this row. */
+	    std::vector<Value> dm_values;
+
+	    Row& append(const int64_t&);
+	    Row& append(const void*, const int&);
+
+	};
+
+	/**
+	 * Registered SQL statement.
+	 *
+	 * Identifier for a SQL statement that is registered, once, for repeated
+	 * preparation via prepareStatement(). Frequently executed statements
+	 * should be registered, typically at file scope, so that preparing them
+	 * locates their cached prepared copies by index rather than by hashing
+	 * and comparing the full text of the statement.
+	 */
+	class RegisteredStatement
+	{
+	    friend class Database;
+
+	public:
+
+	    explicit RegisteredStatement(const std::string&);
+
+	private:
+
+	    /** Identifier of this statement. */
+	    unsigned dm_identifier;
+
+	};
+
 	static bool isAccessible(const std::string&);
 	static void create(const std::string&);
 	static void remove(const std::string&);
@@ -93,9 +169,12 @@ namespace OpenSpeedShop { namespace Framework {
 	void copyTo(const std::string&);
 	
 	std::string getName() const;
+	uint64_t getGeneration() const;
+	bool hasUncommittedChanges();
 
 	void beginTransaction(const bool& = false);
 	void prepareStatement(const std::string&);
+	void prepareStatement(const RegisteredStatement&);
 	
 	void bindArgument(const unsigned&, const std::string&);
 	void bindArgument(const unsigned&, const int&);
@@ -111,16 +190,24 @@ namespace OpenSpeedShop { namespace Framework {
 	std::string getResultAsString(const unsigned&);
 	int getResultAsInteger(const unsigned&);
 	double getResultAsReal(const unsigned&);
-	Blob getResultAsBlob(const unsigned&);
+	Blob getResultAsBlob(const unsigned&,
+			     const Blob::Ownership& = Blob::Copy);
 	Address getResultAsAddress(const unsigned&);
 	Time getResultAsTime(const unsigned&);
 	pthread_t getResultAsPosixThreadId(const unsigned&);
 
 	int getLastInsertedUID();
+
+	bool hasTable(const std::string&);
 	
 	void commitTransaction();
 	void rollbackTransaction();
 
+	void beginBulkLoad();
+	void insertRows(const std::string&, const std::vector<std::string>&,
+			const std::vector<Row>&);
+	void endBulkLoad();
+
 	void vacuum();
 	
     private:
@@ -137,6 +224,12 @@ namespace OpenSpeedShop { namespace Framework {
 	
 	/** Lock indicating when transactions are in-progress. */
 	pthread_rwlock_t dm_transaction_lock;	
+
+	/** Number of completed transactions that changed this database. */
+	uint64_t dm_generation;
+
+	/** Serial number identifying this database's current handles. */
+	uint64_t dm_serial;
 	
 	/**
 	 * Database handle.
@@ -164,6 +257,9 @@ namespace OpenSpeedShop { namespace Framework {
 	    
 	    /** Map query strings to their cached prepared statement. */
 	    std::multimap<std::string, sqlite3_stmt*> dm_cache;
+
+	    /** Cached prepared copies of each registered statement. */
+	    std::vector<std::vector<sqlite3_stmt*> > dm_registered;
 	    
 	    /**
 	     * Transaction stack.
@@ -190,17 +286,34 @@ namespace OpenSpeedShop { namespace Framework {
 
 	    /** Flag indicating if outer-most transaction is commitable. */
 	    bool dm_is_committable;
+
+	    /** Total changes made when outer-most transaction was begun. */
+	    int dm_total_changes;
+
+	    /** Nesting depth of bulk loads. */
+	    unsigned dm_bulk_load_depth;
+
+	    /** Synchronous setting in effect before the bulk load. */
+	    int dm_saved_synchronous;
+
+	    /** Journal mode in effect before the bulk load. */
+	    std::string dm_saved_journal_mode;
 	    
 	    /** Default constructor. */
 	    Handle() :
 		dm_database(NULL),
 		dm_cache(),
+		dm_registered(),
 		dm_transaction(),
 #ifndef NDEBUG
 		dm_debug_start(),
 		dm_debug_stats(),
 #endif
-		dm_is_committable(false)
+		dm_is_committable(false),
+		dm_total_changes(0),
+		dm_bulk_load_depth(0),
+		dm_saved_synchronous(2),
+		dm_saved_journal_mode("delete")
 	    {
 	    }
 
@@ -209,9 +322,40 @@ namespace OpenSpeedShop { namespace Framework {
 	/** Map threads to their database handle. */	
 	std::map<pthread_t, Handle> dm_handles;
 
+	/**
+	 * Cached database handle.
+	 *
+	 * Structure for a per-thread cache entry identifying the handle most
+	 * recently used by the thread for a given database. The serial number
+	 * of the database guards against use of a handle that was released, or
+	 * of a database that was destroyed and then reallocated at the same
+	 * address.
+	 */
+	struct CachedHandle
+	{
+	    /** Database for which the handle was cached. */
+	    const Database* dm_database;
+
+	    /** Serial number of that database when the handle was cached. */
+	    uint64_t dm_serial;
+
+	    /** Cached handle. */
+	    Handle* dm_handle;
+	};
+
+	/** Number of per-thread cached database handles. */
+	static const unsigned CachedHandleCount = 4;
+
+	/** Per-thread cached database handles. */
+	static __thread CachedHandle the_cached_handles[CachedHandleCount];
+
 	Handle& getHandle();
+	Handle& getHandleSlowly();
 	void releaseAllHandles();
 
+	sqlite3_stmt* compileStatement(Handle&, const std::string&);
+	void pushStatement(Handle&, sqlite3_stmt*);
+
 #ifndef NDEBUG
 	static bool is_debug_enabled;
 	
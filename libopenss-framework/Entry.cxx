@@ -24,6 +24,7 @@
  */
 
 #include "Assert.hxx"
+#include "AttributeCache.hxx"
 #include "Entry.hxx"
 #include "Exception.hxx"
 
@@ -31,6 +32,11 @@ using namespace OpenSpeedShop::Framework;
 
 
 
+/** Entry attribute cache. */
+AttributeCache Entry::TheAttributeCache;
+
+
+
 /**
  * Less-than operator.
  *
@@ -40,7 +40,9 @@
 
 namespace OpenSpeedShop { namespace Framework {
 
+    class AttributeCache;
     class EntrySpy;
+    class Experiment;
 
     /**       
      * Entry within a database table.
@@ -56,6 +58,7 @@ namespace OpenSpeedShop { namespace Framework {
 	public TotallyOrdered<Entry>
     {
 	friend class EntrySpy;
+	friend class Experiment;
 
     public:
 
@@ -104,6 +107,8 @@ bool operator<(const Entry& other) const
 	std::string getTable() const;
 	
 	void validate() const;
+
+	static AttributeCache TheAttributeCache;
 	
 	/** Database containing this entry. */
         SmartPtr<Database> dm_database;
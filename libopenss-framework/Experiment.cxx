@@ -26,6 +26,7 @@
 
 #include "AddressBitmap.hxx"
 #include "AddressSpace.hxx"
+#include "AttributeCache.hxx"
 #include "CollectorGroup.hxx"
 #include "DataCache.hxx"
 #include "DataQueues.hxx"
@@ -33,6 +34,8 @@
 #include "Experiment.hxx"
 #include "Function.hxx"
 #include "FunctionCache.hxx"
+#include "InlineFunction.hxx"
+#include "InlineFunctionCache.hxx"
 #include "Instrumentor.hxx"
 #include "LinkedObject.hxx"
 #include "Loop.hxx"
@@ -268,6 +271,27 @@ namespace {
         "    view_data BLOB"
 	");",
 
+	// Metric Aggregates Table
+	"CREATE TABLE MetricAggregates ("
+	"    data INTEGER," // From Data.id
+	"    metric TEXT,"
+	"    addr INTEGER DEFAULT NULL,"
+	"    value REAL DEFAULT NULL"
+	");",
+	"CREATE INDEX IndexMetricAggregatesByData "
+	"  ON MetricAggregates (data,metric);",
+
+	// Address Resolutions Table
+	"CREATE TABLE AddressResolutions ("
+	"    linked_object INTEGER," // From LinkedObjects.id
+	"    addr INTEGER,"
+	"    function INTEGER DEFAULT 0," // From Functions.id
+	"    statement INTEGER DEFAULT 0," // From Statements.id
+	"    inlined_function INTEGER DEFAULT 0" // From InlinedFunctions.id
+	");",
+	"CREATE INDEX IndexAddressResolutionsByLinkedObject "
+	"  ON AddressResolutions (linked_object);",
+
 	// End Of Table Entry
 	NULL
     };
@@ -563,6 +587,9 @@ Experiment::Experiment(const std::string& name) :
     if(getVersion() == 8)
         updateToVersion9();
 
+    // Add the optional tables if necessary
+    addOptionalTables();
+
 #if (BUILD_INSTRUMENTOR == 1)
     // Iterate over each thread in this experiment
     ThreadGroup threads = getThreads();
@@ -642,6 +669,7 @@ Experiment::~Experiment()
     Function::TheCache.removeDatabase(dm_database);
     Loop::TheCache.removeDatabase(dm_database);
     Statement::TheCache.removeDatabase(dm_database);
+    Entry::TheAttributeCache.removeDatabase(dm_database);
 }
 
 
@@ -1343,6 +1371,14 @@ void Experiment::removeThread(const Thread& thread) const
     dm_database->bindArgument(1, EntrySpy(thread).getEntry());
     while(dm_database->executeStatement());    
 
+    // Remove any metric aggregates of the data associated with this thread
+    dm_database->prepareStatement(
+	"DELETE FROM MetricAggregates "
+	"WHERE data IN (SELECT id FROM Data WHERE thread = ?);"
+	);
+    dm_database->bindArgument(1, EntrySpy(thread).getEntry());
+    while(dm_database->executeStatement());    
+
     // Remove any data associated with this thread
     dm_database->prepareStatement("DELETE FROM Data WHERE thread = ?;");
     dm_database->bindArgument(1, EntrySpy(thread).getEntry());
@@ -1356,6 +1392,14 @@ void Experiment::removeThread(const Thread& thread) const
 	);
     while(dm_database->executeStatement());
 
+    // Remove unused address resolutions
+    dm_database->prepareStatement(
+	"DELETE FROM AddressResolutions "
+	"WHERE linked_object "
+	"  NOT IN (SELECT DISTINCT linked_object FROM AddressSpaces);"
+	);
+    while(dm_database->executeStatement());
+
     // Remove unused functions
     dm_database->prepareStatement(
 	"DELETE FROM Functions "
@@ -1538,6 +1582,14 @@ void Experiment::removeCollector(const Collector& collector) const
     dm_database->bindArgument(1, EntrySpy(collector).getEntry());
     while(dm_database->executeStatement());    
     
+    // Remove any metric aggregates of the data associated with this collector
+    dm_database->prepareStatement(
+	"DELETE FROM MetricAggregates "
+	"WHERE data IN (SELECT id FROM Data WHERE collector = ?);"
+	);
+    dm_database->bindArgument(1, EntrySpy(collector).getEntry());
+    while(dm_database->executeStatement());    
+    
     // Remove any data associated with this collector
     dm_database->prepareStatement("DELETE FROM Data WHERE collector = ?;");
     dm_database->bindArgument(1, EntrySpy(collector).getEntry());
@@ -1718,6 +1770,33 @@ void Experiment::flushPerformanceData() const
 
 
 
+/**
+ * Begin a bulk load.
+ *
+ * Begins a bulk load of this experiment's database by the calling thread. Used
+ * by tools that are about to store a large amount of data into the experiment,
+ * such as when converting raw data files, to trade crash safety for speed until
+ * the matching call to endBulkLoad().
+ */
+void Experiment::beginBulkLoad() const
+{
+    dm_database->beginBulkLoad();
+}
+
+
+
+/**
+ * End a bulk load.
+ *
+ * Ends a bulk load of this experiment's database by the calling thread.
+ */
+void Experiment::endBulkLoad() const
+{
+    dm_database->endBulkLoad();
+}
+
+
+
 /**
  * Get performance data extent.
  *
@@ -2242,8 +2321,7 @@ void Experiment::updateToVersion4() const
 	
 	// Construct a valid bitmap for this (entire) function range
 	AddressBitmap valid_bitmap(AddressRange(addr_begin, addr_end));
-	for(Address addr = addr_begin; addr < addr_end; ++addr)
-	    valid_bitmap.setValue(addr, true);
+	valid_bitmap.setValue(valid_bitmap.getRange(), true);
 	
 	// Set the valid bitmap of this function range
 	dm_database->prepareStatement(
@@ -2487,6 +2565,62 @@ void Experiment::updateToVersion9() const
 }
 
 
+/**
+ * Add the optional tables.
+ *
+ * Adds the empty metric aggregates and address resolutions tables to this
+ * experiment's database if it doesn't already have them. Unlike the versioned
+ * schema updates, the database is left unchanged when it is read-only. These
+ * tables hold only information derived from other tables and are simply not
+ * available in that case.
+ */
+void Experiment::addOptionalTables() const
+{
+    // Update procedure
+    const char* UpdateProcedure[] = {
+
+	// Metric Aggregates Table
+	"CREATE TABLE IF NOT EXISTS MetricAggregates ("
+	"    data INTEGER," // From Data.id
+	"    metric TEXT,"
+	"    addr INTEGER DEFAULT NULL,"
+	"    value REAL DEFAULT NULL"
+	");",
+	"CREATE INDEX IF NOT EXISTS IndexMetricAggregatesByData "
+	"  ON MetricAggregates (data,metric);",
+
+	// Address Resolutions Table
+	"CREATE TABLE IF NOT EXISTS AddressResolutions ("
+	"    linked_object INTEGER," // From LinkedObjects.id
+	"    addr INTEGER,"
+	"    function INTEGER DEFAULT 0," // From Functions.id
+	"    statement INTEGER DEFAULT 0," // From Statements.id
+	"    inlined_function INTEGER DEFAULT 0" // From InlinedFunctions.id
+	");",
+	"CREATE INDEX IF NOT EXISTS IndexAddressResolutionsByLinkedObject "
+	"  ON AddressResolutions (linked_object);",
+
+	// End Of Table Entry
+	NULL
+    };
+
+    // Apply the update procedure
+    try {
+	BEGIN_WRITE_TRANSACTION(dm_database);
+	for(int i = 0; UpdateProcedure[i] != NULL; ++i) {
+	    dm_database->prepareStatement(UpdateProcedure[i]);
+	    while(dm_database->executeStatement());
+	}
+	END_TRANSACTION(dm_database);
+    }
+    catch(const Exception& error) {
+	if(error.getCode() != Exception::DatabaseReadOnly)
+	    throw;
+    }
+}
+
+
+
 /**
  * Get MPI job information from MPT.
  *
@@ -3269,11 +3403,167 @@ void Experiment::compressDB() const
 	);
     while(dm_database->executeStatement());
 
+    dm_database->prepareStatement(
+	"DELETE FROM AddressResolutions "
+	"WHERE linked_object NOT IN (SELECT DISTINCT id FROM LinkedObjects);"
+	);
+    while(dm_database->executeStatement());
+
     END_TRANSACTION(dm_database);
 
 }
 
 
+/**
+ * Resolve the sampled addresses.
+ *
+ * Finds the unique addresses sampled by every collector in every thread of
+ * this experiment, and stores the functions, statements, and inlined functions
+ * containing each of them in the address resolutions table. Later queries for
+ * these addresses, e.g. Thread::getFunctionAt(), are then answered without the
+ * symbol information of the entire linked object containing them having to be
+ * loaded. Addresses that were resolved previously are skipped, allowing the
+ * table to be extended as more threads are added to this experiment.
+ */
+void Experiment::resolveSampledAddresses() const
+{
+    ThreadGroup threads = getThreads();
+    CollectorGroup collectors = getCollectors();
+
+    // Search for sampled addresses within all of the performance data
+    ExtentGroup extents;
+    extents.push_back(getPerformanceDataExtent());
+    if(extents.front().isEmpty())
+	return;
+
+    // Sampled addresses, relative to their linked object, for each linked object
+    std::map<LinkedObject, std::set<Address> > sampled;
+
+    // Iterate over each thread of this experiment
+    for(ThreadGroup::const_iterator
+	    i = threads.begin(); i != threads.end(); ++i) {
+
+	// Find the unique addresses sampled in this thread
+	std::set<Address> addresses;
+	for(CollectorGroup::const_iterator
+		j = collectors.begin(); j != collectors.end(); ++j)
+	    j->getUniquePCValues(*i, extents, addresses);
+	if(addresses.empty())
+	    continue;
+
+	// Find this thread's address spaces, indexed by their beginning address
+	std::map<Address, std::pair<Address, int> > spaces;
+	BEGIN_TRANSACTION(dm_database);
+	dm_database->prepareStatement(
+	    "SELECT addr_begin, "
+	    "       addr_end, "
+	    "       linked_object "
+	    "FROM AddressSpaces "
+	    "WHERE thread = ?;"
+	    );
+	dm_database->bindArgument(1, EntrySpy(*i).getEntry());
+	while(dm_database->executeStatement())
+	    spaces.insert(std::make_pair(
+		dm_database->getResultAsAddress(1),
+		std::make_pair(dm_database->getResultAsAddress(2),
+			       dm_database->getResultAsInteger(3))
+		));
+	END_TRANSACTION(dm_database);
+
+	// Find the linked object, and offset within it, of each address
+	for(std::set<Address>::const_iterator
+		j = addresses.begin(); j != addresses.end(); ++j) {
+	    std::map<Address, std::pair<Address, int> >::const_iterator
+		k = spaces.upper_bound(*j);
+	    if(k == spaces.begin())
+		continue;
+	    --k;
+	    if(*j < k->second.first)
+		sampled[LinkedObject(dm_database, k->second.second)].insert(
+		    Address(*j - k->first)
+		    );
+	}
+
+    }
+
+    // Address resolutions to be stored
+    std::vector<std::string> columns;
+    columns.push_back("linked_object");
+    columns.push_back("addr");
+    columns.push_back("function");
+    columns.push_back("statement");
+    columns.push_back("inlined_function");
+    std::vector<Database::Row> rows;
+
+    // Iterate over each linked object containing sampled addresses
+    for(std::map<LinkedObject, std::set<Address> >::const_iterator
+	    i = sampled.begin(); i != sampled.end(); ++i) {
+	int linked_object = EntrySpy(i->first).getEntry();
+
+	// Find the addresses in this linked object that were resolved already
+	std::set<Address> resolved;
+	BEGIN_TRANSACTION(dm_database);
+	dm_database->prepareStatement(
+	    "SELECT addr FROM AddressResolutions WHERE linked_object = ?;"
+	    );
+	dm_database->bindArgument(1, linked_object);
+	while(dm_database->executeStatement())
+	    resolved.insert(dm_database->getResultAsAddress(1));
+	END_TRANSACTION(dm_database);
+
+	// Iterate over each sampled address that is yet to be resolved
+	for(std::set<Address>::const_iterator
+		j = i->second.begin(); j != i->second.end(); ++j) {
+	    if(resolved.find(*j) != resolved.end())
+		continue;
+
+	    // Resolve this address
+	    std::set<Function> functions =
+		Function::TheCache.getFunctionsAt(i->first, *j);
+	    std::set<Statement> statements =
+		Statement::TheCache.getStatementsAt(i->first, *j);
+	    std::set<InlineFunction> inlines =
+		InlineFunction::TheCache.getInlineFunctionsAt(i->first, *j);
+
+	    // Add one row for each function, statement, and inlined function
+	    // found, or a single row indicating that none were found
+	    for(std::set<Function>::const_iterator
+		    k = functions.begin(); k != functions.end(); ++k) {
+		rows.push_back(Database::Row());
+		rows.back() << linked_object << *j << EntrySpy(*k).getEntry()
+			    << 0 << 0;
+	    }
+	    for(std::set<Statement>::const_iterator
+		    k = statements.begin(); k != statements.end(); ++k) {
+		rows.push_back(Database::Row());
+		rows.back() << linked_object << *j << 0
+			    << EntrySpy(*k).getEntry() << 0;
+	    }
+	    for(std::set<InlineFunction>::const_iterator
+		    k = inlines.begin(); k != inlines.end(); ++k) {
+		rows.push_back(Database::Row());
+		rows.back() << linked_object << *j << 0 << 0
+			    << EntrySpy(*k).getEntry();
+	    }
+	    if(functions.empty() && statements.empty() && inlines.empty()) {
+		rows.push_back(Database::Row());
+		rows.back() << linked_object << *j << 0 << 0 << 0;
+	    }
+
+	}
+
+    }
+
+    // Store the address resolutions
+    if(!rows.empty()) {
+	BEGIN_WRITE_TRANSACTION(dm_database);
+	dm_database->insertRows("AddressResolutions", columns, rows);
+	END_TRANSACTION(dm_database);
+    }
+}
+
+
+
 /**
  * Set the view command into the database as a place holder for the view data to be stored later.
  *
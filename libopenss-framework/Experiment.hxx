@@ -142,6 +142,9 @@ namespace OpenSpeedShop { namespace Framework {
 	// pruning unneeded entries in database.
 	void compressDB() const;
 
+	// pre-resolving the sampled addresses in database.
+	void resolveSampledAddresses() const;
+
 	CollectorGroup getCollectors() const;
 	Collector createCollector(const std::string&) const;
 	void removeCollector(const Collector&) const;
@@ -157,6 +160,9 @@ namespace OpenSpeedShop { namespace Framework {
 
 	void flushPerformanceData() const;
 	Extent getPerformanceDataExtent() const;
+
+	void beginBulkLoad() const;
+	void endBulkLoad() const;
 	
 	std::string getApplicationCommand();
 	void setApplicationCommand(const char *, bool trust_me);
@@ -225,6 +231,7 @@ namespace OpenSpeedShop { namespace Framework {
 	void updateToVersion7() const;
 	void updateToVersion8() const;
 	void updateToVersion9() const;
+	void addOptionalTables() const;
 
 #ifndef NDEBUG
 	static bool is_debug_mpijob_enabled;
@@ -23,13 +23,14 @@
  *
  */
 
+#include "Assert.hxx"
 #include "ExtentGroup.hxx"
 
-#include <deque>
 #ifdef HAVE_INTTYPES_H
 #include <inttypes.h>
 #endif
 #include <algorithm>
+#include <pthread.h>
 
 using namespace OpenSpeedShop::Framework;
 
@@ -37,6 +38,12 @@ using namespace OpenSpeedShop::Framework;
 
 namespace {
 
+    /** Exclusive access lock for this unnamed namespace's variables. */
+    pthread_mutex_t exclusive_access_lock = PTHREAD_MUTEX_INITIALIZER;
+
+    /** Next available tree identifier. */
+    uint64_t next_identifier = 1;
+
     /**
      * Strict weak ordering predicate for extents.
      *
@@ -92,11 +99,55 @@ namespace {
 	bool dm_by_time;
 	
     };
+
+    /**
+     * Intersection visitor appending to a vector.
+     *
+     * Visitor for ExtentGroup::visitIntersectionWith() that appends the index
+     * of each visited extent to a vector.
+     */
+    class AppendIndex
+    {
+
+    public:
+
+	/** Constructor from the vector to which indicies are appended. */
+	AppendIndex(std::vector<ExtentGroup::size_type>& indicies) :
+	    dm_indicies(indicies)
+	{
+	}
+
+	/** Evaluator for this visitor. */
+	void operator()(const ExtentGroup::size_type& index)
+	{
+	    dm_indicies.push_back(index);
+	}
+
+    private:
+
+	/** Vector to which indicies are appended. */
+	std::vector<ExtentGroup::size_type>& dm_indicies;
+
+    };
     
 }
 
 
 
+/**
+ * Default constructor.
+ *
+ * Constructs an empty extent group.
+ */
+ExtentGroup::ExtentGroup() :
+    std::vector<Extent>(),
+    dm_tree(),
+    dm_identifier(0)
+{
+}
+
+
+
 /**
  * Get our bounds.
  *
@@ -110,8 +161,8 @@ Extent ExtentGroup::getBounds() const
     if(empty())
 	return Extent();
 
-    // Initialize the tree (when necessary)
-    initializeTree();
+    // Build the tree (when necessary)
+    buildTree();
     
     // Return the bounds from the tree's root node (which contains all extents)
     return dm_tree[0].dm_bounds;
@@ -133,48 +184,9 @@ Extent ExtentGroup::getBounds() const
 std::set<ExtentGroup::size_type> 
 ExtentGroup::getIntersectionWith(const Extent& extent) const
 {
-    std::set<size_type> intersection;
-
-    // Handle special case of an empty group
-    if(empty())
-	return std::set<size_type>();
-
-    // Initialize the tree (when necessary)
-    initializeTree();
-    
-    // Initialize the traversal stack with the tree's root node
-    std::deque<std::vector<Node>::size_type> traversal;
-    traversal.push_back(0);
-    
-    // Search the tree until the traversal stack is empty
-    while(!traversal.empty()) {
-	
-	// Grab the top node from the traversal stack
-	std::vector<Node>::size_type node = traversal.front();
-	traversal.pop_front();
-	
-	// Ignore this node and its children if it doesn't intersect the extent
-	if(!extent.doesIntersect(dm_tree[node].dm_bounds))
-	    continue;
-	
-	// Build this node's children (if necessary)
-	if(dm_tree[node].dm_children == 0)
-	    buildChildren(node);
-	
-	// Push our children on the traversal stack if we're an internal node
-	if(dm_tree[node].dm_children > 0) {
-	    traversal.push_back(dm_tree[node].dm_children);
-	    traversal.push_back(dm_tree[node].dm_children + 1);	    
-	}
-	
-	// Add ourselves to the intersection results if we're a leaf node
-	else if(dm_tree[node].dm_children < 0)
-	    intersection.insert(-(dm_tree[node].dm_children + 1));
-	
-    }
-    
-    // Return the intersection to the caller
-    return intersection;
+    std::vector<size_type> intersection;
+    getIntersectionWith(extent, intersection);
+    return std::set<size_type>(intersection.begin(), intersection.end());
 }
 
 
@@ -196,11 +208,12 @@ ExtentGroup::getIntersectionWith(const ExtentGroup& extents) const
     std::set<size_type> intersection;
 
     // Iterate over each extent in the group with which to intersect
+    std::vector<size_type> subset;
     for(ExtentGroup::const_iterator 
 	    i = extents.begin(); i != extents.end(); ++i) {
 
 	// Get our intersection with this extent and accumulate the results
-	std::set<size_type> subset = getIntersectionWith(*i);
+	getIntersectionWith(*i, subset);
 	intersection.insert(subset.begin(), subset.end());
 
     }
@@ -212,98 +225,145 @@ ExtentGroup::getIntersectionWith(const ExtentGroup& extents) const
 
 
 /**
- * Initialize the Kd-tree.
+ * Get our intersection with an extent.
  *
- * Initializes the Kd-tree by initialize the tree's structures and creating
- * the root node. This is only done if the tree wasn't previously initialized,
- * of if extents have been added/removed from this group (thus requiring a
- * complete rebuild of the tree).
+ * Returns those extents in this group that intersect the specified extent. The
+ * results are returned, in ascending order, as indicies into this group within
+ * the specified vector. That vector is cleared first, but its storage is reused,
+ * so repeated queries into the same vector don't need to allocate any memory.
+ *
+ * @param extent          Extent with which to intersect.
+ * @retval intersection    Extents that intersect with this extent.
  */
-void ExtentGroup::initializeTree() const
+void ExtentGroup::getIntersectionWith(const Extent& extent,
+				      std::vector<size_type>& intersection) const
 {
-    // Is the tree already initialized?
-    if((dm_map.size() > 0) && (dm_map.size() == size()))
+    intersection.clear();
+    AppendIndex visitor(intersection);
+    visitIntersectionWith(extent, visitor);
+    std::sort(intersection.begin(), intersection.end());
+}
+
+
+
+/**
+ * Build the Kd-tree.
+ *
+ * Builds the complete Kd-tree for this group. This is done implicitly by the
+ * first search of the group, so calling this function is optional. But doing
+ * so is necessary before searching the same group from multiple threads. Once
+ * built, the tree is never modified by a search, and searches can thus safely
+ * be performed concurrently. The tree is rebuilt (by the next search or call to
+ * this function) if extents have been added/removed from this group.
+ */
+void ExtentGroup::buildTree() const
+{
+    // Is the tree already built?
+    if(empty() || (dm_tree.size() == ((2 * size()) - 1)))
 	return;
 
-    // Size and initialize the tree structures
-    dm_next = 0;
-    dm_tree.resize(2 * size(), Node());
-    dm_map.resize(size());
-    
     // Create the initial partitioning map
-    for(std::vector<ExtentGroup::size_type>::size_type
-	    i = 0; i < dm_map.size(); ++i)
-	dm_map[i] = i;
-    
-    // Create the tree's root node
-    Extent bounds;
-    for(size_type i = 0; i < size(); ++i)
-	bounds |= (*this)[i];
-    dm_tree[dm_next++] = Node(0, 0, size() - 1, bounds);
+    std::vector<size_type> map(size());
+    for(std::vector<size_type>::size_type i = 0; i < map.size(); ++i)
+	map[i] = i;
+
+    // Build the tree starting from the root node (which contains all extents)
+    dm_tree.clear();
+    dm_tree.reserve((2 * size()) - 1);
+    buildNode(map, 0, size() - 1);
+
+    // Assign a new identifier to this tree
+    Assert(pthread_mutex_lock(&exclusive_access_lock) == 0);
+    dm_identifier = next_identifier++;
+    Assert(pthread_mutex_unlock(&exclusive_access_lock) == 0);
 }
 
 
 
 /**
- * Build the children of a node.
+ * Get our identifier.
  *
- * Constructs the two children of the specified, existing, tree node. This node
- * is made into a leaf node if it only contains a single extent. Otherwise all
- * the extents enclosed by this node are partitioned into two equal sized sets
- * such that each set lies entirely on one side of a plane through the extent
- * space. Each of these sets then become one of the children.
+ * Returns the unique identifier of this group's Kd-tree, building the tree when
+ * necessary. Every (re)build of a tree is assigned a new identifier, while any
+ * copies of a group share the identifier of the original. Results computed for
+ * one identifier can thus safely be reused until the identifier changes. Empty
+ * groups, which have no tree, always have an identifier of zero.
  *
- * @param node    Node for whom children should be built
+ * @return    Unique identifier of this group's Kd-tree.
  */
-void ExtentGroup::buildChildren(const size_type& node) const
+uint64_t ExtentGroup::getIdentifier() const
 {
-    // Make the current node a leaf node if it contains a single extent
-    if(dm_tree[node].dm_first == dm_tree[node].dm_last) {
-	dm_tree[node].dm_children = -(dm_map[dm_tree[node].dm_first] + 1);
-	dm_tree[node].dm_bounds = (*this)[dm_map[dm_tree[node].dm_first]];
-	return;
-    }
+    // Handle special case of an empty group
+    if(empty())
+	return 0;
 
-    // Calculate the location of the partitioning pivot (the middle extent)
-    std::vector<ExtentGroup::size_type>::size_type nth =
-	(dm_tree[node].dm_first + dm_tree[node].dm_last) / 2;
-    
-    //
-    // Decide if the extents enclosed by this node should be partitioned by
-    // their time interval or their address range. Always select the widest of
-    // the two dimensions.
-    //
-    bool by_time = 
-	dm_tree[node].dm_bounds.getTimeInterval().getWidth() >
-	dm_tree[node].dm_bounds.getAddressRange().getWidth();
-    
-    //
-    // Partition the extents enclosed by this node in either the time interval
-    // or address range dimension. After partitioning, the first half of the
-    // extents will all lie on one side of a plane dividing the extents in the
-    // given dimension, and the second half will all lie on the other side.
-    // These two partitions then become the left and right child of this node.
-    //
-
-    std::nth_element(dm_map.begin() + dm_tree[node].dm_first,
-		     dm_map.begin() + nth,
-		     dm_map.begin() + dm_tree[node].dm_last,
-		     CompareExtents(*this, by_time));
-    
-    // Give the parent a reference to its two chilldren
-    dm_tree[node].dm_children = dm_next;
+    // Build the tree (when necessary)
+    buildTree();
+
+    return dm_identifier;
+}
+
+
+
+/**
+ * Build a node.
+ *
+ * Constructs a new tree node, and its entire subtree, enclosing the specified
+ * extents. This node is made into a leaf node if it only contains a single
+ * extent. Otherwise all the extents enclosed by this node are partitioned into
+ * two equal sized sets such that each set lies entirely on one side of a plane
+ * through the extent space. Each of these sets then become one of the children.
+ *
+ * @param map      Map used to partition extents without actually moving them.
+ * @param first    Index (into the map) of the first extent to be enclosed.
+ * @param last     Index (into the map) of the last extent to be enclosed.
+ */
+void ExtentGroup::buildNode(std::vector<size_type>& map,
+			    const size_type& first, const size_type& last) const
+{
+    // Add this node to the tree
+    std::vector<Node>::size_type node = dm_tree.size();
+    dm_tree.push_back(Node());
+    for(std::vector<size_type>::size_type i = first; i <= last; ++i)
+	dm_tree[node].dm_bounds |= (*this)[map[i]];
+
+    // Make this node a leaf node if it contains a single extent
+    if(first == last)
+	dm_tree[node].dm_extent = map[first];
+
+    else {
+
+	// Calculate the location of the partitioning pivot (the middle extent)
+	std::vector<size_type>::size_type nth = (first + last) / 2;
     
-    // Add the left child to the tree
-    Extent left_bounds;
-    for(std::vector<ExtentGroup::size_type>::size_type 
-	    i = dm_tree[node].dm_first; i <= nth; ++i)
-	left_bounds |= (*this)[dm_map[i]];
-    dm_tree[dm_next++] = Node(0, dm_tree[node].dm_first, nth, left_bounds);
+	//
+	// Decide if the extents enclosed by this node should be partitioned by
+	// their time interval or their address range. Always select the widest
+	// of the two dimensions.
+	//
+	bool by_time = 
+	    dm_tree[node].dm_bounds.getTimeInterval().getWidth() >
+	    dm_tree[node].dm_bounds.getAddressRange().getWidth();
     
-    // Add the right child to the tree
-    Extent right_bounds;
-    for(std::vector<ExtentGroup::size_type>::size_type 
-	    i = nth + 1; i <= dm_tree[node].dm_last; ++i)
-	right_bounds |= (*this)[dm_map[i]]; 
-    dm_tree[dm_next++] = Node(0, nth + 1, dm_tree[node].dm_last, right_bounds);
+	//
+	// Partition the extents enclosed by this node in either the time
+	// interval or address range dimension. After partitioning, the first
+	// half of the extents will all lie on one side of a plane dividing the
+	// extents in the given dimension, and the second half will all lie on
+	// the other side. These two partitions then become the left and right
+	// child of this node.
+	//
+	
+	std::nth_element(map.begin() + first, map.begin() + nth,
+			 map.begin() + last + 1,
+			 CompareExtents(*this, by_time));
+
+	// Add the left and right child (and their subtrees) to the tree
+	buildNode(map, first, nth);
+	buildNode(map, nth + 1, last);
+
+    }
+
+    // Any further nodes aren't in this node's subtree
+    dm_tree[node].dm_next = dm_tree.size();
 }
@@ -32,6 +32,9 @@
 
 #include "Extent.hxx"
 
+#ifdef HAVE_INTTYPES_H
+#include <inttypes.h>
+#endif
 #include <set>
 #include <vector>
 
@@ -62,68 +65,98 @@ namespace OpenSpeedShop { namespace Framework {
 	
     public:
 
+	ExtentGroup();
+
 	Extent getBounds() const;
 	std::set<size_type> getIntersectionWith(const Extent&) const;
 	std::set<size_type> getIntersectionWith(const ExtentGroup&) const;
+	void getIntersectionWith(const Extent&, std::vector<size_type>&) const;
+
+	void buildTree() const;
+	uint64_t getIdentifier() const;
+
+	/**
+	 * Visit our intersection with an extent.
+	 *
+	 * Calls the specified visitor with the index of each extent in this
+	 * group that intersects the specified extent. The extents are visited
+	 * in no particular order. Unlike getIntersectionWith(), no memory is
+	 * allocated (once the Kd-tree has been built).
+	 *
+	 * @param extent     Extent with which to intersect.
+	 * @param visitor    Visitor called with the index of each intersecting
+	 *                   extent.
+	 */
+	template <typename F>
+	void visitIntersectionWith(const Extent& extent, F& visitor) const
+	{
+	    // Handle special case of an empty group
+	    if(empty())
+		return;
+
+	    // Build the tree (when necessary)
+	    buildTree();
+
+	    // Visit the nodes in order, skipping the subtrees of those nodes
+	    // that don't intersect the extent
+	    for(std::vector<Node>::size_type i = 0; i < dm_tree.size();) {
+		const Node& node = dm_tree[i];
+		if(!extent.doesIntersect(node.dm_bounds))
+		    i = node.dm_next;
+		else {
+		    if(node.dm_next == (i + 1))
+			visitor(node.dm_extent);
+		    ++i;
+		}
+	    }
+	}
 	
     private:
 
 	/**
 	 * Kd-tree node.
 	 *
-	 * Structure for a single node in the Kd-tree. Contains a pointer to
-	 * the node's children, a description of which extents are enclosed by
-	 * the node, and the bounds of those enclosed extents.
+	 * Structure for a single node in the Kd-tree. Contains the bounds of
+	 * the extents enclosed by the node and the index of the node following
+	 * this node's subtree. Leaf nodes, whose subtree consists of just that
+	 * node, also contain the index of their single enclosed extent.
 	 */
 	struct Node
 	{
-	    
-	    /** Index of our left child (right child is "dm_children + 1"). */
-	    std::vector<Node>::difference_type dm_children;
-	    
-	    /** Index of the first extent enclosed by this node. */
-	    std::vector<ExtentGroup::size_type>::size_type dm_first;
 
-	    /** Index of the last extent enclosed by this node. */
-	    std::vector<ExtentGroup::size_type>::size_type dm_last;
-	    
 	    /** Bounds of the extents enclosed by this node. */
 	    Extent dm_bounds;
+
+	    /** Index of the node following this node's subtree. */
+	    ExtentGroup::size_type dm_next;
+
+	    /** Index of the extent enclosed by this (leaf) node. */
+	    ExtentGroup::size_type dm_extent;
 	    
 	    /** Default constructor. */
 	    Node() :
-		dm_children(0),
-		dm_first(0),
-		dm_last(0),
-		dm_bounds()
-	    {
-	    }
-
-	    /** Constructor from fields. */
-	    Node(const std::vector<Node>::size_type& children,
-		 const std::vector<ExtentGroup::size_type>::size_type& first,
-		 const std::vector<ExtentGroup::size_type>::size_type& last,
-		 const Extent& bounds) :
-		dm_children(children),
-		dm_first(first),
-		dm_last(last),
-		dm_bounds(bounds)
+		dm_bounds(),
+		dm_next(0),
+		dm_extent(0)
 	    {
 	    }
 
 	};    
 
-	/** Index of next available node in the tree. */
-	mutable std::vector<Node>::size_type dm_next;
-	
-	/** Nodes of the tree. */
+	/**
+	 * Nodes of the tree.
+	 *
+	 * The tree is flattened into a single vector with the nodes stored in
+	 * depth-first order. Each node's subtree thus immediately follows that
+	 * node, allowing the tree to be searched without a traversal stack.
+	 */
 	mutable std::vector<Node> dm_tree;
+
+	/** Unique identifier of the tree. */
+	mutable uint64_t dm_identifier;
 	
-	/** Map used to partition extents without actually moving them. */
-	mutable std::vector<ExtentGroup::size_type> dm_map;
-	
-	void initializeTree() const;
-	void buildChildren(const size_type&) const;
+	void buildNode(std::vector<size_type>&,
+		       const size_type&, const size_type&) const;
 	
     };
     
@@ -25,6 +25,7 @@
  */
 
 #include "AddressBitmap.hxx"
+#include "AttributeCache.hxx"
 #include "Blob.hxx"
 #include "EntrySpy.hxx"
 #include "Exception.hxx"
@@ -235,6 +236,11 @@ ExtentGroup Function::getExtentIn(const Thread& thread) const
 LinkedObject Function::getLinkedObject() const
 {
     LinkedObject linked_object;
+
+    // Use the attribute cache when possible
+    int entry;
+    if(TheAttributeCache.getFunctionLinkedObject(dm_database, dm_entry, entry))
+	return LinkedObject(dm_database, entry);
     
     // Find our linked object
     BEGIN_TRANSACTION(dm_database);
@@ -279,6 +285,10 @@ std::string Function::getMangledName() const
 {
     std::string name;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getFunctionMangledName(dm_database, dm_entry, name))
+	return name;
+
     // Find our mangled name
     BEGIN_TRANSACTION(dm_database);
     validate();
@@ -307,6 +317,12 @@ std::string Function::getMangledName() const
  */
 std::string Function::getDemangledName(const bool& all) const
 {
+    // Use the attribute cache when possible
+    std::string name;
+    if(TheAttributeCache.getFunctionDemangledName(dm_database, dm_entry,
+						  all, name))
+	return name;
+
     // Get our mangled name
     std::string mangled = getMangledName();
 
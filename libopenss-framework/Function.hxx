@@ -73,6 +73,7 @@ namespace OpenSpeedShop { namespace Framework {
 	friend class LinkedObject;
 	friend class Loop;
 	friend class Statement;
+	friend class SymbolTable;
 	friend class Thread;
 	friend class ThreadGroup;
 	friend class VectorInstr;
@@ -71,6 +71,37 @@ FunctionCache::getFunctions(const LinkedObject& linked_object,
 
 
 
+/**
+ * Get functions containing an address.
+ *
+ * Returns the functions within the passed linked object containing the passed
+ * address. An empty set is returned if no functions are found.
+ *
+ * @param linked_object    Linked object in which to find functions.
+ * @param address          Address, relative to the linked object, to be found.
+ * @return                 Functions containing this address.
+ */
+std::set<Function>
+FunctionCache::getFunctionsAt(const LinkedObject& linked_object,
+			      const Address& address)
+{
+    Guard guard_myself(this);
+
+    // Find this linked object's pre-resolved addresses (adding if necessary)
+    if(!dm_index.hasResolvedGroup(linked_object))
+	addResolvedAddresses(linked_object);
+
+    // Find this linked object in the address index (adding it if necessary)
+    if(!dm_index.isResolvedAt(linked_object, address) &&
+       !dm_index.hasGroup(linked_object))
+	addLinkedObject(linked_object);
+
+    // Return the functions containing this address to the caller
+    return dm_index.getObjectsAt(linked_object, address);
+}
+
+
+
 /**
  * Remove a database.
  *
@@ -93,8 +124,31 @@ void FunctionCache::removeDatabase(const SmartPtr<Database>& database)
 
     // Remove these linked objects from the cache
     for(std::set<LinkedObject>::const_iterator
-	    i = linked_objects.begin(); i != linked_objects.end(); ++i)
+	    i = linked_objects.begin(); i != linked_objects.end(); ++i) {
 	dm_cache.removeExtents(*i);
+	dm_index.removeGroup(*i);
+	dm_index.removeResolvedGroup(*i);
+    }
+}
+
+
+
+/**
+ * Remove a linked object.
+ *
+ * Removes the passed linked object from the cache. Must be called whenever new
+ * address ranges are stored for the linked object, so that they are found by
+ * future queries.
+ *
+ * @param linked_object    Linked object to be removed from the cache.
+ */
+void FunctionCache::removeLinkedObject(const LinkedObject& linked_object)
+{
+    Guard guard_myself(this);
+
+    dm_cache.removeExtents(linked_object);
+    dm_index.removeGroup(linked_object);
+    dm_index.removeResolvedGroup(linked_object);
 }
 
 
@@ -112,6 +166,11 @@ void FunctionCache::addLinkedObject(const LinkedObject& linked_object)
 {
     SmartPtr<Database> database = EntrySpy(linked_object).getDatabase();
 
+    // Discard any previously indexed addresses for this linked object. Its
+    // group is only re-created, by addRange(), if it has any address ranges,
+    // so that a linked object without any is queried again next time.
+    dm_index.removeGroup(linked_object);
+
     // Find the extents of all functions within the specified linked object
     BEGIN_TRANSACTION(database);
     EntrySpy(linked_object).validate();
@@ -130,19 +189,69 @@ void FunctionCache::addLinkedObject(const LinkedObject& linked_object)
 
         AddressBitmap bitmap(AddressRange(database->getResultAsAddress(2),
                                           database->getResultAsAddress(3)),
-                             database->getResultAsBlob(4));
+                             database->getResultAsBlob(4, Blob::Borrow));
 
         std::set<AddressRange> ranges = bitmap.getContiguousRanges(true);
 
         for(std::set<AddressRange>::const_iterator
-                i = ranges.begin(); i != ranges.end(); ++i)
-
+                i = ranges.begin(); i != ranges.end(); ++i) {
             dm_cache.addExtent(
                 linked_object,
                 Function(database, database->getResultAsInteger(1)),
                 Extent(TimeInterval(Time::TheBeginning(), Time::TheEnd()), *i)
                 );
+            dm_index.addRange(
+                linked_object,
+                Function(database, database->getResultAsInteger(1)),
+                *i
+                );
+        }
+
+    }
+    END_TRANSACTION(database);
+}
+
+
+
+/**
+ * Add a linked object's pre-resolved addresses.
+ *
+ * Adds the addresses within the passed linked object that were resolved to
+ * functions when the experiment database was finalized. Queries for these
+ * addresses are then answered without adding the linked object's entire set
+ * of functions to the cache. No addresses are added if the database predates
+ * the address resolutions table.
+ *
+ * @param linked_object    Linked object whose addresses are to be added.
+ */
+void FunctionCache::addResolvedAddresses(const LinkedObject& linked_object)
+{
+    SmartPtr<Database> database = EntrySpy(linked_object).getDatabase();
+
+    // Note that this linked object's addresses have been added
+    dm_index.addResolvedGroup(linked_object);
 
+    // Find the pre-resolved addresses within the specified linked object
+    BEGIN_TRANSACTION(database);
+    if(database->hasTable("AddressResolutions")) {
+	database->prepareStatement(
+	    "SELECT addr, "
+	    "       function "
+	    "FROM AddressResolutions "
+	    "WHERE linked_object = ?;"
+	    );
+	database->bindArgument(1, EntrySpy(linked_object).getEntry());
+	while(database->executeStatement()) {
+	    if(database->getResultAsInteger(2) > 0)
+		dm_index.addResolvedObject(
+		    linked_object, database->getResultAsAddress(1),
+		    Function(database, database->getResultAsInteger(2))
+		    );
+	    else
+		dm_index.addResolvedAddress(
+		    linked_object, database->getResultAsAddress(1)
+		    );
+	}
     }
     END_TRANSACTION(database);
 }
@@ -29,6 +29,7 @@
 #include "config.h"
 #endif
 
+#include "AddressTable.hxx"
 #include "ExtentTable.hxx"
 #include "LinkedObject.hxx"
 #include "Lockable.hxx"
@@ -62,15 +63,21 @@ namespace OpenSpeedShop { namespace Framework {
 
 	std::set<Function> getFunctions(const LinkedObject&,
 					const ExtentGroup&);
+	std::set<Function> getFunctionsAt(const LinkedObject&, const Address&);
 
 	void removeDatabase(const SmartPtr<Database>&);
+	void removeLinkedObject(const LinkedObject&);
 
     private:
 
 	/** Extent table containing function cache. */
 	ExtentTable<LinkedObject, Function> dm_cache;
 
+	/** Address table containing function address index. */
+	AddressTable<LinkedObject, Function> dm_index;
+
 	void addLinkedObject(const LinkedObject&);
+	void addResolvedAddresses(const LinkedObject&);
 
     };
 	
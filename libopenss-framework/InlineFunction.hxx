@@ -66,6 +66,7 @@ namespace OpenSpeedShop { namespace Framework {
 	friend class Function;
 	friend class LinkedObject;
 	friend class InlineFunctionCache;
+	friend class SymbolTable;
 	friend class Thread;
 	friend class ThreadGroup;
 	
@@ -30,6 +30,7 @@
 #include "config.h"
 #endif
 
+#include "AddressTable.hxx"
 #include "ExtentTable.hxx"
 #include "LinkedObject.hxx"
 #include "Lockable.hxx"
@@ -63,15 +64,22 @@ namespace OpenSpeedShop { namespace Framework {
 
 	std::set<InlineFunction> getInlineFunctions(const LinkedObject&,
 					  const ExtentGroup&);
+	std::set<InlineFunction> getInlineFunctionsAt(const LinkedObject&,
+						      const Address&);
 
 	void removeDatabase(const SmartPtr<Database>&);
+	void removeLinkedObject(const LinkedObject&);
 
     private:
 
 	/** Extent table containing source code statement cache. */
 	ExtentTable<LinkedObject, InlineFunction> dm_cache;
 
+	/** Address table containing inlined function address index. */
+	AddressTable<LinkedObject, InlineFunction> dm_index;
+
 	void addLinkedObject(const LinkedObject&);
+	void addResolvedAddresses(const LinkedObject&);
 
     };
 	
@@ -24,6 +24,7 @@
  */
 
 #include "Assert.hxx"
+#include "AttributeCache.hxx"
 #include "EntrySpy.hxx"
 #include "Exception.hxx"
 #include "ExtentGroup.hxx"
@@ -133,6 +134,10 @@ Path LinkedObject::getPath() const
 {
     Path path;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getLinkedObjectPath(dm_database, dm_entry, path))
+	return path;
+
     // Find our full path name
     BEGIN_TRANSACTION(dm_database);
     validate();
@@ -176,6 +181,11 @@ bool LinkedObject::isExecutable() const
 {
     bool is_executable;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getLinkedObjectIsExecutable(dm_database, dm_entry,
+						     is_executable))
+	return is_executable;
+
     // Find if we are an executable
     BEGIN_TRANSACTION(dm_database);
     validate();
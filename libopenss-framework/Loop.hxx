@@ -66,6 +66,7 @@ namespace OpenSpeedShop { namespace Framework {
 	friend class LoopCache;
 	friend class LinkedObject;
 	friend class Statement;
+	friend class SymbolTable;
 	friend class Thread;
 	friend class ThreadGroup;
 	friend class VectorInstr;
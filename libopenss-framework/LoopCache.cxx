@@ -70,6 +70,32 @@ std::set<Loop> LoopCache::getLoops(const LinkedObject& linked_object,
 
 
 
+/**
+ * Get loops containing an address.
+ *
+ * Returns the loops within the passed linked object containing the passed
+ * address. An empty set is returned if no loops are found.
+ *
+ * @param linked_object    Linked object in which to find loops.
+ * @param address          Address, relative to the linked object, to be found.
+ * @return                 Loops containing this address.
+ */
+std::set<Loop>
+LoopCache::getLoopsAt(const LinkedObject& linked_object,
+                      const Address& address)
+{
+    Guard guard_myself(this);
+
+    // Find this linked object in the address index (adding it if necessary)
+    if(!dm_index.hasGroup(linked_object))
+        addLinkedObject(linked_object);
+
+    // Return the loops containing this address to the caller
+    return dm_index.getObjectsAt(linked_object, address);
+}
+
+
+
 /**
  * Remove a database.
  *
@@ -92,8 +118,29 @@ void LoopCache::removeDatabase(const SmartPtr<Database>& database)
     
     // Remove these linked objects from the cache
     for(std::set<LinkedObject>::const_iterator
-            i = linked_objects.begin(); i != linked_objects.end(); ++i)
+            i = linked_objects.begin(); i != linked_objects.end(); ++i) {
         dm_cache.removeExtents(*i);
+        dm_index.removeGroup(*i);
+    }
+}
+
+
+
+/**
+ * Remove a linked object.
+ *
+ * Removes the passed linked object from the cache. Must be called whenever new
+ * address ranges are stored for the linked object, so that they are found by
+ * future queries.
+ *
+ * @param linked_object    Linked object to be removed from the cache.
+ */
+void LoopCache::removeLinkedObject(const LinkedObject& linked_object)
+{
+    Guard guard_myself(this);
+
+    dm_cache.removeExtents(linked_object);
+    dm_index.removeGroup(linked_object);
 }
 
 
@@ -111,6 +158,11 @@ void LoopCache::addLinkedObject(const LinkedObject& linked_object)
 {
     SmartPtr<Database> database = EntrySpy(linked_object).getDatabase();
 
+    // Discard any previously indexed addresses for this linked object. Its
+    // group is only re-created, by addRange(), if it has any address ranges,
+    // so that a linked object without any is queried again next time.
+    dm_index.removeGroup(linked_object);
+
     // Find the extents of all loops within the specified linked object
     BEGIN_TRANSACTION(database);
     EntrySpy(linked_object).validate();
@@ -129,19 +181,24 @@ void LoopCache::addLinkedObject(const LinkedObject& linked_object)
         
         AddressBitmap bitmap(AddressRange(database->getResultAsAddress(2),
                                           database->getResultAsAddress(3)),
-                             database->getResultAsBlob(4));
+                             database->getResultAsBlob(4, Blob::Borrow));
         
         std::set<AddressRange> ranges = bitmap.getContiguousRanges(true);
         
         for(std::set<AddressRange>::const_iterator
-                i = ranges.begin(); i != ranges.end(); ++i)
-            
+                i = ranges.begin(); i != ranges.end(); ++i) {
             dm_cache.addExtent(
                 linked_object,
                 Loop(database, database->getResultAsInteger(1)),
                 Extent(TimeInterval(Time::TheBeginning(), Time::TheEnd()), *i)
                 );
-        
+            dm_index.addRange(
+                linked_object,
+                Loop(database, database->getResultAsInteger(1)),
+                *i
+                );
+        }
+
     }
     END_TRANSACTION(database);
 }
@@ -29,6 +29,7 @@
 #include "config.h"
 #endif
 
+#include "AddressTable.hxx"
 #include "ExtentTable.hxx"
 #include "LinkedObject.hxx"
 #include "Lockable.hxx"
@@ -61,13 +62,18 @@ namespace OpenSpeedShop { namespace Framework {
     public:
         
         std::set<Loop> getLoops(const LinkedObject&, const ExtentGroup&);
+        std::set<Loop> getLoopsAt(const LinkedObject&, const Address&);
 
         void removeDatabase(const SmartPtr<Database>&);
+        void removeLinkedObject(const LinkedObject&);
 
     private:
 
         /** Extent table containing source code loop cache. */
         ExtentTable<LinkedObject, Loop> dm_cache;
+
+        /** Address table containing loop address index. */
+        AddressTable<LinkedObject, Loop> dm_index;
         
         void addLinkedObject(const LinkedObject&);
         
@@ -31,6 +31,7 @@
 #include "OfflineExperiment.hxx"
 #include "SymbolTable.hxx"
 #include "Instrumentor.hxx"
+#include "NonCopyable.hxx"
 #include "Blob.hxx"
 #include "ThreadName.hxx"
 
@@ -44,6 +45,7 @@
 #endif
 
 #include <algorithm>
+#include <deque>
 
 #include <sys/stat.h>
 #include <iostream>
@@ -52,6 +54,9 @@
 #include <fcntl.h>
 #include <dirent.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "OpenSS_DataHeader.h"
 #include "offline.h"
 
@@ -109,6 +114,357 @@ bool OfflineExperiment::is_debug_offline_enabled =
     (getenv("OPENSS_DEBUG_OFFLINE") != NULL);
 #endif
 
+namespace {
+
+    /**
+     * Raw data file mapped into memory.
+     *
+     * Maps the entire contents of a raw data file read-only into memory for
+     * the lifetime of this object. The contents are then decoded directly from
+     * the mapping, avoiding the buffered reads and intermediate copies of the
+     * stdio based decoding.
+     */
+    class RawFile
+    {
+
+    public:
+
+	/** Constructor from a raw data file name. */
+	RawFile(const std::string& name) :
+	    dm_size(0),
+	    dm_contents(MAP_FAILED)
+	{
+	    int fd = open(name.c_str(), O_RDONLY);
+	    if(fd == -1)
+		return;
+	    struct stat info;
+	    if((fstat(fd, &info) == 0) && (info.st_size > 0)) {
+		dm_contents = mmap(NULL, info.st_size, PROT_READ,
+				   MAP_PRIVATE, fd, 0);
+		if(dm_contents != MAP_FAILED) {
+		    dm_size = info.st_size;
+		    madvise(dm_contents, dm_size, MADV_SEQUENTIAL);
+		}
+	    }
+	    close(fd);
+	}
+
+	/** Destructor. */
+	~RawFile()
+	{
+	    if(dm_contents != MAP_FAILED)
+		munmap(dm_contents, dm_size);
+	}
+
+	/** Test if the file was mapped successfully. */
+	bool isMapped() const
+	{
+	    return dm_contents != MAP_FAILED;
+	}
+
+	/** Read-only data member accessor function. */
+	const size_t& getSize() const
+	{
+	    return dm_size;
+	}
+
+	/** Read-only data member accessor function. */
+	const char* getContents() const
+	{
+	    return reinterpret_cast<const char*>(dm_contents);
+	}
+
+    private:
+
+	/** Size of the mapping (in bytes). */
+	size_t dm_size;
+
+	/** Address of the mapping. */
+	void* dm_contents;
+
+    };
+
+    /**
+     * Raw data files processed by a pool of worker threads.
+     *
+     * Each worker repeatedly claims the next unprocessed file from the list
+     * and either processes it as performance data (when an experiment is
+     * given) or reads its contents into memory for later decoding by the
+     * calling thread (when it isn't).
+     */
+    struct RawFileQueue
+    {
+	/** Mutual exclusion lock for the next file index. */
+	pthread_mutex_t dm_lock;
+
+	/** Experiment receiving the performance data (or null). */
+	OfflineExperiment* dm_experiment;
+
+	/** Names of the raw data files. */
+	std::vector<std::string> dm_files;
+
+	/** Contents of each raw data file (when not processing). */
+	std::vector<Blob> dm_contents;
+
+	/** Result of processing each raw data file. */
+	std::vector<char> dm_results;
+
+	/** Index of the next unclaimed raw data file. */
+	std::vector<std::string>::size_type dm_next;
+
+	/** Constructor from an experiment and raw data file names. */
+	RawFileQueue(OfflineExperiment* experiment,
+		     const std::vector<std::string>& files) :
+	    dm_experiment(experiment),
+	    dm_files(files),
+	    dm_contents(experiment == NULL ? files.size() : 0),
+	    dm_results(files.size(), false),
+	    dm_next(0)
+	{
+	    Assert(pthread_mutex_init(&dm_lock, NULL) == 0);
+	}
+
+	/** Destructor. */
+	~RawFileQueue()
+	{
+	    Assert(pthread_mutex_destroy(&dm_lock) == 0);
+	}
+    };
+
+    /** Read the contents of a raw data file into a blob. */
+    bool readRawFile(const std::string& name, Blob& contents)
+    {
+	RawFile file(name);
+	if(!file.isMapped())
+	    return false;
+	Blob blob(file.getSize(), file.getContents());
+	contents.swap(blob);
+	return true;
+    }
+
+    /** Worker thread processing raw data files from a queue. */
+    void* processRawFiles(void* arg)
+    {
+	RawFileQueue* queue = reinterpret_cast<RawFileQueue*>(arg);
+
+	while(true) {
+
+	    // Claim the next unprocessed raw data file
+	    Assert(pthread_mutex_lock(&queue->dm_lock) == 0);
+	    std::vector<std::string>::size_type i = queue->dm_next;
+	    if(i < queue->dm_files.size())
+		queue->dm_next++;
+	    Assert(pthread_mutex_unlock(&queue->dm_lock) == 0);
+	    if(i >= queue->dm_files.size())
+		break;
+
+	    if(queue->dm_experiment != NULL)
+		queue->dm_results[i] =
+		    queue->dm_experiment->process_data(queue->dm_files[i]);
+	    else
+		queue->dm_results[i] =
+		    readRawFile(queue->dm_files[i], queue->dm_contents[i]);
+
+	}
+
+	return NULL;
+    }
+
+    /**
+     * Run a raw data file queue.
+     *
+     * Processes all the files in the specified queue using a pool of worker
+     * threads, returning only after every file has been processed. The size of
+     * the pool defaults to the number of online processors, and can be changed
+     * by setting OPENSS_OFFLINE_THREADS. A pool size of one processes the files
+     * within the calling thread.
+     *
+     * @param queue    Raw data file queue to be run.
+     */
+    void runRawFileQueue(RawFileQueue& queue)
+    {
+	long threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if(getenv("OPENSS_OFFLINE_THREADS") != NULL)
+	    threads = atol(getenv("OPENSS_OFFLINE_THREADS"));
+	if(threads > static_cast<long>(queue.dm_files.size()))
+	    threads = queue.dm_files.size();
+
+	if(threads <= 1) {
+	    processRawFiles(&queue);
+	    return;
+	}
+
+	std::vector<pthread_t> workers(threads);
+	for(long i = 0; i < threads; ++i)
+	    Assert(pthread_create(&workers[i], NULL,
+				  processRawFiles, &queue) == 0);
+	for(long i = 0; i < threads; ++i)
+	    Assert(pthread_join(workers[i], NULL) == 0);
+    }
+
+    /** Find the raw data files with the given suffix. */
+    std::vector<std::string> findRawFiles(const std::vector<std::string>& files,
+					  const std::string& suffix)
+    {
+	std::vector<std::string> found;
+	for(std::vector<std::string>::const_iterator
+		i = files.begin(); i != files.end(); ++i)
+	    if(i->find(suffix) != std::string::npos)
+		found.push_back(*i);
+	return found;
+    }
+
+#if !defined(OPENSS_USE_SYMTABAPI)
+    /**
+     * Linked objects whose symbols are resolved by a pool of worker threads.
+     *
+     * Each worker repeatedly claims the next unresolved linked object from the
+     * list and resolves its symbols using that linked object's own BFDSymbols
+     * object. The symbol table map is only read by the workers. The resolved
+     * symbols are stored into it afterwards by the calling thread.
+     */
+    struct SymbolQueue
+    {
+	/** Mutual exclusion lock for the next linked object index. */
+	pthread_mutex_t dm_lock;
+
+	/** Sampled addresses to be resolved. */
+	const std::set<Address>& dm_addresses;
+
+	/** Symbol table map that will receive the symbols. */
+	const SymbolTableMap& dm_symtabmap;
+
+	/** Linked objects whose symbols are to be resolved. */
+	std::vector<LinkedObject> dm_linked_objects;
+
+	/** Symbols resolved for each linked object. */
+	std::vector<BFDSymbols> dm_symbols;
+
+	/** Index of the next unclaimed linked object. */
+	std::vector<LinkedObject>::size_type dm_next;
+
+	/** Constructor from addresses, a symbol table map, and linked objects. */
+	SymbolQueue(const std::set<Address>& addresses,
+		    const SymbolTableMap& symtabmap,
+		    const std::set<LinkedObject>& linked_objects) :
+	    dm_addresses(addresses),
+	    dm_symtabmap(symtabmap),
+	    dm_linked_objects(linked_objects.begin(), linked_objects.end()),
+	    dm_symbols(linked_objects.size()),
+	    dm_next(0)
+	{
+	    Assert(pthread_mutex_init(&dm_lock, NULL) == 0);
+	}
+
+	/** Destructor. */
+	~SymbolQueue()
+	{
+	    Assert(pthread_mutex_destroy(&dm_lock) == 0);
+	}
+    };
+
+    /** Worker thread resolving symbols of linked objects from a queue. */
+    void* resolveSymbols(void* arg)
+    {
+	SymbolQueue* queue = reinterpret_cast<SymbolQueue*>(arg);
+
+	while(true) {
+
+	    // Claim the next unresolved linked object
+	    Assert(pthread_mutex_lock(&queue->dm_lock) == 0);
+	    std::vector<LinkedObject>::size_type i = queue->dm_next;
+	    if(i < queue->dm_linked_objects.size())
+		queue->dm_next++;
+	    Assert(pthread_mutex_unlock(&queue->dm_lock) == 0);
+	    if(i >= queue->dm_linked_objects.size())
+		break;
+
+	    queue->dm_symbols[i].resolveSymbols(queue->dm_addresses,
+						queue->dm_linked_objects[i],
+						queue->dm_symtabmap);
+
+	}
+
+	return NULL;
+    }
+
+    /**
+     * Run a symbol queue.
+     *
+     * Resolves the symbols of all the linked objects in the specified queue
+     * using a pool of worker threads, returning only after every linked object
+     * has been resolved. The size of the pool defaults to the number of online
+     * processors, and can be changed by setting OPENSS_SYMBOL_THREADS. Symbols
+     * are always resolved within the calling thread when the BFD library isn't
+     * thread-safe.
+     *
+     * @param queue    Symbol queue to be run.
+     */
+    void runSymbolQueue(SymbolQueue& queue)
+    {
+	long threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if(getenv("OPENSS_SYMBOL_THREADS") != NULL)
+	    threads = atol(getenv("OPENSS_SYMBOL_THREADS"));
+	if(threads > static_cast<long>(queue.dm_linked_objects.size()))
+	    threads = queue.dm_linked_objects.size();
+
+	if((threads <= 1) || !BFDSymbols::isThreadSafe()) {
+	    resolveSymbols(&queue);
+	    return;
+	}
+
+	std::vector<pthread_t> workers(threads);
+	for(long i = 0; i < threads; ++i)
+	    Assert(pthread_create(&workers[i], NULL,
+				  resolveSymbols, &queue) == 0);
+	for(long i = 0; i < threads; ++i)
+	    Assert(pthread_join(workers[i], NULL) == 0);
+    }
+#endif
+
+    /**
+     * Number of performance data blobs collected before being enqueued. Bounds
+     * the number of blobs held privately by each worker, while still enqueuing
+     * them with few acquisitions of the data queues' lock.
+     */
+    const std::deque<Blob>::size_type BlobsPerEnqueue = 256;
+
+    /**
+     * Bulk load of an experiment database.
+     *
+     * Begins a bulk load of the experiment's database when created, and ends
+     * it when destroyed. Creating one on the stack restores the database's
+     * journal and synchronous settings however the enclosing scope is exited,
+     * including by an exception.
+     */
+    class BulkLoad :
+	public NonCopyable
+    {
+
+    public:
+
+	/** Constructor from an experiment. */
+	explicit BulkLoad(const Experiment& experiment) :
+	    dm_experiment(experiment)
+	{
+	    dm_experiment.beginBulkLoad();
+	}
+
+	/** Destructor. */
+	~BulkLoad()
+	{
+	    dm_experiment.endBulkLoad();
+	}
+
+    private:
+
+	/** Experiment being bulk loaded. */
+	const Experiment& dm_experiment;
+
+    };
+
+}
+
 /**
  * Utility: setparam()
  * 
@@ -452,8 +808,12 @@ OfflineExperiment::getRawDataFiles (std::string dir)
 	}
 #endif // !BUILD_CBTF
 
-        convertToOpenSSDB();
-        createOfflineSymbolTable();
+	// Defer journal and disk syncs until the conversion is complete
+	{
+	    BulkLoad bulk_load(*theExperiment);
+	    convertToOpenSSDB();
+	    createOfflineSymbolTable();
+	}
 	finalizeDB();
 	rawfiles.clear();
 	threads_processed.clear();
@@ -568,25 +928,23 @@ int OfflineExperiment::convertToOpenSSDB()
     std::cout << "Processing processes and threads ..." << std::endl;
 #if !defined(BUILD_CBTF)
 	    // cbtf offline collections does not drop openss-info files
-    for (unsigned int i = 0;i < rawfiles.size();++i) {
-	bool_t found_infofile = false;
-	if (rawfiles[i].find(".openss-info") != std::string::npos) {
-	    rawname = rawfiles[i];
-	    found_infofile = true;
-	} 
-
-        if (found_infofile) {
-            bool_t rval;
-	    rval = process_expinfo(rawname);
+    // The info files are read concurrently, but decoded and added to
+    // the database serially and in their original order.
+    RawFileQueue infofiles(NULL, findRawFiles(rawfiles, ".openss-info"));
+    runRawFileQueue(infofiles);
+    for (unsigned int i = 0;i < infofiles.dm_files.size();++i) {
+	rawname = infofiles.dm_files[i];
+
+	bool_t rval = infofiles.dm_results[i] &&
+		      process_expinfo(rawname, infofiles.dm_contents[i]);
 	    
-            if (!rval) {
-    	        std::cerr << "Could not process experiment info for: "
-		    << rawname << std::endl;
-            }
-
-            // add this pid and host to database.
-            theExperiment->updateThreads(expPid,expPosixTid,expRank,expHost);
+	if (!rval) {
+	    std::cerr << "Could not process experiment info for: "
+		<< rawname << std::endl;
 	}
+
+	// add this pid and host to database.
+	theExperiment->updateThreads(expPid,expPosixTid,expRank,expHost);
     }
 
     // Set LD_LIBRARY_PATH and plugin path so we can find the
@@ -707,6 +1065,9 @@ int OfflineExperiment::convertToOpenSSDB()
     // where performance data was collected.
 
     std::cout << "Processing performance data ..." << std::endl;
+#if defined(BUILD_CBTF)
+    // The cbtf data files also update the threads and the linked object
+    // blobs as they are processed, so they must be processed serially.
     for (unsigned int i = 0;i < rawfiles.size();i++) {
 	bool_t found_datafile = false;
 	if (rawfiles[i].find(".openss-data") != std::string::npos) {
@@ -716,7 +1077,6 @@ int OfflineExperiment::convertToOpenSSDB()
 
         if (found_datafile) {
           bool_t rval = process_data(rawname);
-#if defined(BUILD_CBTF)
             if (!rval && rawfiles[i].find(".openss-dsos") != std::string::npos) {
 // DEBUG
 #ifndef NDEBUG
@@ -726,21 +1086,26 @@ int OfflineExperiment::convertToOpenSSDB()
 		}
 #endif
 	    }
+        }
+    }
 #else // BUILD_CBTF (handle old offline mode here)
-            if (!rval &&
-		(rawfiles[i].find(".openss-info") != std::string::npos ||
-		 rawfiles[i].find(".openss-dsos") != std::string::npos)) {
+    // The data files of the OSS collector runtimes only enqueue their
+    // blobs, so they are processed concurrently. The blobs are written
+    // to the database by the single flush below.
+    RawFileQueue datafiles(this, findRawFiles(rawfiles, ".openss-data"));
+    runRawFileQueue(datafiles);
 // DEBUG
 #ifndef NDEBUG
-		if(is_debug_offline_enabled) {
-	            std::cerr << "Could not process experiment data for: "
-		        << rawname << std::endl;
-		}
-#endif
+    if(is_debug_offline_enabled) {
+	for (unsigned int i = 0;i < datafiles.dm_files.size();i++) {
+	    if (!datafiles.dm_results[i]) {
+		std::cerr << "Could not process experiment data for: "
+		    << datafiles.dm_files[i] << std::endl;
 	    }
-#endif // BUILD_CBTF
-        }
+	}
     }
+#endif
+#endif // BUILD_CBTF
 
 #if defined(BUILD_CBTF)
     DataQueues::flushPerformanceData();
@@ -755,22 +1120,19 @@ int OfflineExperiment::convertToOpenSSDB()
     // Process the list of dsos and address ranges for this experiment.
     std::cout << "Processing symbols ..." << std::endl;
 #if !defined(BUILD_CBTF)
-    for (unsigned int i = 0;i < rawfiles.size();i++) {
-	bool found_dsofile = false;
-	if (rawfiles[i].find(".openss-dsos") != std::string::npos)
-	{
-	    //std::cout << "processing " << rawfiles[i] << std::endl;
-	    rawname = rawfiles[i];
-	    found_dsofile = true;
-	} 
-
-        if (found_dsofile) {
-            bool rval = process_objects(rawname);
-            if (!rval) {
-	        std::cerr << "Could not process experiment dsos for: "
-	    	    << rawname << std::endl;
-            }
-        }
+    // As with the info files, the dsos files are read concurrently but
+    // decoded serially so that dsoVec retains its original order.
+    RawFileQueue dsofiles(NULL, findRawFiles(rawfiles, ".openss-dsos"));
+    runRawFileQueue(dsofiles);
+    for (unsigned int i = 0;i < dsofiles.dm_files.size();i++) {
+	rawname = dsofiles.dm_files[i];
+
+	bool rval = dsofiles.dm_results[i] &&
+		    process_objects(dsofiles.dm_contents[i]);
+	if (!rval) {
+	    std::cerr << "Could not process experiment dsos for: "
+		<< rawname << std::endl;
+	}
     }
 #else
     // Earlier we created a vector of datablobs that we now
@@ -793,14 +1155,28 @@ int OfflineExperiment::convertToOpenSSDB()
 
 bool
 OfflineExperiment::process_expinfo(const std::string rawfilename)
+{
+    Blob contents;
+    if (!readRawFile(rawfilename, contents)) {
+	std::cerr << "Could not read raw file " << rawfilename << std::endl;
+	return false;
+    }
+    return process_expinfo(rawfilename, contents);
+}
+
+// Decodes an experiment info file whose contents were already read
+// into memory.
+bool
+OfflineExperiment::process_expinfo(const std::string rawfilename,
+				   const Blob& contents)
 {
     XDR xdrs;
     std::string host = "";
-    long where = 0;
-
-    FILE *f = fopen(rawfilename.c_str(),"r");
 
-    xdrstdio_create(&xdrs, f, XDR_DECODE);
+    xdrmem_create(&xdrs,
+		  const_cast<char*>(
+		      reinterpret_cast<const char*>(contents.getContents())),
+		  contents.getSize(), XDR_DECODE);
 
     unsigned int blobsize;
     if (!xdr_u_int(&xdrs, &blobsize)) {
@@ -818,7 +1194,6 @@ OfflineExperiment::process_expinfo(const std::string rawfilename)
     if(!infoheadercall) {
 	std::cerr << "Could Not find a valid data header in raw file "
 		<< rawfilename << std::endl;
-	fclose(f);
 	return false;
     }
 
@@ -862,7 +1237,6 @@ OfflineExperiment::process_expinfo(const std::string rawfilename)
 	}
 #endif
 
-	where = ftell(f);
     	xdr_free(reinterpret_cast<xdrproc_t>(xdr_openss_expinfo),
 		      reinterpret_cast<char*>(&info));
     } else {
@@ -870,7 +1244,6 @@ OfflineExperiment::process_expinfo(const std::string rawfilename)
 	return false;
     }
 
-    fclose(f);
     return true;
 }
 
@@ -886,20 +1259,35 @@ OfflineExperiment::process_expinfo(const std::string rawfilename)
 bool
 OfflineExperiment::process_data(const std::string rawfilename)
 {
-    XDR xdrs;
-    std::string host = "";
+    // The file is mapped into memory and its blobs are copied directly
+    // from the mapping. Each entry is an XDR encoded (big-endian) blob
+    // size followed by the blob itself.
+    RawFile f(rawfilename);
+    if (!f.isMapped()) {
+	return false;
+    }
+
+    const unsigned char* next =
+	reinterpret_cast<const unsigned char*>(f.getContents());
+    const unsigned char* end = next + f.getSize();
 
-    FILE *f = fopen(rawfilename.c_str(),"r");
-    xdrstdio_create(&xdrs, f, XDR_DECODE);
+#if !defined(BUILD_CBTF)
+    // Blobs decoded from this file that are not yet enqueued.
+    std::deque<Blob> datablobs;
+#endif
 
     bool_t done = false;
 
     while (1) {
-	unsigned int blobsize;
-	if (!xdr_u_int(&xdrs, &blobsize)) {
+	if ((end - next) < 4) {
 	    //  no more entries. done.
 	    break;
 	}
+	unsigned int blobsize = (static_cast<unsigned int>(next[0]) << 24) |
+				(static_cast<unsigned int>(next[1]) << 16) |
+				(static_cast<unsigned int>(next[2]) << 8) |
+				static_cast<unsigned int>(next[3]);
+	next += 4;
 
 	// NOTE: At large scales (1024 pe) usertime data blobs can
 	// be written to the database of size 0 or 1. These are not
@@ -914,24 +1302,17 @@ OfflineExperiment::process_data(const std::string rawfilename)
 	    continue;
 	}
 
-	char* theData = (char*) malloc(blobsize+4);
-
-	if (theData == 0) {
-	    std::cerr << "Could Not allocate memory for data!" << std::endl;
-	    fclose(f);
-	    abort ();
-	}
-
-	memset(theData, 0, blobsize);
-	int bytesRead = fread(theData, 1, blobsize, f);
-	if (bytesRead == 0 || bytesRead != blobsize) {
+	size_t bytesRead = std::min(static_cast<size_t>(end - next),
+				    static_cast<size_t>(blobsize));
+	if (bytesRead != blobsize) {
 	    // FIXME: On some nodes of hyperion there are
 	    // bad writes to the offline-data files.
 	    std::cerr << "[ossutil] Warning: Bad read of data blob from " << rawfilename
 		<< " expected: " << blobsize << " got:" << bytesRead << std::endl;
-	    if (theData) free(theData);
-	    continue;
+	    break;
 	}
+	const unsigned char* theData = next;
+	next += blobsize;
 
 	// For offline collection we only maintain one dataqueue.
 	// So the collector runtimes need to set the header.experiment to 0.
@@ -1003,14 +1384,19 @@ OfflineExperiment::process_data(const std::string rawfilename)
 		<< " from " << rawfilename << std::endl;
 	}
 #endif
-	DataQueues::enqueuePerformanceData(datablob);
+	datablobs.push_back(Blob());
+	datablobs.back().swap(datablob);
+	if (datablobs.size() >= BlobsPerEnqueue) {
+	    DataQueues::enqueuePerformanceData(datablobs);
+	}
 #endif
-	if (theData) free(theData);
 	done = true;
 
     } // while
 
-    fclose(f);
+#if !defined(BUILD_CBTF)
+    DataQueues::enqueuePerformanceData(datablobs);
+#endif
     // experimental code to remove raw openss-data file
     // once it is copied to the openss database.
     //std::remove(rawfilename.c_str());
@@ -1020,6 +1406,17 @@ OfflineExperiment::process_data(const std::string rawfilename)
 // The processing of objects for the OSS offline files generated
 // by the OSS collector runtimes.
 bool OfflineExperiment::process_objects(const std::string rawfilename)
+{
+    Blob contents;
+    if (!readRawFile(rawfilename, contents)) {
+	std::cerr << "Could not read raw file " << rawfilename << std::endl;
+	return false;
+    }
+    return process_objects(contents);
+}
+
+// Decodes a dsos file whose contents were already read into memory.
+bool OfflineExperiment::process_objects(const Blob& contents)
 {
 
     if (unique_addresses.size() == 0) {
@@ -1030,8 +1427,10 @@ bool OfflineExperiment::process_objects(const std::string rawfilename)
     XDR xdrs;
     std::string host = "";
 
-    FILE *f = fopen(rawfilename.c_str(),"r");
-    xdrstdio_create(&xdrs, f, XDR_DECODE);
+    xdrmem_create(&xdrs,
+		  const_cast<char*>(
+		      reinterpret_cast<const char*>(contents.getContents())),
+		  contents.getSize(), XDR_DECODE);
 
     bool_t done = false;
     while (!done) {
@@ -1149,7 +1548,6 @@ bool OfflineExperiment::process_objects(const std::string rawfilename)
 	}
     } // end while
 
-    fclose(f);
     return true;
 }
 
@@ -1337,8 +1735,6 @@ void OfflineExperiment::createOfflineSymbolTable()
 
 #if defined(OPENSS_USE_SYMTABAPI)
     SymtabAPISymbols stapi_symbols;
-#else
-    BFDSymbols bfd_symbols;
 #endif
 
     std::map<AddressRange, std::set<LinkedObject> > tneeded;
@@ -1474,12 +1870,12 @@ void OfflineExperiment::createOfflineSymbolTable()
     // BFD_SYMBOLS
 #endif
 
+#if defined(OPENSS_USE_SYMTABAPI)
     for(std::set<LinkedObject>::const_iterator j = ttgrp_lo.begin();
 					       j != ttgrp_lo.end(); ++j) {
 	LinkedObject lo = (*j);
 	std::cout << "Resolving symbols for " << lo.getPath() << std::endl;
 
-#if defined(OPENSS_USE_SYMTABAPI)
     // Note that DyninstSymbols::getLoops() must be called before calling
     // SymtabAPISymbols::getSymbols(). This is because getLoops() updates
     // unique_addresses with the head address of every loop so that later
@@ -1498,14 +1894,22 @@ void OfflineExperiment::createOfflineSymbolTable()
 	//std::cerr << Time::Now() << " Resolve symtabapi symbols" << std::endl;
 	stapi_symbols.getSymbols(unique_addresses,lo,symtabmap);
 	//std::cerr << Time::Now() << " Done with symbols" << std::endl;
-#else
-	// If this is ever reused, it needs to use unique_addresses...
-	//std::cerr << Time::Now() << " Resolve bfd symbols" << std::endl;
-	bfd_symbols.getSymbols(unique_addresses,lo,symtabmap);
-	//std::cerr << Time::Now() << " Done with symbols" << std::endl;
-#endif
 
     } // end for threads linkedobjects
+#else
+    // Resolve the bfd symbols of every linked object, possibly concurrently,
+    // and then store them into the symbol table map from this thread alone.
+    SymbolQueue symbols(unique_addresses, symtabmap, ttgrp_lo);
+    for(std::vector<LinkedObject>::size_type
+	    j = 0; j < symbols.dm_linked_objects.size(); ++j)
+	std::cout << "Resolving symbols for "
+		  << symbols.dm_linked_objects[j].getPath() << std::endl;
+    runSymbolQueue(symbols);
+    for(std::vector<LinkedObject>::size_type
+	    j = 0; j < symbols.dm_linked_objects.size(); ++j)
+	symbols.dm_symbols[j].storeSymbols(symbols.dm_linked_objects[j],
+					   symtabmap);
+#endif
 
     std::cout << "Updating database with symbols ... " << std::endl;
 
@@ -1795,4 +2199,8 @@ void OfflineExperiment::finalizeDB()
     // TODO:  Could look at removing any thread entries for which there
     // are no performance data blobs in the data table.
     END_TRANSACTION(database);
+
+    // Pre-resolve the sampled addresses so that views of this experiment
+    // need not load the symbol information of entire linked objects.
+    theExperiment->resolveSampledAddresses();
 }
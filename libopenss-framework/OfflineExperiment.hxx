@@ -103,8 +103,10 @@ class OfflineExperiment
     std::string expTraced;
 
     bool	process_expinfo(const std::string rawfilename);
+    bool	process_expinfo(const std::string rawfilename, const Blob&);
     bool	process_data(const std::string rawfilename);
     bool	process_objects(const std::string rawfilename);
+    bool	process_objects(const Blob&);
 #if defined(BUILD_CBTF)
     // with cbtf-krell collection we use only one file to
     // record performance data and then append the linked object
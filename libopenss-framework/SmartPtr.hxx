@@ -33,7 +33,7 @@
 #include "Assert.hxx"
 #include "TotallyOrdered.hxx"
 
-#include <pthread.h>
+#include <stddef.h>
 
 
 
@@ -46,6 +46,12 @@ namespace OpenSpeedShop { namespace Framework {
      * type of the pointed to object is specified by the template instantiation.
      * When the last smart pointer to a given object is destroyed, the object
      * itself is also destroyed.
+     *
+     * @note    Smart pointers are copied very frequently (e.g. every copy of a
+     *          Function copies a SmartPtr<Database>). Their reference counts
+     *          are therefore updated with atomic operations rather than being
+     *          protected by a lock, and null smart pointers do not allocate a
+     *          bookkeeping structure at all.
      *     
      * @sa    http://ootips.org/yonat/4dev/smart-pointers.html
      * @sa    http://www.awprofessional.com/articles/article.asp?p=31529
@@ -62,14 +68,14 @@ namespace OpenSpeedShop { namespace Framework {
 	/** Default constructor. */
 	SmartPtr() :
 	    dm_object(NULL),
-	    dm_bookkeeping(new Bookkeeping())
+	    dm_bookkeeping(NULL)
 	{
 	}
 	
 	/** Constructor from an object pointer. */
 	explicit SmartPtr(T* object) :
 	    dm_object(object),
-	    dm_bookkeeping(new Bookkeeping())
+	    dm_bookkeeping((object != NULL) ? new Bookkeeping() : NULL)
 	{
 	}
 
@@ -79,59 +85,68 @@ namespace OpenSpeedShop { namespace Framework {
 	    dm_bookkeeping(other.dm_bookkeeping)
 	{
 	    // Increment the reference count of this object
-	    Assert(dm_bookkeeping != NULL);
-	    Assert(pthread_mutex_lock(&(dm_bookkeeping->dm_lock)) == 0);
-	    dm_bookkeeping->dm_references++;
-	    Assert(pthread_mutex_unlock(&(dm_bookkeeping->dm_lock)) == 0);
+	    acquire();
 	}
 
+#if __cplusplus >= 201103L
+	/** Move constructor. */
+	SmartPtr(SmartPtr&& other) :
+	    dm_object(other.dm_object),
+	    dm_bookkeeping(other.dm_bookkeeping)
+	{
+	    // Take the other smart pointer's reference to this object
+	    other.dm_object = NULL;
+	    other.dm_bookkeeping = NULL;
+	}
+#endif
+
 	/** Destructor. */
 	~SmartPtr()
 	{
 	    // Decrement the reference count of our object
-	    Assert(dm_bookkeeping != NULL);
-	    Assert(pthread_mutex_lock(&(dm_bookkeeping->dm_lock)) == 0);
-	    unsigned references = --dm_bookkeeping->dm_references;
-	    Assert(pthread_mutex_unlock(&(dm_bookkeeping->dm_lock)) == 0);
-
-	    // Destroy our object if we were the last reference
-	    if(references == 0) {
-		delete dm_object;
-		delete dm_bookkeeping;
-	    }
+	    release();
 	}
 	
 	/** Operator "=" defined for a SmartPtr object. */
         SmartPtr& operator=(const SmartPtr& other)
 	{
-	    // Only do an assignment if the object pointers differ
-	    if(dm_object != other.dm_object) {
+	    // Only do an assignment if the bookkeeping structures differ
+	    if(dm_bookkeeping != other.dm_bookkeeping) {
 		
 		// Decrement the reference count of our object
-		Assert(dm_bookkeeping != NULL);
-		Assert(pthread_mutex_lock(&(dm_bookkeeping->dm_lock)) == 0);
-		unsigned references = --dm_bookkeeping->dm_references;
-		Assert(pthread_mutex_unlock(&(dm_bookkeeping->dm_lock)) == 0);
-		
-		// Destroy our object if we were the last reference
-		if(references == 0) {
-		    delete dm_object;
-		    delete dm_bookkeeping;
-		}
+		release();
 		
 		// Replace our object with the new object
 		dm_object = other.dm_object;
 		dm_bookkeeping = other.dm_bookkeeping;
 		
 		// Increment the reference count of the new object
-		Assert(dm_bookkeeping != NULL);
-		Assert(pthread_mutex_lock(&(dm_bookkeeping->dm_lock)) == 0);
-		dm_bookkeeping->dm_references++;
-		Assert(pthread_mutex_unlock(&(dm_bookkeeping->dm_lock)) == 0);
+		acquire();
+	    }
+
+	    return *this;
+	}
+
+#if __cplusplus >= 201103L
+	/** Operator "=" defined for a moved SmartPtr object. */
+	SmartPtr& operator=(SmartPtr&& other)
+	{
+	    // Only do an assignment if the bookkeeping structures differ
+	    if(dm_bookkeeping != other.dm_bookkeeping) {
+
+		// Decrement the reference count of our object
+		release();
+
+		// Take the other smart pointer's reference to its object
+		dm_object = other.dm_object;
+		dm_bookkeeping = other.dm_bookkeeping;
+		other.dm_object = NULL;
+		other.dm_bookkeeping = NULL;
 	    }
 
 	    return *this;
 	}
+#endif
 
 	/** Operator "<" defined for two SmartPtr objects. */
 	bool operator<(const SmartPtr& other) const
@@ -164,30 +179,38 @@ namespace OpenSpeedShop { namespace Framework {
 	/** Internal bookkeeping structure. */
 	struct Bookkeeping
 	{
-	    pthread_mutex_t dm_lock;  /**< Mutual exclusion lock. */
 	    unsigned dm_references;   /**< Reference count. */
 	    
 	    /** Default constructor. */
 	    Bookkeeping() :
-		dm_lock(),
 		dm_references(1)
 	    {
-		Assert(pthread_mutex_init(&dm_lock, NULL) == 0);
 	    }
 
-	    /** Destructor. */
-	    ~Bookkeeping()
-	    {
-		Assert(pthread_mutex_destroy(&dm_lock) == 0);
-	    }
-	    
 	};
 
 	/** Pointer to the object. */
 	T* dm_object;
 	
-	/** Pointer to the object's bookkeeping structure. */
-	mutable Bookkeeping* dm_bookkeeping;
+	/** Pointer to the object's bookkeeping structure (null if none). */
+	Bookkeeping* dm_bookkeeping;
+
+	/** Increment the reference count of our object. */
+	void acquire()
+	{
+	    if(dm_bookkeeping != NULL)
+		__sync_fetch_and_add(&dm_bookkeeping->dm_references, 1);
+	}
+
+	/** Decrement the reference count, destroying our object if last. */
+	void release()
+	{
+	    if((dm_bookkeeping != NULL) &&
+	       (__sync_sub_and_fetch(&dm_bookkeeping->dm_references, 1) == 0)) {
+		delete dm_object;
+		delete dm_bookkeeping;
+	    }
+	}
 	
     };
     
@@ -25,6 +25,7 @@
  */
 
 #include "AddressBitmap.hxx"
+#include "AttributeCache.hxx"
 #include "Blob.hxx"
 #include "EntrySpy.hxx"
 #include "Exception.hxx"
@@ -211,6 +212,11 @@ LinkedObject Statement::getLinkedObject() const
 {
     LinkedObject linked_object;
 
+    // Use the attribute cache when possible
+    int entry;
+    if(TheAttributeCache.getStatementLinkedObject(dm_database, dm_entry, entry))
+	return LinkedObject(dm_database, entry);
+
     // Find our linked object
     BEGIN_TRANSACTION(dm_database);
     validate();
@@ -240,6 +246,10 @@ Path Statement::getPath() const
 {
     Path path;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getStatementPath(dm_database, dm_entry, path))
+	return path;
+
     // Find our source file's path
     BEGIN_TRANSACTION(dm_database);
     validate();
@@ -279,6 +289,10 @@ int Statement::getLine() const
 {
     int line;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getStatementLine(dm_database, dm_entry, line))
+	return line;
+
     // Find our line number
     BEGIN_TRANSACTION(dm_database);
     validate();
@@ -307,6 +321,10 @@ int Statement::getColumn() const
 {
     int column;
 
+    // Use the attribute cache when possible
+    if(TheAttributeCache.getStatementColumn(dm_database, dm_entry, column))
+	return column;
+
     // Find our column number
     BEGIN_TRANSACTION(dm_database);
     validate();
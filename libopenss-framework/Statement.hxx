@@ -69,6 +69,7 @@ namespace OpenSpeedShop { namespace Framework {
 	friend class LinkedObject;
 	friend class Loop;
 	friend class StatementCache;
+	friend class SymbolTable;
 	friend class Thread;
 	friend class ThreadGroup;
 	friend class VectorInstr;
@@ -29,6 +29,7 @@
 #include "config.h"
 #endif
 
+#include "AddressTable.hxx"
 #include "ExtentTable.hxx"
 #include "LinkedObject.hxx"
 #include "Lockable.hxx"
@@ -62,15 +63,21 @@ namespace OpenSpeedShop { namespace Framework {
 
 	std::set<Statement> getStatements(const LinkedObject&,
 					  const ExtentGroup&);
+	std::set<Statement> getStatementsAt(const LinkedObject&, const Address&);
 
 	void removeDatabase(const SmartPtr<Database>&);
+	void removeLinkedObject(const LinkedObject&);
 
     private:
 
 	/** Extent table containing source code statement cache. */
 	ExtentTable<LinkedObject, Statement> dm_cache;
 
+	/** Address table containing statement address index. */
+	AddressTable<LinkedObject, Statement> dm_index;
+
 	void addLinkedObject(const LinkedObject&);
+	void addResolvedAddresses(const LinkedObject&);
 
     };
 	
@@ -29,10 +29,19 @@
 #include "Blob.hxx"
 #include "Database.hxx"
 #include "EntrySpy.hxx"
+#include "Function.hxx"
+#include "FunctionCache.hxx"
+#include "InlineFunction.hxx"
+#include "InlineFunctionCache.hxx"
 #include "LinkedObject.hxx"
+#include "Loop.hxx"
+#include "LoopCache.hxx"
 #include "Path.hxx"
+#include "Statement.hxx"
+#include "StatementCache.hxx"
 #include "SymbolTable.hxx"
 
+#include <algorithm>
 #include <deque>
 
 using namespace OpenSpeedShop::Framework;
@@ -284,9 +293,31 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
     SmartPtr<Database> database = EntrySpy(linked_object).getDatabase();
     BEGIN_WRITE_TRANSACTION(database);
     
-    // Iterate over each function entry
+    static const char* FunctionColumns[] = { "linked_object", "name" };
+    static const char* RangeColumns[] = {
+	"addr_begin", "addr_end", "valid_bitmap"
+    };
+
+    // Rows (and their bitmaps) to be bulk inserted into the database
+    std::vector<Database::Row> rows;
+    std::deque<Blob> bitmaps;
+    std::vector<std::string> columns;
+    
+    // Create the function entries
+    columns.assign(FunctionColumns, FunctionColumns + 2);
     for(std::map<AddressRange, std::string>::const_iterator
 	    i = dm_functions.begin(); i != dm_functions.end(); ++i) {
+	rows.push_back(Database::Row());
+	rows.back() << EntrySpy(linked_object).getEntry() << i->second;
+    }
+    if(!rows.empty())
+	database->insertRows("Functions", columns, rows);
+    int function = database->getLastInsertedUID() - rows.size() + 1;
+    rows.clear();
+
+    // Iterate over each function entry
+    for(std::map<AddressRange, std::string>::const_iterator
+	    i = dm_functions.begin(); i != dm_functions.end(); ++i, ++function) {
 
 	// Get the function range
 	Address addr_begin(i->first.getBegin() - dm_range.getBegin());
@@ -305,32 +336,26 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
 
 	// Construct a valid bitmap for this (entire) function range
 	AddressBitmap valid_bitmap(AddressRange(addr_begin, addr_end));
-	for(Address addr = addr_begin; addr < addr_end; ++addr)
-	    valid_bitmap.setValue(addr, true);
-
-	// Create the function entry
-	database->prepareStatement(
-	    "INSERT INTO Functions (linked_object, name) VALUES (?, ?);"
-	    );
-	database->bindArgument(1, EntrySpy(linked_object).getEntry());
-	database->bindArgument(2, i->second);
-	while(database->executeStatement());	
-	int function = database->getLastInsertedUID();
+	valid_bitmap.setValue(valid_bitmap.getRange(), true);
+	bitmaps.push_back(valid_bitmap.getBlob());
+	
+	// Add the function ranges entry
+	rows.push_back(Database::Row());
+	rows.back() << function
+		    << valid_bitmap.getRange().getBegin()
+		    << valid_bitmap.getRange().getEnd()
+		    << bitmaps.back();
 	
-	// Create the function ranges entry
-	database->prepareStatement(
-	    "INSERT INTO FunctionRanges "
-	    "  (function, addr_begin, addr_end, valid_bitmap) "
-	    "VALUES (?, ?, ?, ?);"
-	    );
-	database->bindArgument(1, function);
-	database->bindArgument(2, valid_bitmap.getRange().getBegin());
-	database->bindArgument(3, valid_bitmap.getRange().getEnd());
-	database->bindArgument(4, valid_bitmap.getBlob());
-	while(database->executeStatement());
-
     }
 
+    // Create the function ranges entries
+    columns.assign(1, "function");
+    columns.insert(columns.end(), RangeColumns, RangeColumns + 3);
+    if(!rows.empty())
+	database->insertRows("FunctionRanges", columns, rows);
+    rows.clear();
+    bitmaps.clear();
+
 
     // Iterate over each loop entry
     for(std::map<Address, std::vector<AddressRange> >::const_iterator
@@ -345,25 +370,18 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
         while(database->executeStatement());
         int loop = database->getLastInsertedUID();
         
-        // Construct the set of unique addresses for this loop
-        std::set<Address> addresses;
-        for(std::vector<AddressRange>::const_iterator
-                j = i->second.begin(); j != i->second.end(); ++j)
-            for(Address k = j->getBegin(); k != j->getEnd(); ++k)
-                addresses.insert(Address(k - dm_range.getBegin()));
-        
-        // Partition this loop's address set
-        std::vector<std::set<Address> > address_sets =
-            partitionAddressSet(addresses);
+        // Partition this loop's address ranges
+        std::vector<std::vector<AddressRange> > range_sets =
+            partitionAddressRanges(i->second, dm_range.getBegin());
         
-        // Iterate over each partitioned address set
-        for(std::vector<std::set<Address> >::const_iterator
-                j = address_sets.begin(); j != address_sets.end(); ++j) {
+        // Iterate over each partitioned set of address ranges
+        for(std::vector<std::vector<AddressRange> >::const_iterator
+                j = range_sets.begin(); j != range_sets.end(); ++j) {
             
-            // Create and populate an address bitmap for this address set
-            AddressBitmap valid_bitmap(AddressRange(*(j->begin()),
-                                                    *(j->rbegin()) + 1));
-            for(std::set<Address>::const_iterator
+            // Create and populate an address bitmap for this set
+            AddressBitmap valid_bitmap(AddressRange(j->front().getBegin(),
+                                                    j->back().getEnd()));
+            for(std::vector<AddressRange>::const_iterator
                     k = j->begin(); k != j->end(); ++k)
                 valid_bitmap.setValue(*k, true);
             
@@ -382,9 +400,12 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
     }
 
 
-    // Iterate over each statement entry
+    // Find or create the file entries for the statements
+    std::map<std::string, int> files;
     for(std::map<StatementEntry, std::vector<AddressRange> >::const_iterator
 	    i = dm_statements.begin(); i != dm_statements.end(); ++i) {
+	if(files.find(i->first.dm_path) != files.end())
+	    continue;
 
 	// Is there an existing file in the database?
 	int file = -1;
@@ -400,57 +421,68 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
 	    while(database->executeStatement());
 	    file = database->getLastInsertedUID();
 	}
+
+	files[i->first.dm_path] = file;
+    }
+    
+    // Create the statement entries
+    columns.clear();
+    columns.push_back("linked_object");
+    columns.push_back("file");
+    columns.push_back("line");
+    columns.push_back("\"column\"");
+    for(std::map<StatementEntry, std::vector<AddressRange> >::const_iterator
+	    i = dm_statements.begin(); i != dm_statements.end(); ++i) {
+	rows.push_back(Database::Row());
+	rows.back() << EntrySpy(linked_object).getEntry()
+		    << files[i->first.dm_path]
+		    << i->first.dm_line
+		    << i->first.dm_column;
+    }
+    if(!rows.empty())
+	database->insertRows("Statements", columns, rows);
+    int statement = database->getLastInsertedUID() - rows.size() + 1;
+    rows.clear();
+    
+    // Iterate over each statement entry
+    for(std::map<StatementEntry, std::vector<AddressRange> >::const_iterator
+	    i = dm_statements.begin(); i != dm_statements.end();
+	++i, ++statement) {
+
+	// Partition this statement's address ranges
+	std::vector<std::vector<AddressRange> > range_sets =
+	    partitionAddressRanges(i->second, dm_range.getBegin());
 	
-	// Create the statement entry
-	database->prepareStatement(
-	    "INSERT INTO Statements "
-	    "  (linked_object, file, line, \"column\") "
-	    "VALUES (?, ?, ?, ?);"
-	    );
-	database->bindArgument(1, EntrySpy(linked_object).getEntry());
-	database->bindArgument(2, file);
-	database->bindArgument(3, i->first.dm_line);
-	database->bindArgument(4, i->first.dm_column);
-	while(database->executeStatement());	
-	int statement = database->getLastInsertedUID();
-
-	// Construct the set of unique addresses for this statement
-	std::set<Address> addresses;
-	for(std::vector<AddressRange>::const_iterator
-		j = i->second.begin(); j != i->second.end(); ++j)
-	    for(Address k = j->getBegin(); k != j->getEnd(); ++k)
-		addresses.insert(Address(k - dm_range.getBegin()));
-	
-	// Partition this statement's address set
-	std::vector<std::set<Address> > address_sets =
-	    partitionAddressSet(addresses);
-	
-	// Iterate over each partitioned address set
-	for(std::vector<std::set<Address> >::const_iterator
-		j = address_sets.begin(); j != address_sets.end(); ++j) {
+	// Iterate over each partitioned set of address ranges
+	for(std::vector<std::vector<AddressRange> >::const_iterator
+		j = range_sets.begin(); j != range_sets.end(); ++j) {
 	    
-	    // Create and populate an address bitmap for this address set
-	    AddressBitmap valid_bitmap(AddressRange(*(j->begin()),
-						    *(j->rbegin()) + 1));
-	    for(std::set<Address>::const_iterator
+	    // Create and populate an address bitmap for this set
+	    AddressBitmap valid_bitmap(AddressRange(j->front().getBegin(),
+						    j->back().getEnd()));
+	    for(std::vector<AddressRange>::const_iterator
 		    k = j->begin(); k != j->end(); ++k)
 		valid_bitmap.setValue(*k, true);
+	    bitmaps.push_back(valid_bitmap.getBlob());
 	    
-	    // Create the statement ranges entry
-	    database->prepareStatement(
-		"INSERT INTO StatementRanges "
-		"  (statement, addr_begin, addr_end, valid_bitmap) "
-		"VALUES (?, ?, ?, ?);"
-		);
-	    database->bindArgument(1, statement);
-	    database->bindArgument(2, valid_bitmap.getRange().getBegin());
-	    database->bindArgument(3, valid_bitmap.getRange().getEnd());
-	    database->bindArgument(4, valid_bitmap.getBlob());
-	    while(database->executeStatement());
+	    // Add the statement ranges entry
+	    rows.push_back(Database::Row());
+	    rows.back() << statement
+			<< valid_bitmap.getRange().getBegin()
+			<< valid_bitmap.getRange().getEnd()
+			<< bitmaps.back();
 	    
 	}
     }
 
+    // Create the statement ranges entries
+    columns.assign(1, "statement");
+    columns.insert(columns.end(), RangeColumns, RangeColumns + 3);
+    if(!rows.empty())
+	database->insertRows("StatementRanges", columns, rows);
+    rows.clear();
+    bitmaps.clear();
+
 
 
     // Iterate over each inlined function entry
@@ -487,25 +519,18 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
 	while(database->executeStatement());	
 	int inlinefunc = database->getLastInsertedUID();
 
-	// Construct the set of unique addresses for this inlinefunc
-	std::set<Address> addresses;
-	for(std::vector<AddressRange>::const_iterator
-		j = i->second.begin(); j != i->second.end(); ++j)
-	    for(Address k = j->getBegin(); k != j->getEnd(); ++k)
-		addresses.insert(Address(k - dm_range.getBegin()));
-	
-	// Partition this inlinefunc's address set
-	std::vector<std::set<Address> > address_sets =
-	    partitionAddressSet(addresses);
+	// Partition this inlinefunc's address ranges
+	std::vector<std::vector<AddressRange> > range_sets =
+	    partitionAddressRanges(i->second, dm_range.getBegin());
 	
-	// Iterate over each partitioned address set
-	for(std::vector<std::set<Address> >::const_iterator
-		j = address_sets.begin(); j != address_sets.end(); ++j) {
+	// Iterate over each partitioned set of address ranges
+	for(std::vector<std::vector<AddressRange> >::const_iterator
+		j = range_sets.begin(); j != range_sets.end(); ++j) {
 	    
-	    // Create and populate an address bitmap for this address set
-	    AddressBitmap valid_bitmap(AddressRange(*(j->begin()),
-						    *(j->rbegin()) + 1));
-	    for(std::set<Address>::const_iterator
+	    // Create and populate an address bitmap for this set
+	    AddressBitmap valid_bitmap(AddressRange(j->front().getBegin(),
+						    j->back().getEnd()));
+	    for(std::vector<AddressRange>::const_iterator
 		    k = j->begin(); k != j->end(); ++k)
 		valid_bitmap.setValue(*k, true);
 	    
@@ -570,96 +595,128 @@ void SymbolTable::processAndStore(const LinkedObject& linked_object)
     
     // End the transaction on this database
     END_TRANSACTION(database);    
+
+    // Discard any cached address ranges for this linked object
+    Function::TheCache.removeLinkedObject(linked_object);
+    InlineFunction::TheCache.removeLinkedObject(linked_object);
+    Loop::TheCache.removeLinkedObject(linked_object);
+    Statement::TheCache.removeLinkedObject(linked_object);
 }
 
 /**
- * Partition an address set.
+ * Partition address ranges.
  *
- * Partitions an address set into one or more subsets. As a comprimise between
- * query speed and database size, the addresses associated with a statement are 
- * stored as an address range and a bitmap - one bit per address in the range -
- * that describes which addresses within the range are associated with the 
- * statement. In the common case where a statement's addresses exhibit a high
- * degree of spatial locality, storing one address range and bitmap is very
- * effective. But there are cases, such as inlined functions, where the degree
- * of spatial locality is minimal. Under such circumstances, the bitmap can
- * grow very large and it is more space efficient to partition the bitmap into
- * subsets that themselves exhibit spatial locality. This function iteratively
- * subdivides the address sets until each subset exhibits a "sufficient" amount
- * of spatial locality.
+ * Partitions the addresses within a set of address ranges into one or more
+ * subsets. As a comprimise between query speed and database size, the addresses
+ * associated with a statement are stored as an address range and a bitmap - one
+ * bit per address in the range - that describes which addresses within the
+ * range are associated with the statement. In the common case where a
+ * statement's addresses exhibit a high degree of spatial locality, storing one
+ * address range and bitmap is very effective. But there are cases, such as
+ * inlined functions, where the degree of spatial locality is minimal. Under
+ * such circumstances, the bitmap can grow very large and it is more space
+ * efficient to partition the bitmap into subsets that themselves exhibit
+ * spatial locality. This function iteratively subdivides the addresses until
+ * each subset exhibits a "sufficient" amount of spatial locality.
  *
- * @note    The criteria for subdividing an address set is as follows. The
+ * @note    The criteria for subdividing a set of addresses is as follows. The
  *          widest gap (spacing) between two adjacent addresses is found. If
  *          the number of bits required to represent this gap in the bitmap
  *          is greater than the number of bits required to store the initial
  *          header of a StatementRanges table row, then the set is partitioned
  *          at this, widest, gap.
  *
- * @param address_set    Set of addresses to be partitioned.
- * @return               Partitioned sets of addresses.
+ * @note    Rather than expanding the address ranges into individual addresses,
+ *          the ranges are sorted and merged, leaving gaps only between adjacent
+ *          merged ranges. The subdivision described above is then replayed on
+ *          a Cartesian tree of the gaps wider than the partitioning criteria
+ *          (each subtree's root being the leftmost widest gap), which requires
+ *          only linear time in the number of ranges. Subsets are returned in
+ *          the order they are found by that subdivision.
+ *
+ * @param ranges    Address ranges to be partitioned.
+ * @param base      Base address subtracted from every address.
+ * @return          Partitioned sets of sorted, non-adjacent address ranges.
  */
-std::vector<std::set<Address> >
-SymbolTable::partitionAddressSet(const std::set<Address>& address_set)
+std::vector<std::vector<AddressRange> >
+SymbolTable::partitionAddressRanges(const std::vector<AddressRange>& ranges,
+				    const Address& base)
 {
-    std::vector<std::set<Address> > result;
-    
+    std::vector<std::vector<AddressRange> > result;
+
     // Set the partitioning criteria
     static const Address::difference_type PartitioningCriteria =
 	8 * (sizeof(uint32_t) + 2 * sizeof(uint64_t));
-    
-    // Initialize a queue with the initial, input, set of addresses
-    std::deque<std::set<Address> > queue(1, address_set);
-    
-    // Iterate until the queue is empty
-    while(!queue.empty()) {	
-	std::set<Address> i = queue.front();
-	queue.pop_front();
-	
-	// Handle special case for empty sets (ignore them)
-	if(i.size() == 0)
-	    continue;
-	
-	// Handle special case for single-element sets
-	if(i.size() == 1) {
-	    result.push_back(i);
-	    continue;
+
+    // Handle special case for empty sets (ignore them)
+    if(ranges.empty())
+	return result;
+
+    // Sort the address ranges and merge those that overlap or are adjacent
+    std::vector<AddressRange> sorted;
+    for(std::vector<AddressRange>::const_iterator
+	    i = ranges.begin(); i != ranges.end(); ++i)
+	sorted.push_back(AddressRange(Address(i->getBegin() - base),
+				      Address(i->getEnd() - base)));
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<AddressRange> merged;
+    for(std::vector<AddressRange>::const_iterator
+	    i = sorted.begin(); i != sorted.end(); ++i)
+	if(merged.empty() || (i->getBegin() > merged.back().getEnd()))
+	    merged.push_back(*i);
+	else if(i->getEnd() > merged.back().getEnd())
+	    merged.back() = AddressRange(merged.back().getBegin(), i->getEnd());
+
+    // Find the gaps wider than the partitioning criteria
+    std::vector<std::vector<AddressRange>::size_type> splits;
+    std::vector<Address::difference_type> gaps;
+    for(std::vector<AddressRange>::size_type i = 1; i < merged.size(); ++i) {
+	Address::difference_type gap =
+	    merged[i].getBegin() - merged[i - 1].getEnd();
+	if(gap > PartitioningCriteria) {
+	    splits.push_back(i);
+	    gaps.push_back(gap);
 	}
-	
-	// Pair specifying the widest gap in this address set
-	std::pair<std::set<Address>::const_iterator, Address::difference_type>
-	    widest_gap = std::make_pair(i.begin(), 0);
-
-	// Iterate over each adjacent pair of addresses in this set
-	for(std::set<Address>::const_iterator
-		prev = i.begin(), current = ++i.begin();
-	    current != i.end();
-	    ++prev, ++current) {
-
-	    // Calculate the gap between this adjacent address pair
-	    Address::difference_type gap = 
-		AddressRange(*prev, *current).getWidth() - 1;
-	    
-	    // Is this gap the widest so far?
-	    if(gap > widest_gap.second) {
-		widest_gap.first = current;
-		widest_gap.second = gap;
-	    }
-	    
+    }
+
+    // Build the Cartesian tree of these gaps
+    std::vector<int> left(gaps.size(), -1), right(gaps.size(), -1), stack;
+    for(int i = 0; i < static_cast<int>(gaps.size()); ++i) {
+	int last = -1;
+	while(!stack.empty() && (gaps[stack.back()] < gaps[i])) {
+	    last = stack.back();
+	    stack.pop_back();
 	}
-	
-	// Is the widest gap greater than our partitioning criteria?
-	if(widest_gap.second > PartitioningCriteria) {
+	left[i] = last;
+	if(!stack.empty())
+	    right[stack.back()] = i;
+	stack.push_back(i);
+    }
 
-	    // Partition the set at this gap
-	    queue.push_back(std::set<Address>(i.begin(), widest_gap.first));
-	    queue.push_back(std::set<Address>(widest_gap.first, i.end()));
-	    
+    // Subdivide the merged ranges at the root of each subtree, breadth first,
+    // until reaching the subsets between adjacent (partitioning) gaps
+    std::deque<std::pair<int, std::pair<std::vector<AddressRange>::size_type,
+					std::vector<AddressRange>::size_type> > >
+	queue(1, std::make_pair(stack.empty() ? -1 : stack.front(),
+				std::make_pair(0, merged.size())));
+    while(!queue.empty()) {
+	int node = queue.front().first;
+	std::vector<AddressRange>::size_type first = queue.front().second.first;
+	std::vector<AddressRange>::size_type last = queue.front().second.second;
+	queue.pop_front();
+
+	// Keep this subset unpartitioned if there is no gap to partition at
+	if(node == -1) {
+	    result.push_back(std::vector<AddressRange>(merged.begin() + first,
+						       merged.begin() + last));
+	    continue;
 	}
-	
-	// Otherwise keep this set unpartitioned
-	else
-	    result.push_back(i);
-	
+
+	// Otherwise partition the subset at this gap
+	queue.push_back(std::make_pair(left[node],
+				       std::make_pair(first, splits[node])));
+	queue.push_back(std::make_pair(right[node],
+				       std::make_pair(splits[node], last)));
     }
 
     // Return the results to the caller
@@ -106,8 +106,9 @@ namespace OpenSpeedShop { namespace Framework {
 	
     private:
 
-	static std::vector<std::set<Address> >
-	partitionAddressSet(const std::set<Address>&);
+	static std::vector<std::vector<AddressRange> >
+	partitionAddressRanges(const std::vector<AddressRange>&,
+			       const Address&);
 	
 	/** Address range occupied by this symbol table. */
 	AddressRange dm_range;
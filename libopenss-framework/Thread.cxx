@@ -27,12 +27,16 @@
 #include "AddressBitmap.hxx"
 #include "CollectorGroup.hxx"
 #include "Function.hxx"
+#include "FunctionCache.hxx"
 #include "InlineFunction.hxx"
+#include "InlineFunctionCache.hxx"
 #include "Instrumentor.hxx"
 #include "LinkedObject.hxx"
 #include "Loop.hxx"
+#include "LoopCache.hxx"
 #include "Path.hxx"
 #include "Statement.hxx"
+#include "StatementCache.hxx"
 #include "Thread.hxx"
 #include "ThreadGroup.hxx"
 #include "VectorInstr.hxx"
@@ -41,6 +45,45 @@ using namespace OpenSpeedShop::Framework;
 
 
 
+namespace {
+
+    /** Query for the linked object containing an address at a time. */
+    const Database::RegisteredStatement LinkedObjectAtQuery(
+	"SELECT linked_object "
+	"FROM AddressSpaces "
+	"WHERE thread = ? "
+	"  AND ? >= time_begin "
+	"  AND ? < time_end "
+	"  AND ? >= addr_begin "
+	"  AND ? < addr_end;"
+	);
+
+    /** Query for the linked object, and its base address, at a time. */
+    const Database::RegisteredStatement LinkedObjectAndBaseAtQuery(
+	"SELECT linked_object, "
+	"       addr_begin "
+	"FROM AddressSpaces "
+	"WHERE thread = ? "
+	"  AND ? >= time_begin "
+	"  AND ? < time_end "
+	"  AND ? >= addr_begin "
+	"  AND ? < addr_end;"
+	);
+
+    /** Query for the linked object, and its base address, at any time. */
+    const Database::RegisteredStatement LinkedObjectAndBaseAtAnyTimeQuery(
+	"SELECT linked_object, "
+	"       addr_begin "
+	"FROM AddressSpaces "
+	"WHERE thread = ? "
+	"  AND ? >= addr_begin "
+	"  AND ? < addr_end;"
+	);
+
+}
+
+
+
 /**
  * Get our state.
  *
@@ -448,24 +491,16 @@ Thread::getInlineFunctionsAt(const Address& address, const Time& time) const
 {
     std::set<InlineFunction> inlines;
 
+    bool found_linked_object = false;
+    int linked_object;
+    Address addr_begin;
+
     // Begin a multi-statement transaction
     BEGIN_TRANSACTION(dm_database);
     validate();
     
     // Find the linked object containing the requested address/time
-    bool found_linked_object = false; 
-    int linked_object;
-    Address addr_begin;    
-    dm_database->prepareStatement(
-	"SELECT linked_object, "
-	"       addr_begin "
-	"FROM AddressSpaces "
-	"WHERE thread = ? "
-	"  AND ? >= time_begin "
-	"  AND ? < time_end "
-	"  AND ? >= addr_begin "
-	"  AND ? < addr_end;"
-	);
+    dm_database->prepareStatement(LinkedObjectAndBaseAtQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, time);
     dm_database->bindArgument(3, time);
@@ -483,46 +518,16 @@ Thread::getInlineFunctionsAt(const Address& address, const Time& time) const
 	addr_begin = dm_database->getResultAsAddress(2);
     }
 
-    // Did we find the linked object?
-    if(found_linked_object) {
-
-	// Find the statements containing the requested address    
-	dm_database->prepareStatement(
-	    "SELECT InlinedFunctions.id, "
-	    "       InlinedFunctionsRanges.addr_begin, "
-	    "       InlinedFunctionsRanges.addr_end, "
-	    "       InlinedFunctionsRanges.valid_bitmap "
-	    "FROM InlinedFunctionsRanges "
-	    "  JOIN InlinedFunctions "
-	    "ON InlinedFunctionsRanges.inline = InlinedFunctions.id "
-	    "WHERE InlinedFunctions.linked_object = ? "
-	    "  AND ? >= InlinedFunctionsRanges.addr_begin "
-	    "  AND ? < InlinedFunctionsRanges.addr_end;"
-	    );
-	dm_database->bindArgument(1, linked_object);
-	dm_database->bindArgument(2, Address(address - addr_begin));
-	dm_database->bindArgument(3, Address(address - addr_begin));
-	while(dm_database->executeStatement()) {
-	    
-	    AddressBitmap bitmap(
-		AddressRange(dm_database->getResultAsAddress(2),
-			     dm_database->getResultAsAddress(3)),
-		dm_database->getResultAsBlob(4)
-		);
-	    
-	    if(bitmap.getValue(address - addr_begin))
-		inlines.insert(
-		    InlineFunction(dm_database,
-			      dm_database->getResultAsInteger(1))
-		    );
-	    
-	}
-
-    }
-
     // End this multi-statement transaction
     END_TRANSACTION(dm_database);
 
+    // Find the inlined functions containing the requested address
+    if(found_linked_object)
+	inlines = InlineFunction::TheCache.getInlineFunctionsAt(
+	    LinkedObject(dm_database, linked_object),
+	    Address(address - addr_begin)
+	    );
+
     // Return the statements to the caller
     return inlines;
 }
@@ -735,15 +740,7 @@ Thread::getLinkedObjectAt(const Address& address, const Time& time) const
     // Find the linked object containing the requested address/time
     BEGIN_TRANSACTION(dm_database);
     validate();
-    dm_database->prepareStatement(
-	"SELECT linked_object "
-	"FROM AddressSpaces "
-	"WHERE thread = ? "
-	"  AND ? >= time_begin "
-	"  AND ? < time_end "
-	"  AND ? >= addr_begin "
-	"  AND ? < addr_end;"
-	);
+    dm_database->prepareStatement(LinkedObjectAtQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, time);
     dm_database->bindArgument(3, time);
@@ -780,24 +777,16 @@ Thread::getFunctionAt(const Address& address, const Time& time) const
 {
     std::pair<bool, Function> function(false, Function());
 
+    bool found_linked_object = false;
+    int linked_object = 0;
+    Address addr_begin = 0;
+
     // Begin a multi-statement transaction
     BEGIN_TRANSACTION(dm_database);
     validate();
     
     // Find the linked object containing the requested address/time
-    bool found_linked_object = false; 
-    int linked_object = 0;
-    Address addr_begin = 0;    
-    dm_database->prepareStatement(
-	"SELECT linked_object, "
-	"       addr_begin "
-	"FROM AddressSpaces "
-	"WHERE thread = ? "
-	"  AND ? >= time_begin "
-	"  AND ? < time_end "
-	"  AND ? >= addr_begin "
-	"  AND ? < addr_end;"
-	);
+    dm_database->prepareStatement(LinkedObjectAndBaseAtQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, time);
     dm_database->bindArgument(3, time);
@@ -815,53 +804,25 @@ Thread::getFunctionAt(const Address& address, const Time& time) const
 	addr_begin = dm_database->getResultAsAddress(2);
     }
 
-    // Did we find the linked object?
-    if(found_linked_object) {
+    // End this multi-statement transaction
+    END_TRANSACTION(dm_database);
 
-	// Find the function containing the requested address    
-	dm_database->prepareStatement(
-	    "SELECT Functions.id, "
-	    "       FunctionRanges.addr_begin, "
-	    "       FunctionRanges.addr_end, "
-	    "       FunctionRanges.valid_bitmap "
-	    "FROM FunctionRanges "
-	    "  JOIN Functions "
-	    "ON FunctionRanges.function = Functions.id "
-	    "WHERE Functions.linked_object = ? "
-	    "  AND ? >= FunctionRanges.addr_begin "
-	    "  AND ? < FunctionRanges.addr_end;"
+    // Find the function containing the requested address
+    if(found_linked_object) {
+	std::set<Function> functions = Function::TheCache.getFunctionsAt(
+	    LinkedObject(dm_database, linked_object),
+	    Address(address - addr_begin)
 	    );
-	dm_database->bindArgument(1, linked_object);
-	dm_database->bindArgument(2, Address(address - addr_begin));
-	dm_database->bindArgument(3, Address(address - addr_begin));
-	while(dm_database->executeStatement()) {
-
-	    AddressBitmap bitmap(
-		AddressRange(dm_database->getResultAsAddress(2),
-			     dm_database->getResultAsAddress(3)),
-		dm_database->getResultAsBlob(4)
-		);
-	    
-	    if(bitmap.getValue(address - addr_begin)) {
-// This is causing failures with some offline database views
-// (calltrees,butterfly). Disabling the exception until we can
-// figure out why some offline functions have overlapping entries.
-#if 0
-		if(function.first)
-		    throw Exception(Exception::EntryOverlapping, "Functions");
-#endif
-		function.first = true;
-		function.second = Function(dm_database,
-					   dm_database->getResultAsInteger(1));
-	    }
-	    
+	// Overlapping functions are seen in some offline databases and are
+	// not treated as an error. The last such function (the one with the
+	// largest identifier) is used, as it was when the matching rows were
+	// found with a query.
+	if(!functions.empty()) {
+	    function.first = true;
+	    function.second = *(functions.rbegin());
 	}
-	
     }
 
-    // End this multi-statement transaction
-    END_TRANSACTION(dm_database);
-
     // Return the function to the caller
     return function;
 }
@@ -883,24 +844,16 @@ std::set<Loop> Thread::getLoopsAt(const Address& address,
 {
     std::set<Loop> loops;
     
+    bool found_linked_object = false;
+    int linked_object;
+    Address addr_begin;
+
     // Begin a multi-statement transaction
     BEGIN_TRANSACTION(dm_database);
     validate();
     
     // Find the linked object containing the requested address/time
-    bool found_linked_object = false; 
-    int linked_object;
-    Address addr_begin;    
-    dm_database->prepareStatement(
-        "SELECT linked_object, "
-        "       addr_begin "
-        "FROM AddressSpaces "
-        "WHERE thread = ? "
-        "  AND ? >= time_begin "
-        "  AND ? < time_end "
-        "  AND ? >= addr_begin "
-        "  AND ? < addr_end;"
-        );
+    dm_database->prepareStatement(LinkedObjectAndBaseAtQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, time);
     dm_database->bindArgument(3, time);
@@ -914,44 +867,15 @@ std::set<Loop> Thread::getLoopsAt(const Address& address,
         addr_begin = dm_database->getResultAsAddress(2);
     }
     
-    // Did we find the linked object?
-    if(found_linked_object) {
-        
-        // Find the loops containing the requested address    
-        dm_database->prepareStatement(
-            "SELECT Loops.id, "
-            "       LoopRanges.addr_begin, "
-            "       LoopRanges.addr_end, "
-            "       LoopRanges.valid_bitmap "
-            "FROM LoopRanges "
-            "  JOIN Loops "
-            "ON LoopRanges.loop = Loops.id "
-            "WHERE Loops.linked_object = ? "
-            "  AND ? >= LoopRanges.addr_begin "
-            "  AND ? < LoopRanges.addr_end;"
-            );
-        dm_database->bindArgument(1, linked_object);
-        dm_database->bindArgument(2, Address(address - addr_begin));
-        dm_database->bindArgument(3, Address(address - addr_begin));
-        while(dm_database->executeStatement()) {
-            
-            AddressBitmap bitmap(
-                AddressRange(dm_database->getResultAsAddress(2),
-                             dm_database->getResultAsAddress(3)),
-                dm_database->getResultAsBlob(4)
-                );
-            
-            if(bitmap.getValue(address - addr_begin))
-                loops.insert(
-                    Loop(dm_database, dm_database->getResultAsInteger(1))
-                    );
-            
-        }
-        
-    }
-    
     // End this multi-statement transaction
     END_TRANSACTION(dm_database);
+
+    // Find the loops containing the requested address
+    if(found_linked_object)
+        loops = Loop::TheCache.getLoopsAt(
+            LinkedObject(dm_database, linked_object),
+            Address(address - addr_begin)
+            );
     
     // Return the loops to the caller
     return loops;
@@ -974,24 +898,16 @@ Thread::getStatementsAt(const Address& address, const Time& time) const
 {
     std::set<Statement> statements;
 
+    bool found_linked_object = false;
+    int linked_object;
+    Address addr_begin;
+
     // Begin a multi-statement transaction
     BEGIN_TRANSACTION(dm_database);
     validate();
     
     // Find the linked object containing the requested address/time
-    bool found_linked_object = false; 
-    int linked_object;
-    Address addr_begin;    
-    dm_database->prepareStatement(
-	"SELECT linked_object, "
-	"       addr_begin "
-	"FROM AddressSpaces "
-	"WHERE thread = ? "
-	"  AND ? >= time_begin "
-	"  AND ? < time_end "
-	"  AND ? >= addr_begin "
-	"  AND ? < addr_end;"
-	);
+    dm_database->prepareStatement(LinkedObjectAndBaseAtQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, time);
     dm_database->bindArgument(3, time);
@@ -1009,46 +925,16 @@ Thread::getStatementsAt(const Address& address, const Time& time) const
 	addr_begin = dm_database->getResultAsAddress(2);
     }
 
-    // Did we find the linked object?
-    if(found_linked_object) {
-
-	// Find the statements containing the requested address    
-	dm_database->prepareStatement(
-	    "SELECT Statements.id, "
-	    "       StatementRanges.addr_begin, "
-	    "       StatementRanges.addr_end, "
-	    "       StatementRanges.valid_bitmap "
-	    "FROM StatementRanges "
-	    "  JOIN Statements "
-	    "ON StatementRanges.statement = Statements.id "
-	    "WHERE Statements.linked_object = ? "
-	    "  AND ? >= StatementRanges.addr_begin "
-	    "  AND ? < StatementRanges.addr_end;"
-	    );
-	dm_database->bindArgument(1, linked_object);
-	dm_database->bindArgument(2, Address(address - addr_begin));
-	dm_database->bindArgument(3, Address(address - addr_begin));
-	while(dm_database->executeStatement()) {
-	    
-	    AddressBitmap bitmap(
-		AddressRange(dm_database->getResultAsAddress(2),
-			     dm_database->getResultAsAddress(3)),
-		dm_database->getResultAsBlob(4)
-		);
-	    
-	    if(bitmap.getValue(address - addr_begin))
-		statements.insert(
-		    Statement(dm_database,
-			      dm_database->getResultAsInteger(1))
-		    );
-	    
-	}
-
-    }
-
     // End this multi-statement transaction
     END_TRANSACTION(dm_database);
 
+    // Find the statements containing the requested address
+    if(found_linked_object)
+	statements = Statement::TheCache.getStatementsAt(
+	    LinkedObject(dm_database, linked_object),
+	    Address(address - addr_begin)
+	    );
+
     // Return the statements to the caller
     return statements;
 }
@@ -1075,14 +961,7 @@ Thread::getFunctionAndStatementsAt(const Address& address) const
     bool found_linked_object = false; 
     int linked_object = 0;
     Address addr_begin = 0;    
-    dm_database->prepareStatement(
-	"SELECT linked_object, "
-	"       addr_begin "
-	"FROM AddressSpaces "
-	"WHERE thread = ? "
-	"  AND ? >= addr_begin "
-	"  AND ? < addr_end;"
-	);
+    dm_database->prepareStatement(LinkedObjectAndBaseAtAnyTimeQuery);
     dm_database->bindArgument(1, dm_entry);
     dm_database->bindArgument(2, address);
     dm_database->bindArgument(3, address);	
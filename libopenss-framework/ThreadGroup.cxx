@@ -742,7 +742,7 @@ ThreadGroup::getExtentsOf(const std::set<Function>& objects,
 	    std::set<AddressRange> ranges = 
 		AddressBitmap(AddressRange(database->getResultAsAddress(2),
 					   database->getResultAsAddress(3)),
-			      database->getResultAsBlob(4)).
+			      database->getResultAsBlob(4, Blob::Borrow)).
 		getContiguousRanges(true);
 
 	    // Iterate over each thread of this group
@@ -885,7 +885,7 @@ ThreadGroup::getExtentsOf(const std::set<Loop>& objects,
             std::set<AddressRange> ranges = 
                 AddressBitmap(AddressRange(database->getResultAsAddress(2),
                                            database->getResultAsAddress(3)),
-                              database->getResultAsBlob(4)).
+                              database->getResultAsBlob(4, Blob::Borrow)).
                 getContiguousRanges(true);
             
             // Iterate over each thread of this group
@@ -1030,7 +1030,8 @@ ThreadGroup::getExtentsOf(const std::set<VectorInstr>& objects,
 		std::set<AddressRange> ranges = 
 		AddressBitmap(AddressRange(database->getResultAsAddress(2),
 			database->getResultAsAddress(3)),
-			database->getResultAsBlob(4)).getContiguousRanges(true);
+			database->getResultAsBlob(4, Blob::Borrow)).
+		getContiguousRanges(true);
             
 	    // Iterate over each thread of this group
 	    for(ThreadGroup::const_iterator j = begin(); j != end(); ++j) {
@@ -1171,7 +1172,7 @@ ThreadGroup::getExtentsOf(const std::set<Statement>& objects,
 	    std::set<AddressRange> ranges = 
 		AddressBitmap(AddressRange(database->getResultAsAddress(2),
 					   database->getResultAsAddress(3)),
-			      database->getResultAsBlob(4)).
+			      database->getResultAsBlob(4, Blob::Borrow)).
 		getContiguousRanges(true);
 
 	    // Iterate over each thread of this group
@@ -123,7 +123,7 @@ void VectorInstrCache::addLinkedObject(const LinkedObject& linked_object)
         
 	AddressBitmap bitmap(AddressRange(database->getResultAsAddress(2),
 					  database->getResultAsAddress(3)),
-					  database->getResultAsBlob(4));
+			     database->getResultAsBlob(4, Blob::Borrow));
         
 	std::set<AddressRange> ranges = bitmap.getContiguousRanges(true);
         
@@ -48,7 +48,14 @@
 #include <string>
 #include <fstream>
 #include <inttypes.h>
+#include <map>
+#include <set>
 #include <vector>
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
 
 using namespace OpenSpeedShop::Framework;
 using namespace OpenSpeedShop::Watcher;
@@ -66,6 +73,20 @@ struct {
     /** Access-controlled flag used for controling access to the rawdata scan data structures. */
 static pthread_mutex_t RawDataScan_Lock = PTHREAD_MUTEX_INITIALIZER;
 
+#ifdef __linux__
+    /** Inotify instance watching the rawdata directories (-1 when polling). */
+static int rawdata_inotify_fd = -1;
+
+    /** Inotify watch descriptor for the upper level rawdata directory. */
+static int rawdata_parent_wd = -1;
+
+    /** Names of the rawdata sub-directories for each inotify watch descriptor. */
+static std::map<int, std::string> rawdata_watches;
+
+    /** Names of the rawdata sub-directories changed since they were last scanned. */
+static std::set<std::string> rawdata_changed;
+#endif
+
 #ifndef NDEBUG
     /** Flag indicating if debugging for the backend is enabled. */
 bool is_backend_debug_enabled = false;
@@ -473,7 +494,7 @@ void Watcher::scanForRawPerformanceData(pid_t pid_to_monitor, std::string host_t
 				               << std::endl;
 				  }
 #endif
-                                  // If this is the case break out of the main loop because there isn't any new data
+                                  // If this is the case skip to the next file because there isn't any new data
 				  if (prevSize == currentFileSize) {
 				      // Skip processing this file, it is the same size it was before
 #ifndef NDEBUG
@@ -484,14 +505,14 @@ void Watcher::scanForRawPerformanceData(pid_t pid_to_monitor, std::string host_t
 					    << " file is same size as the last time file was saved="
 					    << currentFileSize << std::endl;
 					  std::cerr << output.str ();
-				          std:: cout << "OpenSpeedShop::Watcher::scanForRawPerformanceData() BREAK; prevSize=" 
+				          std:: cout << "OpenSpeedShop::Watcher::scanForRawPerformanceData() CONTINUE; prevSize=" 
                                                      << prevSize << " currentFileSize=" << currentFileSize
 					             << "  FCLOSING FILE dataFilename" << dataFilename 
 				                     << std::endl;
 					} // end debug
 #endif
                                       fclose(f);
-				      break;
+				      continue;
 				    }
 
 			      bool continue_checking_for_data = true;
@@ -667,6 +688,194 @@ void Watcher::scanForRawPerformanceData(pid_t pid_to_monitor, std::string host_t
    return;
 } // end scan for directory and file
 
+#ifdef __linux__
+  /**
+    * Function: getRawDataDirName
+    * Return the name of the upper level directory containing the
+    * rawdata sub-directories, i.e. OPENSS_RAWDATA_DIR or /tmp.
+    */
+static std::string
+getRawDataDirName ()
+{
+  if (getenv("OPENSS_RAWDATA_DIR") != NULL) {
+     return getenv("OPENSS_RAWDATA_DIR");
+  }
+  return "/tmp";
+}
+
+  /**
+    * Function: watchRawDataDirectory
+    * Add an inotify watch for files written into the named rawdata
+    * sub-directory. The directory is marked as changed so that any
+    * data written before the watch was added is picked up by the next scan.
+    */
+static void
+watchRawDataDirectory (const std::string& name)
+{
+  std::string path = getRawDataDirName() + "/" + name;
+
+  int wd = inotify_add_watch (rawdata_inotify_fd, path.c_str(),
+			      IN_ONLYDIR | IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE);
+  if (wd >= 0) {
+    rawdata_watches[wd] = name;
+  }
+  rawdata_changed.insert (name);
+
+#ifndef NDEBUG
+  if (isDebugEnabled ()) {
+      std::stringstream output;
+      output << "[TID " << pthread_self () << "] OpenSpeedShop::Watcher::watchRawDataDirectory()"
+	     << " path=" << path << " wd=" << wd << std::endl;
+      std::cerr << output.str ();
+  }
+#endif
+}
+
+  /**
+    * Function: startRawDataNotification
+    * Create the inotify instance used to wait for new rawdata, watching the
+    * upper level directory for new rawdata sub-directories and each of the
+    * existing ones for new data. Returns false, leaving the monitor thread to
+    * poll, if inotify is unavailable or OPENSS_WATCHER_POLLING is set.
+    */
+static bool
+startRawDataNotification ()
+{
+  if (getenv("OPENSS_WATCHER_POLLING") != NULL) {
+    return false;
+  }
+
+  rawdata_inotify_fd = inotify_init ();
+  if (rawdata_inotify_fd < 0) {
+    return false;
+  }
+  fcntl (rawdata_inotify_fd, F_SETFL,
+	 fcntl (rawdata_inotify_fd, F_GETFL) | O_NONBLOCK);
+  fcntl (rawdata_inotify_fd, F_SETFD, FD_CLOEXEC);
+
+  std::string data_dirname = getRawDataDirName();
+
+  rawdata_parent_wd = inotify_add_watch (rawdata_inotify_fd, data_dirname.c_str(),
+					 IN_ONLYDIR | IN_CREATE | IN_MOVED_TO);
+  if (rawdata_parent_wd < 0) {
+    close (rawdata_inotify_fd);
+    rawdata_inotify_fd = -1;
+    return false;
+  }
+
+  DIR * perfdata_dirhandle = opendir (data_dirname.c_str());
+  if (perfdata_dirhandle) {
+    struct dirent * perfdata_direntry;
+    while ((perfdata_direntry = readdir (perfdata_dirhandle)) != NULL) {
+      if (strstr (perfdata_direntry->d_name, "openss-rawdata-")) {
+	watchRawDataDirectory (perfdata_direntry->d_name);
+      }
+    }
+    closedir (perfdata_dirhandle);
+  }
+
+  return true;
+}
+
+  /**
+    * Function: stopRawDataNotification
+    * Close the inotify instance and forget all of its watches.
+    */
+static void
+stopRawDataNotification ()
+{
+  if (rawdata_inotify_fd >= 0) {
+    close (rawdata_inotify_fd);
+  }
+  rawdata_inotify_fd = -1;
+  rawdata_parent_wd = -1;
+  rawdata_watches.clear();
+  rawdata_changed.clear();
+}
+
+  /**
+    * Function: waitForRawDataChanges
+    * Wait up to two seconds for inotify events and record which rawdata
+    * sub-directories had data written into them. New rawdata sub-directories
+    * are watched as they appear.
+    */
+static void
+waitForRawDataChanges ()
+{
+  struct pollfd pfd;
+  pfd.fd = rawdata_inotify_fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  if ((poll (&pfd, 1, 2000) <= 0) || !(pfd.revents & POLLIN)) {
+    return;
+  }
+
+  char buffer[4096] __attribute__ ((aligned (__alignof__ (struct inotify_event))));
+
+  for (;;) {
+    ssize_t length = read (rawdata_inotify_fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+
+    for (char * ptr = buffer; ptr < buffer + length;
+	 ptr += sizeof(struct inotify_event) + reinterpret_cast<struct inotify_event *>(ptr)->len) {
+      const struct inotify_event * event = reinterpret_cast<const struct inotify_event *>(ptr);
+
+      // Events were lost, so conservatively rescan every rawdata sub-directory
+      if (event->mask & IN_Q_OVERFLOW) {
+	for (std::map<int, std::string>::const_iterator i = rawdata_watches.begin();
+	     i != rawdata_watches.end(); ++i) {
+	  rawdata_changed.insert (i->second);
+	}
+	continue;
+      }
+
+      if (event->wd == rawdata_parent_wd) {
+	if ((event->mask & IN_ISDIR) && (event->len > 0) &&
+	    strstr (event->name, "openss-rawdata-")) {
+	  watchRawDataDirectory (event->name);
+	}
+	continue;
+      }
+
+      std::map<int, std::string>::iterator i = rawdata_watches.find (event->wd);
+      if (i == rawdata_watches.end()) {
+	continue;
+      }
+      if (event->mask & IN_IGNORED) {
+	rawdata_watches.erase (i);
+	continue;
+      }
+      if ((event->len == 0) || strstr (event->name, ".openss-data")) {
+	rawdata_changed.insert (i->second);
+      }
+    }
+  }
+}
+
+  /**
+    * Function: isRawDataChanged
+    * Test if any changed rawdata sub-directory could hold data for the given
+    * pid and host, matching the names just as scanForRawPerformanceData() does.
+    */
+static bool
+isRawDataChanged (pid_t pid, const std::string& host)
+{
+  char openssDataDirName[1024];
+  sprintf (openssDataDirName, "openss-rawdata-%s-%d", host.c_str(), pid);
+
+  for (std::set<std::string>::const_iterator i = rawdata_changed.begin();
+       i != rawdata_changed.end(); ++i) {
+    if (strstr (i->c_str(), openssDataDirName)) {
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
   /**
     * Watcher thread routine to monitor the fileIO files for data.
     *
@@ -712,6 +921,25 @@ OpenSpeedShop::Watcher::fileIOmonitorThread (void *)
     }
 #endif
 
+  // Wait for rawdata to be written using inotify when possible,
+  // otherwise fall back to polling the rawdata directories
+#ifdef __linux__
+  bool use_notification = startRawDataNotification ();
+#else
+  bool use_notification = false;
+#endif
+
+#ifndef NDEBUG
+  if (isDebugEnabled ())
+    {
+      std::stringstream output;
+      output << "[TID " << pthread_self () 
+             << "] OpenSpeedShop::Watcher::fileIOmonitorThread()" 
+             << " use_notification=" << use_notification << std::endl;
+      std::cerr << output.str ();
+    }
+#endif
+
   // Run the fileIO monitoring until instructed to exit
   for (bool do_exit = false; !do_exit;)
     {
@@ -725,10 +953,18 @@ OpenSpeedShop::Watcher::fileIOmonitorThread (void *)
 	}
 #endif
 
-      // Suspend ourselves for two seconds
-      wait.tv_sec = 2;
-      wait.tv_nsec = 0;
-      nanosleep (&wait, NULL);
+#ifdef __linux__
+      if (use_notification) {
+	// Wait up to two seconds for rawdata to be written
+	waitForRawDataChanges ();
+      } else
+#endif
+      {
+	// Suspend ourselves for two seconds
+	wait.tv_sec = 2;
+	wait.tv_nsec = 0;
+	nanosleep (&wait, NULL);
+      }
 
       // Acquire lock for the scan for rawdata files
       // This lock is competing with similiar code in watchProcess()
@@ -783,6 +1019,16 @@ OpenSpeedShop::Watcher::fileIOmonitorThread (void *)
          std::string tmp_str =  ph->second.second;
          int dot_loc = ph->second.second.find('.');
          std::string new_tmp_str = tmp_str.substr (0,dot_loc);
+
+#ifdef __linux__
+         // Only scan when data was written for this process since the last scan
+         //
+         if (use_notification &&
+             !isRawDataChanged(ph->first, ph->second.second) &&
+             !isRawDataChanged(ph->first, new_tmp_str)) {
+            continue;
+         }
+#endif
        
          // First scan the main directory for sub-directories using the canonical name
          //
@@ -796,6 +1042,10 @@ OpenSpeedShop::Watcher::fileIOmonitorThread (void *)
 
     }
 
+#ifdef __linux__
+    // Changes for processes that are no longer active are not of interest
+    rawdata_changed.clear();
+#endif
 
     // Release the scan lock so the code in watchProcess() can have it, if needed
     //
@@ -824,6 +1074,10 @@ OpenSpeedShop::Watcher::fileIOmonitorThread (void *)
 
     }
 
+#ifdef __linux__
+  stopRawDataNotification ();
+#endif
+
   // Empty, unused, return value from this thread
   return NULL;
 }
@@ -23,6 +23,7 @@
 #include <boost/cstdint.hpp>
 #include <boost/ref.hpp>
 #include <cstring>
+#include <vector>
 
 #include <ArgoNavis/Base/AddressVisitor.hpp>
 #include <ArgoNavis/Base/ThreadVisitor.hpp>
@@ -56,6 +57,10 @@ using namespace std;
 /** Anonymous namespace hiding implementation details. */
 namespace {
 
+    /** Maximum number of blobs decoded concurrently. */
+    const vector<Blob>::size_type kMaxDecodeBatchSize = 64;
+
+
     /** Visitor used to accumulate the total event time. */
     template <typename T>
     bool accumulateEventTime(const T& details,
@@ -117,6 +122,42 @@ namespace {
         return true; // Always continue the visitation
     }
 
+    /**
+     * Decode a batch of blobs containing CUDA performance data, adding them to
+     * the specified ArgoNavis::CUDA::PerformanceData object. The blobs are
+     * decoded concurrently but are always applied in their original order.
+     * The batch is emptied afterwards.
+     */
+    void applyBatch(const Base::ThreadName& name, vector<Blob>& blobs,
+                    CUDA::PerformanceData& data)
+    {
+        vector<CBTF_cuda_data> messages(blobs.size());
+        if (!messages.empty())
+        {
+            memset(&messages[0], 0, messages.size() * sizeof(CBTF_cuda_data));
+        }
+
+#ifdef HAVE_OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (int i = 0; i < static_cast<int>(blobs.size()); ++i)
+        {
+            blobs[i].getXDRDecoding(
+                reinterpret_cast<xdrproc_t>(xdr_CBTF_cuda_data), &messages[i]
+                );
+        }
+
+        for (vector<CBTF_cuda_data>::size_type i = 0; i < messages.size(); ++i)
+        {
+            data.apply(name, messages[i]);
+
+            xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_cuda_data),
+                     reinterpret_cast<char*>(&messages[i]));
+        }
+
+        blobs.clear();
+    }
+
     /** Visitor used to insert an address into a buffer of unique addresses. */
     bool insertIntoAddressBuffer(Base::Address address, PCBuffer& buffer)
     {
@@ -289,6 +330,9 @@ void Queries::GetCUDAPerformanceData(const Collector& collector,
     Assert(collector.inSameDatabase(thread));
 
     Base::ThreadName name = ConvertToArgoNavis(thread);
+
+    vector<Blob> blobs;
+    blobs.reserve(kMaxDecodeBatchSize);
     
     SmartPtr<Database> database = EntrySpy(collector).getDatabase();
     
@@ -300,19 +344,16 @@ void Queries::GetCUDAPerformanceData(const Collector& collector,
     database->bindArgument(2, EntrySpy(thread).getEntry());
     while (database->executeStatement())
     {
-        CBTF_cuda_data message;
-        memset(&message, 0, sizeof(message));
-
         Blob blob = database->getResultAsBlob(1);
-        blob.getXDRDecoding(
-            reinterpret_cast<xdrproc_t>(xdr_CBTF_cuda_data), &message
-            );
-    
-        data.apply(name, message);
+        blobs.push_back(Blob());
+        blobs.back().swap(blob);
 
-        xdr_free(reinterpret_cast<xdrproc_t>(xdr_CBTF_cuda_data),
-                 reinterpret_cast<char*>(&message));
+        if (blobs.size() == kMaxDecodeBatchSize)
+        {
+            applyBatch(name, blobs, data);
+        }
     }
+    applyBatch(name, blobs, data);
     END_TRANSACTION(database);
 }
 
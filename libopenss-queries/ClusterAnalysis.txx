@@ -28,6 +28,9 @@
 #include "Queries.hxx"
 #include "ToolAPI.hxx"
 
+#include <algorithm>
+#include <vector>
+
 
 
 //
@@ -49,41 +52,6 @@ namespace OpenSpeedShop {
 
 
 
-/**
- * Average inter-cluster distance.
- *
- * Compute the average inter-cluster distance for the specified distance matrix
- * and cluster.
- *
- * @param distances    Distance matrix.
- * @param cluster      Cluster for which to compute the distance.
- * @return             Average inter-cluster distance.
- */
-namespace Queries { namespace ClusterAnalysis {
-template <typename TS, typename TM>
-TM AverageInterClusterDistance(
-    const DistanceMatrix<TS, TM >& distances,
-    const Framework::ThreadGroup& cluster)
-{
-    Assert(!cluster.empty());
-    unsigned n = 0;
-    TM value = TM();
-    for(Framework::ThreadGroup::const_iterator
-	    i = cluster.begin(); i != cluster.end(); ++i) {
-	Framework::ThreadGroup::const_iterator j = i; 
-	++j;
-	while(j != cluster.end()) {
-	    n++;
-	    value += distances.getDistance(*i, *j);
-	    ++j;
-	}
-    }
-    return value / n;
-}
-} }
-
-
-
 /**
  * Manhattan individual distance measure.
  *
@@ -137,10 +105,12 @@ TM Queries::ClusterAnalysis::ManhattanDistance(
  * individual metric results and distance measure. The list of unique threads
  * and actual distances and then be queried via member functions.
  *
- * @note    Internally the distances aren't stored in an actual matrix but
- *          rather in a mapping of the thread pair to their distance. Doing
- *          this facilitates computing and storing the distances for the
- *          unique thread pairings only.
+ * @note    Internally the distances are stored in a condensed matrix. I.e. a
+ *          single contiguous array holding the upper triangle of the actual
+ *          matrix, one row after another. Doing this facilitates computing and
+ *          storing the distances for the unique thread pairings only, while
+ *          still allowing constant time access to each distance. Threads are
+ *          numbered in the order they appear within the thread group.
  *
  * @sa    http://en.wikipedia.org/wiki/Distance_matrix
  */
@@ -156,6 +126,8 @@ public:
 	TM (*distance)(const std::map<TS, std::map<Framework::Thread, TM > >&,
 		       const Framework::Thread&, const Framework::Thread&)) :
 	dm_threads(),
+	dm_ordered(),
+	dm_indices(),
 	dm_table()
     {
 	// Build a thread group containing each thread
@@ -165,23 +137,56 @@ public:
 	    for(typename std::map<Framework::Thread, TM >::const_iterator
 		    j = i->second.begin(); j != i->second.end(); ++j)
 		dm_threads.insert(j->first);
-	
-	// Compute distances between each unique pairing of threads
+
+	// Number each thread
 	for(Framework::ThreadGroup::const_iterator
 		i = dm_threads.begin(); i != dm_threads.end(); ++i) {
-	    Framework::ThreadGroup::const_iterator j = i; 
-	    ++j;
-	    while(j != dm_threads.end()) {
-		dm_table.insert(
-		    std::make_pair((*i < *j) ? 
-				   std::make_pair(*i, *j) : 
-				   std::make_pair(*j, *i),
-				   (*distance)(individual, *i, *j)
-			)
-		    );
-		++j;
-	    }
+	    dm_indices.insert(std::make_pair(*i, dm_ordered.size()));
+	    dm_ordered.push_back(*i);
+	}
+	unsigned n = dm_ordered.size();
+	if(n < 2)
+	    return;
+	dm_table.resize((static_cast<typename std::vector<TM>::size_type>(n) *
+			 (n - 1)) / 2);
+
+	// Use a dense copy of the individual results for the manhattan
+	// distance when it is small enough, avoiding the per-pair lookups
+	typename std::vector<TM>::size_type dense_size = individual.size() * n;
+	if((distance == &ManhattanDistance<TS, TM>) &&
+	   (dense_size <= MaxDenseValues)) {
+
+	    // Copy the metric values for each thread into a single row
+	    std::vector<TM> values(dense_size, TM());
+	    unsigned s = 0;
+	    for(typename std::map<TS, std::map<Framework::Thread, TM > >::
+		    const_iterator 
+		    i = individual.begin(); i != individual.end(); ++i, ++s)
+		for(typename std::map<Framework::Thread, TM >::const_iterator
+			j = i->second.begin(); j != i->second.end(); ++j)
+		    values[dm_indices[j->first] * individual.size() + s] =
+			j->second;
+
+	    // Compute distances between each unique pairing of threads
+	    for(unsigned i = 0; i < n; ++i)
+		for(unsigned j = i + 1; j < n; ++j) {
+		    const TM* first = &values[i * individual.size()];
+		    const TM* second = &values[j * individual.size()];
+		    TM value = TM();
+		    for(unsigned k = 0; k < individual.size(); ++k)
+			value += (first[k] < second[k]) ?
+			    (second[k] - first[k]) : (first[k] - second[k]);
+		    dm_table[getIndex(i, j)] = value;
+		}
+
+	    return;
 	}
+	
+	// Compute distances between each unique pairing of threads
+	for(unsigned i = 0; i < n; ++i)
+	    for(unsigned j = i + 1; j < n; ++j)
+		dm_table[getIndex(i, j)] =
+		    (*distance)(individual, dm_ordered[i], dm_ordered[j]);
     }
 
     /** Read-only data member accessor function. */
@@ -189,6 +194,25 @@ public:
     {
 	return dm_threads;
     }
+
+    /** Get the number of threads. */
+    unsigned getSize() const
+    {
+	return dm_ordered.size();
+    }
+
+    /** Get the thread with the given number. */
+    const Framework::Thread& getThread(const unsigned& i) const
+    {
+	Assert(i < dm_ordered.size());
+	return dm_ordered[i];
+    }
+
+    /** Read-only data member accessor function. */
+    const std::vector<TM>& getTable() const
+    {
+	return dm_table;
+    }
     
     /** Get the distance between two threads. */
     TM getDistance(const Framework::Thread& first, 
@@ -196,21 +220,51 @@ public:
     {
 	if(first == second)
 	    return TM();
-	typename std::map<std::pair<Framework::Thread, Framework::Thread>, TM >
-	    ::const_iterator i = dm_table.find((first < second) ? 
-					       std::make_pair(first, second) :
-					       std::make_pair(second, first));
-	Assert(i != dm_table.end());
-	return i->second;
+	typename std::map<Framework::Thread, unsigned>::const_iterator
+	    i = dm_indices.find(first);
+	typename std::map<Framework::Thread, unsigned>::const_iterator
+	    j = dm_indices.find(second);
+	Assert((i != dm_indices.end()) && (j != dm_indices.end()));
+	return dm_table[getIndex(i->second, j->second)];
+    }
+
+    /** Get the distance between two numbered threads. */
+    TM getDistance(const unsigned& first, const unsigned& second) const
+    {
+	if(first == second)
+	    return TM();
+	return dm_table[getIndex(first, second)];
+    }
+
+    /** Get the condensed table index of two (different) numbered threads. */
+    typename std::vector<TM>::size_type getIndex(unsigned first,
+						 unsigned second) const
+    {
+	Assert(first != second);
+	if(first > second)
+	    std::swap(first, second);
+	typename std::vector<TM>::size_type i = first;
+	return (i * dm_ordered.size()) - ((i * (i + 1)) / 2) +
+	    (second - first - 1);
     }
 
 private:
 
     /** Thread group containing each thread in the original data set. */
     Framework::ThreadGroup dm_threads;
+
+    /** Each thread in the original data set, in numbered order. */
+    std::vector<Framework::Thread> dm_ordered;
+
+    /** Number of each thread in the original data set. */
+    std::map<Framework::Thread, unsigned> dm_indices;
     
-    /** Table of distances between each unique pairing of threads. */
-    std::map<std::pair<Framework::Thread, Framework::Thread>, TM > dm_table;
+    /** Condensed table of distances between each unique pairing of threads. */
+    std::vector<TM> dm_table;
+
+    /** Maximum number of values copied for the dense manhattan distance. */
+    static const typename std::vector<TM>::size_type MaxDenseValues =
+	16 * 1024 * 1024;
     
 };
 
@@ -329,7 +383,7 @@ TM Queries::ClusterAnalysis::AverageLinkageDistance(
  * object construction).
  *
  * @param distances    Distance matrix.
- * @param clusters     All clusters of threads.
+ * @param clusters     Number of clusters of threads.
  * @param distance     Distance between the minimium distance pair.
  * @param first        First cluster in the minimum distance pair.
  * @param second       Second cluster in the minimum distance pair.
@@ -339,12 +393,12 @@ TM Queries::ClusterAnalysis::AverageLinkageDistance(
 template <typename TS, typename TM>
 bool Queries::ClusterAnalysis::NumberCriterion1<TS, TM >::operator()(
     const DistanceMatrix<TS, TM >& distances,
-    const std::set<Framework::ThreadGroup>& clusters,
+    const unsigned& clusters,
     const TM& distance,
-    const Framework::ThreadGroup& first,
-    const Framework::ThreadGroup& second) const
+    const ClusterStatistics<TM>& first,
+    const ClusterStatistics<TM>& second) const
 {
-    return dm_count >= clusters.size();
+    return dm_count >= clusters;
 }
 
 
@@ -358,7 +412,7 @@ bool Queries::ClusterAnalysis::NumberCriterion1<TS, TM >::operator()(
  * constant value (specified at object construction).
  *
  * @param distances    Distance matrix.
- * @param clusters     All clusters of threads.
+ * @param clusters     Number of clusters of threads.
  * @param distance     Distance between the minimium distance pair.
  * @param first        First cluster in the minimum distance pair.
  * @param second       Second cluster in the minimum distance pair.
@@ -367,35 +421,271 @@ bool Queries::ClusterAnalysis::NumberCriterion1<TS, TM >::operator()(
  */
 template <typename TS, typename TM>
 bool Queries::ClusterAnalysis::DistanceCriterion1<TS, TM >::operator()(
-    const DistanceMatrix<TS, TM >& distances,
-    const std::set<Framework::ThreadGroup>& clusters,
+    const DistanceMatrix<TS, TM >& /* distances */,
+    const unsigned& clusters,
     const TM& distance,
-    const Framework::ThreadGroup& first,
-    const Framework::ThreadGroup& second) const
+    const ClusterStatistics<TM>& first,
+    const ClusterStatistics<TM>& second) const
 {
     // Handle special case where both clusters contain a single thread
-    if((first.size() < 2) && (second.size() < 2))
+    if((first.dm_size < 2) && (second.dm_size < 2))
 	return false;
 
     // Handle special case where only one cluster contains a single thread
-    if((first.size() < 2) && (second.size() >= 2))
+    if((first.dm_size < 2) && (second.dm_size >= 2))
 	return dm_ratio <= 
 	    (static_cast<double>(distance) / static_cast<double>(
-		AverageInterClusterDistance(distances, second)));
-    if((first.size() >= 2) && (second.size() < 2))
+		second.getAverageDistance()));
+    if((first.dm_size >= 2) && (second.dm_size < 2))
 	return dm_ratio <= 
 	    (static_cast<double>(distance) / static_cast<double>( 
-		AverageInterClusterDistance(distances, first)));
+		first.getAverageDistance()));
 
     // Handle default case where both clusters have more than one thread
     return dm_ratio <= 
 	(static_cast<double>(distance) / static_cast<double>(
-	    std::max(AverageInterClusterDistance(distances, first),
-		     AverageInterClusterDistance(distances, second))));
+	    std::max(first.getAverageDistance(),
+		     second.getAverageDistance())));
 }
 
 
 
+/**
+ * Merge of two clusters.
+ *
+ * Records the merge of two clusters during agglomerative hierarchical
+ * clustering. Each cluster is identified by the number of any one thread
+ * it contains. Merges are ordered by their distance.
+ */
+namespace Queries { namespace ClusterAnalysis {
+template <typename TM>
+struct ClusterMerge
+{
+    /** Number of a thread in the first cluster. */
+    unsigned dm_first;
+
+    /** Number of a thread in the second cluster. */
+    unsigned dm_second;
+
+    /** Distance between the two clusters. */
+    TM dm_distance;
+
+    /** Constructor from fields. */
+    ClusterMerge(const unsigned& first, const unsigned& second,
+		 const TM& distance) :
+	dm_first(first),
+	dm_second(second),
+	dm_distance(distance)
+    {
+    }
+
+    /** Operator "<" defined for two ClusterMerge objects. */
+    bool operator<(const ClusterMerge& other) const
+    {
+	return dm_distance < other.dm_distance;
+    }
+};
+} }
+
+
+
+/**
+ * Cluster distance measures with Lance-Williams updates.
+ *
+ * Enumeration of the cluster distance measures for which the distance to a
+ * merged cluster can be computed from the distances to its two components.
+ */
+namespace Queries { namespace ClusterAnalysis {
+enum LinkageMethod { SingleLinkage, CompleteLinkage, AverageLinkage };
+} }
+
+
+
+/**
+ * Nearest-neighbor chain clustering.
+ *
+ * Computes the complete sequence of merges performed by agglomerative
+ * hierarchical clustering of the specified distance matrix using one of the
+ * cluster distance measures supporting Lance-Williams updates. Each of those
+ * measures is reducible, so following chains of nearest neighbors until two
+ * clusters are each other's nearest neighbor finds the same merges as always
+ * merging the closest pair, but in O(n^2) rather than O(n^3) time. The merges
+ * aren't found in order of increasing distance, so they are sorted into that
+ * order (the order in which they would be performed) before being returned.
+ *
+ * @note    The distances between clusters are kept in a condensed table that
+ *          is updated in place as clusters are merged. For average linkage
+ *          this table holds the sum, rather than the average, of the distances
+ *          between the two clusters so that the averages are computed exactly
+ *          as AverageLinkageDistance() does. It is a copy of the distance
+ *          matrix's table, not the table itself, because Apply() still needs
+ *          the original distances between individual threads afterwards to
+ *          compute the statistics of each cluster as the merges are replayed.
+ *
+ * @sa    http://en.wikipedia.org/wiki/Nearest-neighbor_chain_algorithm
+ *
+ * @param distances    Distance matrix.
+ * @param method       Cluster distance measure to be used.
+ * @param merges       Merges of the clusters.
+ */
+namespace Queries { namespace ClusterAnalysis {
+template <typename TS, typename TM>
+void NearestNeighborChain(const DistanceMatrix<TS, TM >& distances,
+			  const LinkageMethod& method,
+			  std::vector<ClusterMerge<TM> >& merges)
+{
+    unsigned n = distances.getSize();
+    std::vector<TM> table(distances.getTable());
+    std::vector<Framework::ThreadGroup::size_type> sizes(n, 1);
+    std::vector<bool> is_active(n, true);
+    std::vector<unsigned> chain;
+    unsigned first_active = 0;
+
+    while((merges.size() + 1) < n) {
+
+	// Start a new chain at any active cluster when necessary
+	if(chain.empty()) {
+	    while(!is_active[first_active])
+		++first_active;
+	    chain.push_back(first_active);
+	}
+
+	// Follow nearest neighbors until two clusters are mutual neighbors
+	unsigned a = 0, b = 0;
+	TM distance = TM();
+	while(true) {
+	    a = chain.back();
+
+	    // Prefer the previous cluster in the chain when there are ties
+	    bool is_initialized = chain.size() > 1;
+	    b = is_initialized ? chain[chain.size() - 2] : a;
+	    if(is_initialized) {
+		distance = table[distances.getIndex(a, b)];
+		if(method == AverageLinkage)
+		    distance = distance / (sizes[a] * sizes[b]);
+	    }
+
+	    // Find the nearest neighbor of the cluster at the chain's end
+	    for(unsigned c = 0; c < n; ++c) {
+		if((c == a) || !is_active[c])
+		    continue;
+		TM d = table[distances.getIndex(a, c)];
+		if(method == AverageLinkage)
+		    d = d / (sizes[a] * sizes[c]);
+		if(!is_initialized || (d < distance)) {
+		    is_initialized = true;
+		    distance = d;
+		    b = c;
+		}
+	    }
+
+	    if((chain.size() > 1) && (b == chain[chain.size() - 2]))
+		break;
+	    chain.push_back(b);
+	}
+	chain.pop_back();
+	chain.pop_back();
+	merges.push_back(ClusterMerge<TM>(a, b, distance));
+
+	// Update the distances to the merged cluster (kept as cluster "b")
+	for(unsigned c = 0; c < n; ++c) {
+	    if((c == a) || (c == b) || !is_active[c])
+		continue;
+	    TM& bc = table[distances.getIndex(b, c)];
+	    const TM& ac = table[distances.getIndex(a, c)];
+	    switch(method) {
+	    case SingleLinkage:
+		bc = std::min(ac, bc);
+		break;
+	    case CompleteLinkage:
+		bc = std::max(ac, bc);
+		break;
+	    case AverageLinkage:
+		bc += ac;
+		break;
+	    }
+	}
+	is_active[a] = false;
+	sizes[b] += sizes[a];
+
+    }
+
+    // Sort the merges into the order they would be performed
+    std::stable_sort(merges.begin(), merges.end());
+}
+} }
+
+
+
+/**
+ * Greedy clustering.
+ *
+ * Computes the sequence of merges performed by agglomerative hierarchical
+ * clustering of the specified distance matrix by repeatedly merging the two
+ * closest clusters. Used for arbitrary cluster distance measures, for which
+ * nearest-neighbor chain clustering isn't known to be valid. The merges are
+ * found in the order they are performed.
+ *
+ * @param distances    Distance matrix.
+ * @param cdistance    Pointer to the cluster distance measure to be used.
+ * @param merges       Merges of the clusters.
+ */
+namespace Queries { namespace ClusterAnalysis {
+template <typename TS, typename TM>
+void GreedyClustering(const DistanceMatrix<TS, TM >& distances,
+		      TM (*cdistance)(const DistanceMatrix<TS, TM >&, 
+				      const Framework::ThreadGroup&,
+				      const Framework::ThreadGroup&),
+		      std::vector<ClusterMerge<TM> >& merges)
+{
+    // Construct a cluster for each thread
+    std::vector<Framework::ThreadGroup> clusters;
+    std::vector<unsigned> active;
+    for(unsigned i = 0; i < distances.getSize(); ++i) {
+	clusters.push_back(MakeThreadGroup(distances.getThread(i)));
+	active.push_back(i);
+    }
+
+    // Iterate while there is still more than one cluster
+    while(active.size() > 1) {
+
+	// Variables holding the minimum distance between any two clusters
+	bool is_initialized = false;
+	TM distance = TM();
+	unsigned first = 0, second = 0;
+
+	// Iterate over each unique pairing of clusters
+	for(unsigned i = 0; i < active.size(); ++i)
+	    for(unsigned j = i + 1; j < active.size(); ++j) {
+
+		// Compute the distance between these two clusters
+		TM d = (*cdistance)(distances, clusters[active[i]],
+				    clusters[active[j]]);
+
+		// Replace the existing minimum if this distance is less
+		if(!is_initialized || (d < distance)) {
+		    is_initialized = true;
+		    distance = d;
+		    first = i;
+		    second = j;
+		}
+
+	    }
+	merges.push_back(ClusterMerge<TM>(active[first], active[second],
+					  distance));
+
+	// Replace the two original clusters with their union
+	clusters[active[first]].insert(clusters[active[second]].begin(),
+				       clusters[active[second]].end());
+	Framework::ThreadGroup().swap(clusters[active[second]]);
+	active.erase(active.begin() + second);
+
+    }
+}
+} }
+
+
+
 /**
  * Apply cluster analysis.
  *
@@ -405,6 +695,13 @@ bool Queries::ClusterAnalysis::DistanceCriterion1<TS, TM >::operator()(
  * one cluster left, or the specified termination criterion is met. Results
  * are returned as a set of thread groups.
  *
+ * @note    The merges are found using nearest-neighbor chain clustering when
+ *          the cluster distance measure is one of the single, complete, or
+ *          average linkage distances, and by greedy clustering otherwise.
+ *          They are then performed in order, tracking each cluster by its
+ *          thread numbers rather than a thread group, until the termination
+ *          criterion is met.
+ *
  * @pre    The specified individual metric results smart pointer must be valid.
  *         An assertion failure occurs if this pointer is null.
  *
@@ -442,49 +739,47 @@ std::set<Framework::ThreadGroup> Queries::ClusterAnalysis::Apply(
 
     // Compute the matrix of individual distances
     DistanceMatrix<TS, TM > distances(*individual, idistance);
+    unsigned n = distances.getSize();
+
+    // Compute the merges, in the order they are to be performed
+    std::vector<ClusterMerge<TM> > merges;
+    if(cdistance == &SingleLinkageDistance<TS, TM>)
+	NearestNeighborChain(distances, SingleLinkage, merges);
+    else if(cdistance == &CompleteLinkageDistance<TS, TM>)
+	NearestNeighborChain(distances, CompleteLinkage, merges);
+    else if(cdistance == &AverageLinkageDistance<TS, TM>)
+	NearestNeighborChain(distances, AverageLinkage, merges);
+    else
+	GreedyClustering(distances, cdistance, merges);
 
     // Construct a cluster for each thread in the individual results
-    Framework::ThreadGroup threads = distances.getThreads();
-    for(Framework::ThreadGroup::const_iterator
-	    i = threads.begin(); i != threads.end(); ++i)
-	clusters.insert(MakeThreadGroup(*i));
-
-    // Iterate while there is still more than one cluster
-    while(clusters.size() > 1) {
-
-	// Variables holding the minimum distance between any two clusters
-	bool is_initialized = false;
-	TM distance = TM();
-	std::set<Framework::ThreadGroup>::iterator first = clusters.end();
-	std::set<Framework::ThreadGroup>::iterator second = clusters.end();
-	
-	// Iterate over each unique pairing of clusters
-	for(std::set<Framework::ThreadGroup>::const_iterator
-		i = clusters.begin(); i != clusters.end(); ++i) {
-	    std::set<Framework::ThreadGroup>::const_iterator j = i;
-	    ++j;
-	    while(j != clusters.end()) {
+    std::vector<unsigned> parents(n);
+    std::vector<std::vector<unsigned> > members(n);
+    std::vector<ClusterStatistics<TM> > statistics(n);
+    for(unsigned i = 0; i < n; ++i) {
+	parents[i] = i;
+	members[i].push_back(i);
+    }
+    unsigned count = n;
 
-		// Compute the distance between these two clusters
-		TM d = (*cdistance)(distances, *i, *j);
+    // Iterate over the merges while there is still more than one cluster
+    for(typename std::vector<ClusterMerge<TM> >::const_iterator
+	    i = merges.begin(); i != merges.end(); ++i) {
 
-		// Replace the existing minimum if this distance is less
-		if(!is_initialized || (d < distance)) {
-		    is_initialized = true;
-		    distance = d;
-		    first = i;
-		    second = j;
-		}
-		
-		++j;
-	    }	   
-	}
+	// Find the clusters currently containing the merged threads
+	unsigned first = i->dm_first;
+	while(parents[first] != first)
+	    first = parents[first] = parents[parents[first]];
+	unsigned second = i->dm_second;
+	while(parents[second] != second)
+	    second = parents[second] = parents[parents[second]];
 
 	// Check assertions
-	Assert((first != clusters.end()) && (second != clusters.end()));
+	Assert(first != second);
 
 	// Has the termination criterion been met?
-	if(criterion(distances, clusters, distance, *first, *second)) {
+	if(criterion(distances, count, i->dm_distance,
+		     statistics[first], statistics[second])) {
 	    // Have we reduced the number of clusters to a reasonbly small number yet?
 	    // This needs to be something the user can change.  In some cases
 	    // we hit the criterion very early and are left with many clusters.
@@ -492,21 +787,40 @@ std::set<Framework::ThreadGroup> Queries::ClusterAnalysis::Apply(
 	    // may be an outlier but our current view code will print all the clusters.
 	    // For a large scale job, that could mean printing 1000's of cluster data.
 	    // The line below just says continue cluster reduction down to at most 4.
-	    if (clusters.size() < 5) {
+	    if (count < 5) {
 	        break;
 	    }
 	}
-	
+
 	// Replace the two original clusters with their union
-	Framework::ThreadGroup temp;
-	temp.insert(first->begin(), first->end());
-	temp.insert(second->begin(), second->end());
-	clusters.erase(first);
-	clusters.erase(second);
-	clusters.insert(temp);
-	
+	if(members[first].size() < members[second].size())
+	    std::swap(first, second);
+	TM sum = TM();
+	for(std::vector<unsigned>::const_iterator
+		j = members[first].begin(); j != members[first].end(); ++j)
+	    for(std::vector<unsigned>::const_iterator
+		    k = members[second].begin(); k != members[second].end(); ++k)
+		sum += distances.getDistance(*j, *k);
+	statistics[first].dm_size += statistics[second].dm_size;
+	statistics[first].dm_sum += statistics[second].dm_sum + sum;
+	members[first].insert(members[first].end(),
+			      members[second].begin(), members[second].end());
+	std::vector<unsigned>().swap(members[second]);
+	parents[second] = first;
+	count--;
+
     }
 
+    // Build a thread group for each remaining cluster
+    for(unsigned i = 0; i < n; ++i)
+	if(parents[i] == i) {
+	    Framework::ThreadGroup cluster;
+	    for(std::vector<unsigned>::const_iterator
+		    j = members[i].begin(); j != members[i].end(); ++j)
+		cluster.insert(distances.getThread(*j));
+	    clusters.insert(cluster);
+	}
+
     // Return the clusters to the caller
     return clusters;
 }
@@ -29,6 +29,10 @@
 #include "Queries.hxx"
 #include "ToolAPI.hxx"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #ifdef HAVE_OPENMP
 #include <omp.h>
 #endif
@@ -54,6 +58,136 @@ namespace OpenSpeedShop {
 
 
 
+#ifdef HAVE_OPENMP
+/**
+ * Evaluation of metric values.
+ *
+ * Structure describing a single unit of work performed by GetMetricValues()
+ * when evaluating metric values in parallel: the evaluation of some, or all,
+ * of the performance data blobs of a single thread. Only the non-empty metric
+ * values are kept once the evaluation is complete.
+ */
+namespace Queries {
+template <typename TM>
+struct MetricValuesEvaluation
+{
+    /** Thread being evaluated. */
+    Framework::Thread dm_thread;
+
+    /** Extents of the source objects in that thread. */
+    const Framework::ExtentGroup* dm_extents;
+
+    /** Identifiers of the performance data blobs to be evaluated. */
+    std::vector<int> dm_identifiers;
+
+    /** Evaluated non-empty metric values and their extent's index. */
+    std::vector<std::pair<Framework::ExtentGroup::size_type, TM > > dm_values;
+
+    /** Constructor from a thread and its extents. */
+    MetricValuesEvaluation(const Framework::Thread& thread,
+			   const Framework::ExtentGroup& extents) :
+	dm_thread(thread),
+	dm_extents(&extents),
+	dm_identifiers(),
+	dm_values()
+    {
+    }
+};
+}
+#endif
+
+
+
+/**
+ * Aggregate metric values.
+ *
+ * Only metrics of type double can be computed from the collector's persistent
+ * metric aggregates. Metric values of any other type never are.
+ *
+ * @return    Boolean "false" (the values cannot be aggregated).
+ */
+namespace Queries {
+template <typename TM>
+bool AggregateMetricValues(const Framework::Collector&,
+			   const std::string&,
+			   const Framework::Thread&)
+{
+    return false;
+}
+}
+
+
+
+/**
+ * Aggregate metric values.
+ *
+ * Updates the collector's persistent metric aggregates for metrics of type
+ * double when the metric can be aggregated. Must be called before the database
+ * is locked.
+ *
+ * @param collector    Collector for which to aggregate a metric.
+ * @param metric       Unique identifier of the metric.
+ * @param thread       Thread for which to aggregate metric values.
+ * @return             Boolean "true" if the values can be computed from the
+ *                     aggregates, "false" otherwise.
+ */
+namespace Queries {
+template <>
+inline bool AggregateMetricValues<double>(const Framework::Collector& collector,
+					  const std::string& metric,
+					  const Framework::Thread& thread)
+{
+    return collector.aggregateMetricValues(metric, thread);
+}
+}
+
+
+
+/**
+ * Get aggregated metric values.
+ *
+ * Only metrics of type double can be computed from the collector's persistent
+ * metric aggregates, so this is never called for any other type.
+ */
+namespace Queries {
+template <typename TM>
+void GetAggregatedMetricValues(const Framework::Collector&,
+			       const std::string&,
+			       const Framework::Thread&,
+			       const Framework::ExtentGroup&,
+			       std::vector<TM >&)
+{
+}
+}
+
+
+
+/**
+ * Get aggregated metric values.
+ *
+ * Computes metric values of type double from the collector's persistent metric
+ * aggregates. The aggregates must first have been updated by a successful call
+ * to AggregateMetricValues().
+ *
+ * @param collector    Collector for which to get a metric.
+ * @param metric       Unique identifier of the metric.
+ * @param thread       Thread for which to get metric values.
+ * @param extents      Extents for which to get metric values.
+ * @retval values      Values of the metric.
+ */
+namespace Queries {
+inline void GetAggregatedMetricValues(const Framework::Collector& collector,
+				      const std::string& metric,
+				      const Framework::Thread& thread,
+				      const Framework::ExtentGroup& extents,
+				      std::vector<double>& values)
+{
+    collector.getAggregatedMetricValues(metric, thread, extents, values);
+}
+}
+
+
+
 /**
  * Get metric values.
  *
@@ -63,6 +197,9 @@ namespace OpenSpeedShop {
  * to threads to values. An empty map is allocated if one isn't provided. Non-
  * zero metric values are then added to the (new or existing) map.
  *
+ * Metrics which can be aggregated are computed from the collector's persistent
+ * metric aggregates rather than by evaluating every performance data blob.
+ *
  * @pre    The specified collector and all threads in the thread group must be
  *         in the same experiment. An assertion failure occurs if more than one
  *         experiment is implied.
@@ -116,13 +253,78 @@ void Queries::GetMetricValues(
                                 Framework::Address::TheHighest())
         );
     
+    // Update the metric aggregates (if possible) before locking the database
+    bool is_aggregated = !threads.empty();
+    for(Framework::ThreadGroup::const_iterator
+	    i = threads.begin(); is_aggregated && (i != threads.end()); ++i)
+	is_aggregated = Queries::AggregateMetricValues<TM >(
+	    collector, metric, *i
+	    );
+
     // Lock the appropriate database
     collector.lockDatabase();
 
     // Get the extent table for the source objects in the thread group
     Framework::ExtentTable<Framework::Thread, TS > extent_table = 
 	threads.getExtentsOf(objects, restriction);
+
+    // Compute the metric values from the metric aggregates when possible
+    if(is_aggregated) {
+
+	// Iterate over each thread in the thread group
+	for(Framework::ThreadGroup::const_iterator
+		i = threads.begin(); i != threads.end(); ++i) {
+
+	    // Get the extents for the source objects in this thread
+	    Framework::ExtentGroup& extents = extent_table.getExtents(*i);
+
+	    // No need to proceed further with this thread if no extents found
+	    if(extents.empty())
+		continue;
+
+	    // Compute the metric values for the necessary extents
+	    std::vector<TM > values(extents.size());
+	    Queries::GetAggregatedMetricValues(
+		collector, metric, *i, extents, values
+		);
+
+	    // Iterate over each computed extent
+	    for(Framework::ExtentGroup::size_type
+		    j = 0; j < extents.size(); ++j) {
+
+		// Was this subextent's value a non-empty value?
+		if(values[j] != TM()) {
+
+		    // Get the source object corresponding to this extent
+		    const TS& object = extent_table.getObject(*i, j);
+
+		    // Incorporate this value into the results map
+		    typename std::map<TS, std::map<Framework::Thread, TM > >::
+			iterator k = results->find(object);
+		    if(k == results->end())
+			k = results->insert(
+			    std::make_pair(object,
+					   std::map<Framework::Thread, TM >())
+			    ).first;
+		    typename std::map<Framework::Thread, TM >::iterator
+			l = k->second.find(*i);
+		    if(l == k->second.end())
+			l = k->second.insert(std::make_pair(*i, TM())).first;
+		    l->second += values[j];
+
+		}
+
+	    }
+
+	}
+
+	// Unlock the appropriate database
+	collector.unlockDatabase();
+	return;
+    }
     
+#ifndef HAVE_OPENMP
+
     // Iterate over each thread in the thread group
     for(Framework::ThreadGroup::const_iterator
 	    i = threads.begin(); i != threads.end(); ++i) {
@@ -137,86 +339,9 @@ void Queries::GetMetricValues(
 	// Allocate a vector to hold the evaluated metric values
 	std::vector<TM > values(extents.size());
 
-#ifndef HAVE_OPENMP
-
 	// Evaluate the metric values for the necessary extents
 	collector.getMetricValues(metric, *i, extents, values);
 
-#else
-
-	// Get the performance data blob identifiers to be evaluated
-        std::set<int> temp = collector.getIdentifiers(*i, extents);
-	std::vector<int> identifiers(temp.begin(), temp.end());
-
-	// Parallel region to evaluate the metric values
-	#pragma omp parallel
-	{
-	    // Vector holding the evaluated metric values for this thread
-	    std::vector<TM > local(extents.size());
-	    
-            // Make a copy of the extents. This is necessary because
-            // the Kd-tree contruction in ExtentGroup isn't thread safe.
-            Framework::ExtentGroup copy(extents);
-
-	    // Iterate in parallel over each performance data blob
-            #pragma omp for nowait
-	    for(int j = 0; j < identifiers.size(); ++j) {
-		
-		// Evalute the metric values for the necessary extents
-		collector.getMetricValues(metric, *i, copy,
-					  identifiers[j], local);
-
-	    }
-	    
-	    //
-	    // Partially computed metric values are now distributed between 
-	    // the per-thread result vectors ("local"). A reduction of these
-	    // per-thread values into the final results vector ("values") is
-	    // required. Explaining how this is accomplished is best left to
-	    // an example.
-	    //
-	    // Consider 4 threads processing a 22 element result vector. Four
-	    // iterations are performed. Each thread adds a 6 element piece
-	    // of its results into the final results during each iteration:
-	    // 
-	    //     0000000000111111111122
-	    //     0123456789012345678901    Element Number
-	    //     ----------------------
-	    //     0000001111112222223333    Iteration #1  (j=0)
-	    //     3333330000001111112222    Iteration #2  (j=1)
-	    //     2222223333330000001111    Iteration #3  (j=2)   
-	    //     1111112222223333330000    Iteration #4  (j=3)
-	    //        ^ 
-	    //        +---- Thread number writing this element
-	    //              during a given iteration.
-	    //
-
-	    // Get the total number of threads and our thread number
-	    int num_threads = omp_get_num_threads();
-	    int thread_num = omp_get_thread_num();
-
-	    // Compute number of elements to write during each iteration
-	    int n = (values.size() + num_threads - 1) / num_threads;
-
-	    // Perform each iteration
-	    for(int j = 0; j < num_threads; ++j) {
-
-		// First element reduced by this thread during this iteration
-		int first = (n * (j + thread_num)) % (n * num_threads);
-
-		// Perform reduction
-		for(int k = 0; (k < n) && ((first + k) < values.size()); ++k)
-		    values[first + k] += local[first + k];
-
-		// Wait for all threads to finish their reduction
-                #pragma omp barrier
-
-	    }
-		
-	}
-		
-#endif
-	
 	// Iterate over each evaluated extent
 	for(Framework::ExtentGroup::size_type j = 0; j < extents.size(); ++j) {
 	    
@@ -247,6 +372,121 @@ void Queries::GetMetricValues(
 
     }
 
+#else
+
+    //
+    // Performance data is evaluated in parallel over both the threads in the
+    // thread group and the performance data blobs in each thread. The blobs
+    // of each thread are split into just enough evaluations to keep all the
+    // OpenMP threads busy. Thread groups with many threads thus end up with
+    // a single evaluation per thread, while those with few threads end up
+    // with several evaluations per thread. Every evaluation keeps its own
+    // results, so no synchronization between the OpenMP threads is required
+    // until they have all finished.
+    //
+
+    // Evaluations per thread necessary to keep all the OpenMP threads busy
+    std::vector<int>::size_type splits = threads.empty() ? 1 :
+	std::max<std::vector<int>::size_type>(
+	    1, (4 * omp_get_max_threads() + threads.size() - 1) / threads.size()
+	    );
+
+    // Iterate over each thread in the thread group
+    std::vector<MetricValuesEvaluation<TM > > evaluations;
+    for(Framework::ThreadGroup::const_iterator
+	    i = threads.begin(); i != threads.end(); ++i) {
+
+	// Get the extents for the source objects in this thread
+	Framework::ExtentGroup& extents = extent_table.getExtents(*i);
+
+	// No need to proceed further with this thread if no extents were found
+	if(extents.empty())
+	    continue;
+
+	// Build the extents' Kd-tree so they can be searched concurrently
+	extents.buildTree();
+
+	// Get the performance data blob identifiers to be evaluated
+        std::set<int> temp = collector.getIdentifiers(*i, extents);
+	std::vector<int> identifiers(temp.begin(), temp.end());
+
+	// Split these identifiers between this thread's evaluations
+	std::vector<int>::size_type n =
+	    (identifiers.size() + splits - 1) / splits;
+	for(std::vector<int>::size_type j = 0; j < identifiers.size(); j += n) {
+	    evaluations.push_back(MetricValuesEvaluation<TM >(*i, extents));
+	    evaluations.back().dm_identifiers.assign(
+		identifiers.begin() + j,
+		identifiers.begin() + std::min(j + n, identifiers.size())
+		);
+	}
+
+    }
+
+    // Parallel region to evaluate the metric values
+    #pragma omp parallel
+    {
+	// Vector holding the evaluated metric values for this OpenMP thread
+	std::vector<TM > local;
+
+	// Iterate in parallel over each evaluation
+        #pragma omp for schedule(dynamic) nowait
+	for(int j = 0; j < static_cast<int>(evaluations.size()); ++j) {
+	    MetricValuesEvaluation<TM >& evaluation = evaluations[j];
+
+	    // Evalute the metric values for the necessary extents
+	    local.assign(evaluation.dm_extents->size(), TM());
+	    for(std::vector<int>::const_iterator
+		    k = evaluation.dm_identifiers.begin();
+		k != evaluation.dm_identifiers.end();
+		++k)
+		collector.getMetricValues(metric, evaluation.dm_thread,
+					  *evaluation.dm_extents, *k, local);
+
+	    // Keep only the non-empty metric values
+	    for(Framework::ExtentGroup::size_type
+		    k = 0; k < local.size(); ++k)
+		if(local[k] != TM())
+		    evaluation.dm_values.push_back(std::make_pair(k, local[k]));
+	    
+	}
+    }
+
+    // Iterate over each evaluation
+    for(typename std::vector<MetricValuesEvaluation<TM > >::const_iterator
+	    i = evaluations.begin(); i != evaluations.end(); ++i) {
+
+	// Iterate over each evaluated non-empty metric value
+	for(typename std::vector<
+		std::pair<Framework::ExtentGroup::size_type, TM >
+		>::const_iterator j = i->dm_values.begin();
+	    j != i->dm_values.end();
+	    ++j) {
+
+	    // Get the source object corresponding to this evaluated extent
+	    const TS& object = extent_table.getObject(i->dm_thread, j->first);
+		
+	    // Incorporate this value into the results map
+	    typename std::map<TS, std::map<Framework::Thread, TM > >::
+		iterator k = results->find(object);
+	    if(k == results->end())
+		k = results->insert(
+		    std::make_pair(
+			object, std::map<Framework::Thread, TM >()
+			)
+		    ).first;
+	    typename std::map<Framework::Thread, TM >::iterator
+		l = k->second.find(i->dm_thread);
+	    if(l == k->second.end())
+		l = k->second.insert(std::make_pair(i->dm_thread, TM())).first;
+	    l->second += j->second;
+	    
+	}
+
+    }
+
+#endif
+
     // Unlock the appropriate database
     collector.unlockDatabase();
 }
@@ -28,6 +28,8 @@
 #include "Queries.hxx"
 #include "ToolAPI.hxx"
 
+#include <sstream>
+
 
 //#define DEBUG_Queries 1
 
@@ -35,6 +37,15 @@ using namespace OpenSpeedShop;
 
 
 
+namespace {
+
+    /** Canonical string of default-constructed symbol keys. */
+    const std::string TheEmptyKeyString;
+
+}
+
+
+
 /**
  * Make a thread group from a thread.
  *
@@ -242,3 +253,155 @@ bool Queries::CompareLoops::operator()(
 
 }
 
+
+
+
+/**
+ * Default constructor.
+ *
+ * Constructs an empty table of interned strings.
+ */
+Queries::SymbolKey::Table::Table() :
+    dm_strings()
+{
+}
+
+
+
+/**
+ * Intern a string.
+ *
+ * Returns the table's copy of the specified string, adding it to the table if
+ * it isn't already present.
+ *
+ * @param value    String to be interned.
+ * @return         Interned copy of the string.
+ */
+const std::string* Queries::SymbolKey::Table::intern(const std::string& value)
+{
+    return &(*dm_strings.insert(value).first);
+}
+
+
+
+/**
+ * Default constructor.
+ *
+ * Constructs a symbol key for the empty canonical string. This key belongs to
+ * no table, and compares equal only to other default-constructed symbol keys.
+ */
+Queries::SymbolKey::SymbolKey() :
+    dm_hash(14695981039346656037ULL),
+    dm_string(&TheEmptyKeyString)
+{
+}
+
+
+
+/**
+ * Constructor from a linked object.
+ *
+ * Constructs the symbol key for the specified linked object. Linked objects
+ * are identified by their base name, allowing the same linked object to match
+ * across experiments even when installed in different directories.
+ *
+ * @param table            Table in which to intern the key's string.
+ * @param linked_object    Linked object for which to construct a key.
+ */
+Queries::SymbolKey::SymbolKey(Table& table,
+			      const Framework::LinkedObject& linked_object) :
+    dm_hash(0),
+    dm_string(NULL)
+{
+    std::string key("L");
+    key += '\0';
+    key += linked_object.getPath().getBaseName();
+    assign(table, key);
+}
+
+
+
+/**
+ * Constructor from a function.
+ *
+ * Constructs the symbol key for the specified function. Functions are
+ * identified by their mangled name and the base name of their linked object.
+ * Less restrictive comparisons use only the mangled name, as is done by
+ * CompareFunctions.
+ *
+ * @param table                           Table in which to intern the key's
+ *                                        string.
+ * @param function                        Function for which to construct a key.
+ * @param less_restrictive_comparisons    Boolean "true" if only the mangled
+ *                                        name should be used, or "false"
+ *                                        otherwise.
+ */
+Queries::SymbolKey::SymbolKey(Table& table,
+			      const Framework::Function& function,
+			      bool less_restrictive_comparisons) :
+    dm_hash(0),
+    dm_string(NULL)
+{
+    std::string key("F");
+    key += '\0';
+    if(!less_restrictive_comparisons)
+	key += function.getLinkedObject().getPath().getBaseName();
+    key += '\0';
+    key += function.getMangledName();
+    assign(table, key);
+}
+
+
+
+/**
+ * Constructor from a statement.
+ *
+ * Constructs the symbol key for the specified statement. Statements are
+ * identified by their line and column, source file, and the base name of
+ * their linked object. Less restrictive comparisons use only the line and
+ * column of statements with a known line, as is done by CompareStatements.
+ *
+ * @param table                           Table in which to intern the key's
+ *                                        string.
+ * @param statement                       Statement for which to construct a
+ *                                        key.
+ * @param less_restrictive_comparisons    Boolean "true" if only the line and
+ *                                        column should be used, or "false"
+ *                                        otherwise.
+ */
+Queries::SymbolKey::SymbolKey(Table& table,
+			      const Framework::Statement& statement,
+			      bool less_restrictive_comparisons) :
+    dm_hash(0),
+    dm_string(NULL)
+{
+    int line = statement.getLine();
+
+    std::ostringstream key;
+    key << "S" << '\0' << line << ':' << statement.getColumn();
+    if(!less_restrictive_comparisons || (line == 0))
+	key << '\0' << statement.getPath()
+	    << '\0' << statement.getLinkedObject().getPath().getBaseName();
+    assign(table, key.str());
+}
+
+
+
+/**
+ * Assign the canonical string.
+ *
+ * Hashes the specified canonical string using the FNV-1a hash function and
+ * then interns it in the specified table.
+ *
+ * @param table    Table in which to intern the string.
+ * @param key      Canonical string of this symbol key.
+ */
+void Queries::SymbolKey::assign(Table& table, const std::string& key)
+{
+    dm_hash = 14695981039346656037ULL;
+    for(std::string::const_iterator i = key.begin(); i != key.end(); ++i) {
+	dm_hash ^= static_cast<unsigned char>(*i);
+	dm_hash *= 1099511628211ULL;
+    }
+    dm_string = table.intern(key);
+}
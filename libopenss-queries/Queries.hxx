@@ -34,6 +34,7 @@
 
 #include <functional>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -148,6 +149,106 @@ namespace OpenSpeedShop {
                             bool ) const;
 	};
 
+	/**
+	 * Canonical symbol key.
+	 *
+	 * Key identifying a linked object, function, or statement in a manner
+	 * that is independent of the experiment database containing it. The key
+	 * consists of a canonical string, built from the linked object's base
+	 * name, the function's mangled name, and the statement's source file,
+	 * line, and column, along with a 64-bit hash of that string. The string
+	 * is interned in a caller-provided table so that equal keys constructed
+	 * from the same table always share the same string.
+	 *
+	 * Keys are computed once per entity, with a handful of attribute lookups,
+	 * and afterwards compare with only integer operations. Maps keyed on them
+	 * can thus join the entities of many experiments without the repeated
+	 * attribute lookups incurred by the comparison predicates above.
+	 *
+	 * @note    Keys hashing the same are ordered by the address of their
+	 *          interned string. That ordering is consistent for the life of
+	 *          the table, but has no meaning beyond distinguishing keys.
+	 */
+	class SymbolKey
+	{
+
+	public:
+
+	    /**
+	     * Table of interned strings.
+	     *
+	     * Set of the canonical strings of the symbol keys constructed from
+	     * this table. Keys refer to their string in the table, so they may
+	     * be used only while the table exists, and may only be compared to
+	     * keys constructed from the same table. A table is typically scoped
+	     * to a single comparison, and isn't safe for concurrent use.
+	     */
+	    class Table
+	    {
+
+	    public:
+
+		Table();
+
+		const std::string* intern(const std::string&);
+
+	    private:
+
+		/** Interned strings. */
+		std::set<std::string> dm_strings;
+
+	    };
+
+	    SymbolKey();
+	    SymbolKey(Table&, const Framework::LinkedObject&);
+	    SymbolKey(Table&, const Framework::Function&, bool);
+	    SymbolKey(Table&, const Framework::Statement&, bool);
+
+	    /** Operator "<" defined for two symbol keys. */
+	    bool operator<(const SymbolKey& other) const
+	    {
+		if(dm_hash != other.dm_hash)
+		    return dm_hash < other.dm_hash;
+		return std::less<const std::string*>()(dm_string,
+						       other.dm_string);
+	    }
+
+	    /** Operator "==" defined for two symbol keys. */
+	    bool operator==(const SymbolKey& other) const
+	    {
+		return dm_string == other.dm_string;
+	    }
+
+	    /** Operator "!=" defined for two symbol keys. */
+	    bool operator!=(const SymbolKey& other) const
+	    {
+		return dm_string != other.dm_string;
+	    }
+
+	    /** Read-only data member accessor function. */
+	    const uint64_t& getHash() const
+	    {
+		return dm_hash;
+	    }
+
+	    /** Read-only data member accessor function. */
+	    const std::string& getString() const
+	    {
+		return *dm_string;
+	    }
+
+	private:
+
+	    void assign(Table&, const std::string&);
+
+	    /** Hash of the canonical string. */
+	    uint64_t dm_hash;
+
+	    /** Interned canonical string. */
+	    const std::string* dm_string;
+
+	};
+
 	template <typename TS, typename TM>
 	void GetMetricValues(
 	    const Framework::Collector&,
@@ -222,6 +323,35 @@ namespace OpenSpeedShop {
 	    TM AverageLinkageDistance(const DistanceMatrix<TS, TM >&,
 				      const Framework::ThreadGroup&,
 				      const Framework::ThreadGroup&);
+
+	    /**
+	     * Cluster statistics.
+	     *
+	     * Statistics describing a single cluster of threads. These are
+	     * maintained incrementally as clusters are formed and are passed
+	     * to the cluster termination predicates, avoiding the need for
+	     * those predicates to revisit every pair of threads in a cluster.
+	     */
+	    template <typename TM>
+	    struct ClusterStatistics {
+
+		/** Number of threads in the cluster. */
+		unsigned dm_size;
+
+		/** Sum of the distances between each unique pairing of threads
+		    in the cluster. */
+		TM dm_sum;
+
+		/** Constructor for a cluster containing a single thread. */
+		ClusterStatistics() : dm_size(1), dm_sum() { }
+
+		/** Get the average inter-cluster distance. */
+		TM getAverageDistance() const
+		{
+		    return dm_sum / ((dm_size * (dm_size - 1)) / 2);
+		}
+
+	    };
 	    
 	    /**
 	     * Clustering termination predicate (numerical #1).
@@ -237,9 +367,9 @@ namespace OpenSpeedShop {
 	    struct NumberCriterion1 {
 
 		bool operator()(const DistanceMatrix<TS, TM >&,
-				const std::set<Framework::ThreadGroup>&,
-				const TM&, const Framework::ThreadGroup&,
-				const Framework::ThreadGroup&) const;
+				const unsigned&, const TM&,
+				const ClusterStatistics<TM>&,
+				const ClusterStatistics<TM>&) const;
 		
 		/** Constructor from maximum cluster count. */
 		NumberCriterion1(const unsigned& count) : dm_count(count) { }
@@ -267,10 +397,9 @@ namespace OpenSpeedShop {
 	    struct DistanceCriterion1 {
 
 		bool operator()(const DistanceMatrix<TS, TM >&,
-				const std::set<Framework::ThreadGroup>&,
-				const TM&, 
-				const Framework::ThreadGroup&,
-				const Framework::ThreadGroup&) const;
+				const unsigned&, const TM&, 
+				const ClusterStatistics<TM>&,
+				const ClusterStatistics<TM>&) const;
 		
 		/** Constructor from maximum distance ratio. */
 		DistanceCriterion1(const double& ratio) : dm_ratio(ratio) { }
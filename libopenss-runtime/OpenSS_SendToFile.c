@@ -19,7 +19,8 @@
 
 /** @file
  *
- * Definition of the OpenSS_SetSendToFile() and OpenSS_SendToFile() functions.
+ * Definition of the OpenSS_SetSendToFile(), OpenSS_SendToFile(), and
+ * OpenSS_FlushSendToFile() functions.
  *
  */
 
@@ -38,12 +39,39 @@
 
 
 
+/** Alignment (and granularity) of the write buffer in bytes. */
+#define BufferAlignment 4096
+
+/** Default maximum time between flushes of the write buffer (10 seconds). */
+#define DefaultFlushInterval (10ULL * 1000000000ULL)
+
+
+
 /** Type defining the items stored in thread-local storage. */
 typedef struct {
 
     /** Path of the file to which data should be written. **/
     char path[PATH_MAX];
 
+    /**
+     * Write buffer.
+     *
+     * Only used when buffering has been requested via the environment variable
+     * OPENSS_RAWDATA_BUFFER_SIZE. Data is then coalesced into this buffer and
+     * written to the file, which is kept open, when the buffer is full, when
+     * OPENSS_RAWDATA_FLUSH_INTERVAL seconds have passed since the last write,
+     * when the "send-to" file changes, or when OpenSS_FlushSendToFile() is
+     * called.
+     */
+    struct {
+	char* data;          /**< Buffered data (NULL when not buffering). */
+	unsigned size;       /**< Size of the buffer in bytes. */
+	unsigned used;       /**< Number of bytes currently buffered. */
+	uint64_t interval;   /**< Maximum time between flushes. */
+	uint64_t last_flush; /**< Time of the last flush. */
+	int fd;              /**< Open file descriptor (-1 when closed). */
+    } buffer;
+
 } TLS;
 
 #ifdef USE_EXPLICIT_TLS
@@ -65,6 +93,52 @@ static __thread TLS the_tls;
 
 
 
+/**
+ * Write data to a file descriptor.
+ *
+ * Writes the entirety of the specified data to the specified file descriptor,
+ * retrying after partial writes and interruptions. Safe to be called from
+ * within a signal handler.
+ *
+ * @param fd      File descriptor to be written.
+ * @param size    Size of the data to be written (in bytes).
+ * @param data    Pointer to the data to be written.
+ */
+static void writeAll(int fd, unsigned size, const void* data)
+{
+    const char* ptr = (const char*)data;
+    while(size > 0) {
+	ssize_t retval = write(fd, ptr, size);
+	if((retval < 0) && (errno == EINTR))
+	    continue;
+	Assert(retval > 0);
+	ptr += retval;
+	size -= retval;
+    }
+}
+
+
+
+/**
+ * Flush the write buffer.
+ *
+ * Writes any data in the calling thread's write buffer to the current "send-to"
+ * file, opening the file first if necessary. The file is left open.
+ *
+ * @param tls    Thread-local storage of the calling thread.
+ */
+static void flushBuffer(TLS* tls)
+{
+    if(tls->buffer.fd < 0)
+	Assert((tls->buffer.fd = open(tls->path, O_WRONLY | O_APPEND)) >= 0);
+    if(tls->buffer.used > 0)
+	writeAll(tls->buffer.fd, tls->buffer.used, tls->buffer.data);
+    tls->buffer.used = 0;
+    tls->buffer.last_flush = OpenSS_GetTime();
+}
+
+
+
 /**
  * Set the "send-to" file.
  *
@@ -87,13 +161,20 @@ void OpenSS_SetSendToFile(OpenSS_DataHeader* header,
     char dir_path[PATH_MAX];
     int fd;
 
-    /* Access our thread-local storage */
+    /* Access our thread-local storage (creating it if necessary) */
 #ifdef USE_EXPLICIT_TLS
-    TLS* tls = malloc(sizeof(TLS));
-    Assert(tls != NULL);
-    OpenSS_SetTLS(TLSKey, tls);
+    TLS* tls = OpenSS_GetTLS(TLSKey);
+    if(tls == NULL) {
+	tls = malloc(sizeof(TLS));
+	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
+	tls->buffer.fd = -1;
+	OpenSS_SetTLS(TLSKey, tls);
+    }
 #else
     TLS* tls = &the_tls;
+    if(tls->buffer.data == NULL)
+	tls->buffer.fd = -1;
 #endif
     Assert(tls != NULL);
     
@@ -101,6 +182,32 @@ void OpenSS_SetSendToFile(OpenSS_DataHeader* header,
     Assert(unique_id != NULL);
     Assert(suffix != NULL);
 
+    /* Write out anything buffered for the previous "send-to" file */
+    OpenSS_FlushSendToFile();
+
+    /* Allocate the write buffer if buffering was requested */
+    if(tls->buffer.data == NULL) {
+	const char* buffer_size = getenv("OPENSS_RAWDATA_BUFFER_SIZE");
+	const char* flush_interval = getenv("OPENSS_RAWDATA_FLUSH_INTERVAL");
+	unsigned size = (buffer_size != NULL) ? atoi(buffer_size) : 0;
+
+	if(size > 0) {
+	    size = ((size + BufferAlignment - 1) / BufferAlignment) *
+		BufferAlignment;
+	    if(posix_memalign((void**)&tls->buffer.data,
+			      BufferAlignment, size) == 0) {
+		tls->buffer.size = size;
+		tls->buffer.used = 0;
+		tls->buffer.interval = (flush_interval != NULL) ?
+		    (uint64_t)atoi(flush_interval) * 1000000000ULL :
+		    DefaultFlushInterval;
+		tls->buffer.last_flush = OpenSS_GetTime();
+	    }
+	    else
+		tls->buffer.data = NULL;
+	}
+    }
+
     /* Get our executable path */
     executable_path = OpenSS_GetExecutablePath();
     
@@ -229,6 +336,34 @@ int OpenSS_SendToFile(const unsigned size, const void* data)
     /* Close the XDR stream */
     xdr_destroy(&xdrs);
 
+    /* Coalesce the data into the write buffer when buffering */
+    if(tls->buffer.data != NULL) {
+
+	/* Flush the buffer first if there isn't room for this data */
+	if((tls->buffer.used + encoded_size + size) > tls->buffer.size)
+	    flushBuffer(tls);
+
+	if((encoded_size + size) <= tls->buffer.size) {
+	    memcpy(tls->buffer.data + tls->buffer.used, buffer, encoded_size);
+	    memcpy(tls->buffer.data + tls->buffer.used + encoded_size,
+		   data, size);
+	    tls->buffer.used += encoded_size + size;
+	}
+	else {
+	    /* Data larger than the buffer is written directly */
+	    flushBuffer(tls);
+	    writeAll(tls->buffer.fd, encoded_size, buffer);
+	    writeAll(tls->buffer.fd, size, data);
+	}
+
+	/* Flush the buffer if it has been held for too long */
+	if((OpenSS_GetTime() - tls->buffer.last_flush) > tls->buffer.interval)
+	    flushBuffer(tls);
+
+	/* Indicate success to the caller */
+	return 1;
+    }
+
     /* Open the file for writing */
     Assert((fd = open(tls->path, O_WRONLY | O_APPEND)) >= 0);
 
@@ -253,3 +388,35 @@ int OpenSS_SendToFile(const unsigned size, const void* data)
     /* Indicate success to the caller */
     return 1;
 }
+
+
+
+/**
+ * Flush performance data to a file.
+ *
+ * Writes any performance data buffered by OpenSS_SendToFile() for the calling
+ * thread to the current "send-to" file and closes that file. Does nothing when
+ * buffering has not been requested. Must be called before the calling thread or
+ * process exits, and before it forks, in order to not lose or duplicate data.
+ *
+ * @ingroup RuntimeAPI
+ */
+void OpenSS_FlushSendToFile()
+{
+    /* Access our thread-local storage */
+#ifdef USE_EXPLICIT_TLS
+    TLS* tls = OpenSS_GetTLS(TLSKey);
+#else
+    TLS* tls = &the_tls;
+#endif
+    if((tls == NULL) || (tls->buffer.data == NULL))
+	return;
+
+    /* Write any buffered data and close the file */
+    if((tls->buffer.used > 0) && (tls->path[0] != '\0'))
+	flushBuffer(tls);
+    if(tls->buffer.fd >= 0) {
+	Assert(close(tls->buffer.fd) == 0);
+	tls->buffer.fd = -1;
+    }
+}
@@ -0,0 +1,182 @@
+/*******************************************************************************
+** Copyright (c) 2026 The Krell Institute. All Rights Reserved.
+**
+** This library is free software; you can redistribute it and/or modify it under
+** the terms of the GNU Lesser General Public License as published by the Free
+** Software Foundation; either version 2.1 of the License, or (at your option)
+** any later version.
+**
+** This library is distributed in the hope that it will be useful, but WITHOUT
+** ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+** FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+** details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this library; if not, write to the Free Software Foundation, Inc.,
+** 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*******************************************************************************/
+
+/** @file
+ *
+ * Definition of the OpenSS_ClearStackTraceTable(), OpenSS_FindStackTrace(),
+ * and OpenSS_AddStackTrace() functions.
+ *
+ */
+
+#include "RuntimeAPI.h"
+
+#include <string.h>
+
+
+
+/**
+ * Hash a stack trace.
+ *
+ * Returns the hash table bucket at which to begin the search for the specified
+ * stack trace. The frames are combined using the FNV-1a hash function.
+ *
+ * @param size          Number of frames in the stack trace.
+ * @param stacktrace    Frames of the stack trace.
+ * @return              Hash table bucket for this stack trace.
+ */
+static unsigned hash(unsigned size, const uint64_t* stacktrace)
+{
+    uint64_t value = 14695981039346656037ULL;
+    unsigned i;
+
+    for(i = 0; i < size; ++i) {
+	value ^= stacktrace[i];
+	value *= 1099511628211ULL;
+    }
+    value ^= (value >> 32);
+
+    return (unsigned)(value % OpenSS_StackTraceHashTableSize);
+}
+
+
+
+/**
+ * Clear stack trace table.
+ *
+ * Removes all stack traces from the specified stack trace table. Must be
+ * called whenever the tracing buffer indexed by the table is emptied.
+ *
+ * @param table    Stack trace table to be cleared.
+ *
+ * @ingroup RuntimeAPI
+ */
+void OpenSS_ClearStackTraceTable(OpenSS_StackTraceTable* table)
+{
+    memset(table, 0, sizeof(OpenSS_StackTraceTable));
+}
+
+
+
+/**
+ * Compare stack trace.
+ *
+ * Compares the stack trace at the specified hash table bucket against the
+ * specified stack trace.
+ *
+ * @param table         Stack trace table indexing the buffer.
+ * @param buffer        Buffer containing the stack traces.
+ * @param bucket        Hash table bucket to be compared.
+ * @param size          Number of frames in the stack trace.
+ * @param stacktrace    Frames of the stack trace.
+ * @return              Boolean "true" if the stack traces are identical,
+ *                      "false" otherwise.
+ */
+static bool_t compare(const OpenSS_StackTraceTable* table,
+		      const uint64_t* buffer, unsigned bucket,
+		      unsigned size, const uint64_t* stacktrace)
+{
+    unsigned start = table->hash_table[bucket] - 1, i;
+
+    if(table->size_table[bucket] != size)
+	return FALSE;
+    for(i = 0; (i < size) && (buffer[start + i] == stacktrace[i]); ++i);
+    return (i == size) ? TRUE : FALSE;
+}
+
+
+
+/**
+ * Find stack trace.
+ *
+ * Searches a buffer for an existing copy of the specified stack trace. The
+ * frames of each stack trace are stored contiguously within the buffer. The
+ * tracing collectors terminate each stack trace with a zero frame, and the
+ * sampling collectors mark the top of each stack trace in a separate count
+ * array, but the table doesn't depend on either. A hash table and a simple
+ * linear probe are used to accelerate the search, so only stack traces whose
+ * hash collides with the specified stack trace are compared against it.
+ *
+ * @param table          Stack trace table indexing the buffer.
+ * @param buffer         Buffer to be searched.
+ * @param size           Number of frames in the stack trace.
+ * @param stacktrace     Frames of the stack trace.
+ * @retval entry         Index of the stack trace within the buffer.
+ * @return               Boolean "true" if the stack trace was found in the
+ *                       buffer, "false" otherwise.
+ *
+ * @ingroup RuntimeAPI
+ */
+bool_t OpenSS_FindStackTrace(const OpenSS_StackTraceTable* table,
+			     const uint64_t* buffer,
+			     unsigned size, const uint64_t* stacktrace,
+			     unsigned* entry)
+{
+    unsigned bucket;
+
+    for(bucket = hash(size, stacktrace);
+	table->hash_table[bucket] > 0;
+	bucket = (bucket + 1) % OpenSS_StackTraceHashTableSize)
+	if(compare(table, buffer, bucket, size, stacktrace)) {
+	    *entry = table->hash_table[bucket] - 1;
+	    return TRUE;
+	}
+
+    return FALSE;
+}
+
+
+
+/**
+ * Add stack trace.
+ *
+ * Adds the stack trace just added to a buffer to the specified stack trace
+ * table. An identical stack trace already in the table is replaced, so that
+ * later searches find the newest copy. Otherwise stack traces are silently left
+ * out of the table once it is half full. They will merely be duplicated in the
+ * buffer.
+ *
+ * @param table     Stack trace table indexing the buffer.
+ * @param buffer    Buffer containing the stack trace.
+ * @param entry     Index of the stack trace within the buffer.
+ * @param size      Number of frames in the stack trace.
+ *
+ * @ingroup RuntimeAPI
+ */
+void OpenSS_AddStackTrace(OpenSS_StackTraceTable* table,
+			  const uint64_t* buffer, unsigned entry, unsigned size)
+{
+    unsigned bucket;
+
+    /* Find an identical stack trace, or else an empty bucket */
+    for(bucket = hash(size, &buffer[entry]);
+	table->hash_table[bucket] > 0;
+	bucket = (bucket + 1) % OpenSS_StackTraceHashTableSize)
+	if(compare(table, buffer, bucket, size, &buffer[entry])) {
+	    table->hash_table[bucket] = entry + 1;
+	    return;
+	}
+
+    /* Keep the hash table no more than half full */
+    if((2 * (table->length + 1)) > OpenSS_StackTraceHashTableSize)
+	return;
+
+    /* Update the hash table with this new stack trace */
+    table->hash_table[bucket] = entry + 1;
+    table->size_table[bucket] = size;
+    table->length++;
+}
@@ -29,7 +29,14 @@
 #include <pthread.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
+
+#if defined(SIGEV_THREAD_ID) && !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
 
 
 
@@ -42,6 +49,12 @@ static unsigned num_threads = 0;
 /** Old SIGPROF signal handler action (shared state). */
 struct sigaction original_sigprof_action;
 
+/** Flag indicating if per-thread CPU-time timers should be used. */
+static bool_t use_thread_timers = FALSE;
+
+/** Once control for initializing use_thread_timers. */
+static pthread_once_t use_thread_timers_once = PTHREAD_ONCE_INIT;
+
 
 
 /** Type defining the items stored in thread-local storage. */
@@ -50,6 +63,12 @@ typedef struct {
     /** Timer event handling function. */
     OpenSS_TimerEventHandler timer_handler;
 
+    /** Flag indicating if this thread has a per-thread timer. */
+    bool_t has_thread_timer;
+
+    /** Per-thread timer (when present). */
+    timer_t thread_timer;
+
 } TLS;
 
 #ifdef USE_EXPLICIT_TLS
@@ -119,6 +138,70 @@ static void signalHandler(int signal, siginfo_t* info, void* ptr)
 
 
 
+/**
+ * Initialize use_thread_timers.
+ *
+ * Per-thread CPU-time timers are used when the environment variable
+ * OPENSS_THREAD_TIMERS is set and the platform supports them. Otherwise the
+ * process-wide ITIMER_PROF timer is used.
+ *
+ * @ingroup Implementation
+ */
+static void initializeUseThreadTimers()
+{
+#if defined(SIGEV_THREAD_ID) && defined(CLOCK_THREAD_CPUTIME_ID)
+    use_thread_timers = (getenv("OPENSS_THREAD_TIMERS") != NULL);
+#endif
+}
+
+
+
+/**
+ * Create a per-thread timer.
+ *
+ * Creates a timer measuring the CPU time of the currently executing thread,
+ * and delivering SIGPROF to that thread, at the specified interval. Unlike
+ * ITIMER_PROF, which on Linux measures the CPU time of the whole process and
+ * interrupts whichever thread is running, this gives each thread its own
+ * sampling clock.
+ *
+ * @param tls         Thread-local storage in which to record the timer.
+ * @param interval    Timer interval (in nanoseconds).
+ * @return            Boolean "true" if the timer was created, "false"
+ *                    otherwise.
+ *
+ * @ingroup Implementation
+ */
+static bool_t createThreadTimer(TLS* tls, uint64_t interval)
+{
+#if defined(SIGEV_THREAD_ID) && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct sigevent event;
+    struct itimerspec spec;
+
+    /* Create a timer delivering SIGPROF to this thread */
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_signo = SIGPROF;
+    event.sigev_notify_thread_id = syscall(SYS_gettid);
+    if(timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &tls->thread_timer) != 0)
+	return FALSE;
+    tls->has_thread_timer = TRUE;
+
+    /* Enable the timer */
+    spec.it_interval.tv_sec = interval / (uint64_t)(1000000000);
+    spec.it_interval.tv_nsec = interval % (uint64_t)(1000000000);
+    spec.it_value.tv_sec = spec.it_interval.tv_sec;
+    spec.it_value.tv_nsec = spec.it_interval.tv_nsec;
+    Assert(timer_settime(tls->thread_timer, 0, &spec, NULL) == 0);
+
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+
+
 /**
  * Configure a per-thread timer.
  *
@@ -129,6 +212,11 @@ static void signalHandler(int signal, siginfo_t* info, void* ptr)
  *
  * @note    The time measured here is CPU seconds spent executing the thread.
  *
+ * @note    By default the process-wide ITIMER_PROF timer is used. Setting the
+ *          environment variable OPENSS_THREAD_TIMERS instead gives each thread
+ *          its own CPU-time timer, where the platform supports them, so that
+ *          samples are taken from every thread at the specified interval.
+ *
  * @param interval   Timer interval (in nanoseconds).
  * @param handler    Timer event handler.
  *
@@ -145,6 +233,7 @@ void OpenSS_Timer(uint64_t interval, const OpenSS_TimerEventHandler handler)
     if(tls == NULL) {
 	tls = malloc(sizeof(TLS));
 	Assert(tls != NULL);
+	memset(tls, 0, sizeof(TLS));
 	OpenSS_SetTLS(TLSKey, tls);
     }
 #else
@@ -152,9 +241,19 @@ void OpenSS_Timer(uint64_t interval, const OpenSS_TimerEventHandler handler)
 #endif
     Assert(tls != NULL);
 
+    /* Determine which kind of timer is to be used */
+    Assert(pthread_once(&use_thread_timers_once,
+			initializeUseThreadTimers) == 0);
+
     /* Disable the timer for this thread */
-    memset(&spec, 0, sizeof(spec));
-    Assert(setitimer(ITIMER_PROF, &spec, NULL) == 0);
+    if(tls->has_thread_timer) {
+	Assert(timer_delete(tls->thread_timer) == 0);
+	tls->has_thread_timer = FALSE;
+    }
+    else {
+	memset(&spec, 0, sizeof(spec));
+	Assert(setitimer(ITIMER_PROF, &spec, NULL) == 0);
+    }
 
     /* Obtain exclusive access to shared state */
     Assert(pthread_mutex_lock(&mutex_lock) == 0);
@@ -209,7 +308,11 @@ void OpenSS_Timer(uint64_t interval, const OpenSS_TimerEventHandler handler)
 	/* Configure the new timer event handler for this thread */
 	tls->timer_handler = handler;
 	
-	/* Enable a timer for this thread */
+	/* Enable a per-thread timer for this thread if requested */
+	if(use_thread_timers && createThreadTimer(tls, interval))
+	    return;
+
+	/* Otherwise enable the process-wide timer for this thread */
 	spec.it_interval.tv_sec = interval / (uint64_t)(1000000000);
 	spec.it_interval.tv_usec =
 	    (interval % (uint64_t)(1000000000)) / (uint64_t)(1000);
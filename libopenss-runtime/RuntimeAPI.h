@@ -107,6 +107,30 @@ typedef struct {
 
 
 
+/**
+ * Number of entries in the stack trace hash table. This is twice the number of
+ * stack traces that fit in the tracing collectors' stack trace buffers.
+ */
+#define OpenSS_StackTraceHashTableSize (384 * OpenSS_BlobSizeFactor)
+
+/**
+ * Type representing the stack traces within a tracing or sampling buffer.
+ * The frames of each stack trace are stored contiguously within the buffer.
+ */
+typedef struct {
+
+    unsigned length;  /**< Number of stack traces in the hash table. */
+
+    /** Hash table mapping stack traces to their buffer index (plus one). */
+    unsigned hash_table[OpenSS_StackTraceHashTableSize];
+
+    /** Number of frames in the stack trace at each hash table entry. */
+    unsigned size_table[OpenSS_StackTraceHashTableSize];
+
+} OpenSS_StackTraceTable;
+
+
+
 /**
  * Type representing different floating-point exception (FPE) types.
  *
@@ -145,10 +169,16 @@ void OpenSS_InitializeDataHeader(int, int, OpenSS_DataHeader*);
 void OpenSS_SetPCInContext(uint64_t, ucontext_t*);
 uint64_t OpenSS_GetTime();
 void OpenSS_Send(const OpenSS_DataHeader*, const xdrproc_t, const void*);
+void OpenSS_FlushSendToFile();
 void OpenSS_Timer(uint64_t, const OpenSS_TimerEventHandler);
 bool_t OpenSS_UpdatePCData(uint64_t, OpenSS_PCData*);
 bool_t OpenSS_UpdateHWCPCData(uint64_t, OpenSS_HWCPCData*, long long* );
 bool_t OpenSS_Path_From_Pid(char *);
+void OpenSS_ClearStackTraceTable(OpenSS_StackTraceTable*);
+bool_t OpenSS_FindStackTrace(const OpenSS_StackTraceTable*, const uint64_t*,
+			     unsigned, const uint64_t*, unsigned*);
+void OpenSS_AddStackTrace(OpenSS_StackTraceTable*, const uint64_t*,
+			  unsigned, unsigned);
 
 #ifdef USE_EXPLICIT_TLS
 void* OpenSS_GetTLS(uint32_t);
@@ -183,6 +183,9 @@ void monitor_fini_process(int how, void *data)
 	tls->process_is_terminating = 1;
 	offline_stop_sampling(NULL, 1);
     }
+
+    /* Write out any raw data still buffered for this thread */
+    OpenSS_FlushSendToFile();
 }
 
 void *monitor_init_process(int *argc, char **argv, void *data)
@@ -297,6 +300,9 @@ void monitor_fini_thread(void *ptr)
     tls->sampling_status = OpenSS_Monitor_Finished;
     tls->thread_is_terminating = 1;
     offline_stop_sampling(NULL,1);
+
+    /* Write out any raw data still buffered for this thread */
+    OpenSS_FlushSendToFile();
 }
 
 void *monitor_init_thread(int tid, void *data)
@@ -642,6 +648,9 @@ void * monitor_pre_fork(void)
 	tls->sampling_status = OpenSS_Monitor_Finished;
 	offline_stop_sampling(NULL,1);
     }
+
+    /* Write out buffered raw data so the child doesn't inherit a copy */
+    OpenSS_FlushSendToFile();
     return (NULL);
 }
 
@@ -118,6 +118,8 @@ AC_DEFUN([AX_BINUTILS], [
             AM_CONDITIONAL(HAVE_BINUTILS, true)
             AC_DEFINE(HAVE_BINUTILS, 1, [Define to 1 if you have BINUTILS.])
 
+            AC_CHECK_FUNCS(bfd_thread_init)
+
         ], [ AC_MSG_RESULT(no)
 
 	    if test x"$binutils_required" == x"true"; then
@@ -330,23 +330,29 @@ void HWCCollector::getMetricValues(const std::string& metric,
     //uint64_t t_blob = static_cast<uint64_t>(extent.getTimeInterval().getWidth());
     double t_blob = static_cast<double>(extent.getTimeInterval().getWidth());
 
+    // Cache of the subextents containing each sample
+    SubextentCache& cache = getSubextentCache(subextents);
+
     // Iterate over each of the samples
     for(unsigned i = 0; i < data.pc.pc_len; ++i) {
 	
 	// Find the subextents that contain this sample
-	std::set<ExtentGroup::size_type> intersection = 
-	    subextents.getIntersectionWith(
-		Extent(extent.getTimeInterval(),
-		       AddressRange(data.pc.pc_val[i]))
-		);
+	const std::vector<ExtentGroup::size_type>& containing =
+	    cache.getSubextentsAt(Address(data.pc.pc_val[i]));
 	
 	// Calculate the time (in seconds) attributable to this sample
 	uint64_t t_sample = static_cast<uint64_t>(data.count.count_val[i]) *
 			    static_cast<uint64_t>(data.interval);
 	
-	// Iterate over each subextent in the intersection
-	for(std::set<ExtentGroup::size_type>::const_iterator
-		j = intersection.begin(); j != intersection.end(); ++j) {
+	// Iterate over each subextent containing this sample
+	for(std::vector<ExtentGroup::size_type>::const_iterator
+		j = containing.begin(); j != containing.end(); ++j) {
+
+	    // Skip subextents that don't intersect the data blob in time
+	    if(!extent.getTimeInterval().doesIntersect(
+		   subextents[*j].getTimeInterval()
+		   ))
+		continue;
 	    
 	    // Calculate intersection time (in nS) of subextent and data blob
 	    double t_intersection = static_cast<double>
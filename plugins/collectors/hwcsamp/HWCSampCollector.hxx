@@ -66,6 +66,7 @@ namespace OpenSpeedShop { namespace Framework {
 				     const Collector&, const Thread&,
 				     const Extent&, const Blob&, 
 				     const ExtentGroup&, void*) const;
+	virtual bool isAggregatable(const std::string&) const;
 
 	virtual void getUniquePCValues( const Thread& thread, const Blob& blob,
 					PCBuffer *buf) const;
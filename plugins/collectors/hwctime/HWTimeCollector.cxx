@@ -334,6 +334,9 @@ void HWTimeCollector::getMetricValues(const std::string& metric,
     // Calculate time (in nS) of data blob's extent
     double t_blob = static_cast<double>(extent.getTimeInterval().getWidth());
 
+    // Cache of the subextents containing each frame
+    SubextentCache& cache = getSubextentCache(subextents);
+
     // Iterate over each stack trace in the data blob    
     for(unsigned ib = 0, ie = 0; ie < data.bt.bt_len; ib = ie) {
 	
@@ -346,8 +349,13 @@ void HWTimeCollector::getMetricValues(const std::string& metric,
 	uint64_t e_sample = static_cast<uint64_t>(data.count.count_val[ib]) *
 	     static_cast<uint64_t>(data.interval);	
 	
-	// Get the stack trace for this sample
+	// Get the stack trace for this sample (only needed for the details)
 	StackTrace trace(thread, extent.getTimeInterval().getBegin());
+	for(unsigned j = ib; is_detail && (j < ie); ++j)
+	    if(data.bt.bt_val[j] != 0)
+		trace.push_back(Address(data.bt.bt_val[j]));
+	
+	// Iterate over each of the frames in the current stack trace
 	for(unsigned j = ib; j < ie; ++j) {
 
 	    if (data.bt.bt_val[j] == 0) {
@@ -356,26 +364,20 @@ void HWTimeCollector::getMetricValues(const std::string& metric,
 		    // code.  FIXME.  look at unwind code for the real cause...
 		    continue;
 	    }
-	    trace.push_back(Address(data.bt.bt_val[j]));
-	}
-	
-	// Iterate over each of the frames in the current stack trace
-	for(StackTrace::const_iterator
-		j = trace.begin(); j != trace.end(); ++j) {
-	    
-	    // Stop after first frame if this is "exclusive_[overflows|detail]"
-	    if(is_exclusive && (j != trace.begin()))
-		break;
 	    
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(extent.getTimeInterval(), AddressRange(*j))
-		    );
+	    const std::vector<ExtentGroup::size_type>& containing =
+		cache.getSubextentsAt(Address(data.bt.bt_val[j]));
 	    
-	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
-		    k = intersection.begin(); k != intersection.end(); ++k) {
+	    // Iterate over each subextent containing this frame
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
+		    k = containing.begin(); k != containing.end(); ++k) {
+
+		// Skip subextents that don't intersect the blob in time
+		if(!extent.getTimeInterval().doesIntersect(
+		       subextents[*k].getTimeInterval()
+		       ))
+		    continue;
 
 		// Calculate intersection time (in nS) of subextent and blob
 		double t_intersection = static_cast<double>
@@ -421,6 +423,10 @@ void HWTimeCollector::getMetricValues(const std::string& metric,
 		}
 		
 	    }
+
+	    // Stop after first frame if this is "exclusive_[overflows|detail]"
+	    if(is_exclusive)
+		break;
 	    
 	}
 	
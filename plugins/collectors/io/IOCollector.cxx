@@ -362,6 +362,9 @@ void IOCollector::getMetricValues(const std::string& metric,
     memset(&data, 0, sizeof(data));
     blob.getXDRDecoding(reinterpret_cast<xdrproc_t>(xdr_io_data), &data);
 
+    // Buffer holding the subextents intersected by each sample
+    std::vector<ExtentGroup::size_type> intersection;
+
     // Iterate over each of the events
     for(unsigned i = 0; i < data.events.events_len; ++i) {
 
@@ -404,13 +407,13 @@ void IOCollector::getMetricValues(const std::string& metric,
 		break;
 
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(interval, AddressRange(*j))
-		    );
+	    subextents.getIntersectionWith(
+		Extent(interval, AddressRange(*j)),
+		intersection
+		);
 
 	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
 		    k = intersection.begin(); k != intersection.end(); ++k) {
 		
 		// Calculate intersection time (in nS) of subextent and event
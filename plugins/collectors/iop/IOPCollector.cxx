@@ -319,6 +319,9 @@ void IOPCollector::getMetricValues(const std::string& metric,
     // Calculate time (in nS) of data blob's extent
     double t_blob = static_cast<double>(extent.getTimeInterval().getWidth());
 
+    // Buffer holding the subextents intersected by each sample
+    std::vector<ExtentGroup::size_type> intersection;
+
     // Iterate over each stack trace in the data blob    
     for(unsigned ib = 0, ie = 0; ie < data.stacktraces.stacktraces_len; ib = ie) {
 	
@@ -363,13 +366,13 @@ void IOPCollector::getMetricValues(const std::string& metric,
 		break;
 	    
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(extent.getTimeInterval(), AddressRange(*j))
-		    );
+	    subextents.getIntersectionWith(
+		Extent(extent.getTimeInterval(), AddressRange(*j)),
+		intersection
+		);
 
 	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
 		    k = intersection.begin(); k != intersection.end(); ++k) {
 
 		// Calculate intersection time (in nS) of subextent and blob
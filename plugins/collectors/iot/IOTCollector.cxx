@@ -421,6 +421,9 @@ void IOTCollector::getMetricValues(const std::string& metric,
       std::cerr << "IOTCollector::getMetricValues, data.pathnames.pathnames_len=" << data.pathnames.pathnames_len << std::endl;
     }
 
+    // Buffer holding the subextents intersected by each sample
+    std::vector<ExtentGroup::size_type> intersection;
+
     // Iterate over each of the events
     for(unsigned i = 0; i < data.events.events_len; ++i) {
 
@@ -459,13 +462,13 @@ void IOTCollector::getMetricValues(const std::string& metric,
 		break;
 	    
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(interval, AddressRange(*j))
-		    );
+	    subextents.getIntersectionWith(
+		Extent(interval, AddressRange(*j)),
+		intersection
+		);
 
 	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
 		    k = intersection.begin(); k != intersection.end(); ++k) {
 		
 		// Calculate intersection time (in nS) of subextent and event
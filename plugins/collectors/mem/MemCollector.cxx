@@ -436,6 +436,9 @@ void MemCollector::getMetricValues(const std::string& metric,
      
     // HANDLE PREVIOUS mem data from old collector.
     if (is_old_mem_data) {
+      // Buffer holding the subextents intersected by each sample
+      std::vector<ExtentGroup::size_type> intersection;
+
       // Iterate over each of the events
       for(unsigned i = 0; i < olddata.events.events_len; ++i) {
 	Time start(olddata.events.events_val[i].start_time);
@@ -455,12 +458,12 @@ void MemCollector::getMetricValues(const std::string& metric,
 	for(StackTrace::const_iterator 
 		j = trace.begin(); j != trace.end(); ++j) {
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(interval, AddressRange(*j))
-		    );
+	    subextents.getIntersectionWith(
+		Extent(interval, AddressRange(*j)),
+		intersection
+		);
 	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
 		    k = intersection.begin(); k != intersection.end(); ++k) {
 		// Calculate intersection time (in nS) of subextent and event
 		double t_intersection = static_cast<double>
@@ -589,6 +592,9 @@ std::cerr << "OLD MEM EVENT: mem_type:" << olddata.events.events_val[i].mem_type
 
     // HANDLE REDUCED mem data from new collector.
     } else {
+      // Buffer holding the subextents intersected by each sample
+      std::vector<ExtentGroup::size_type> intersection;
+
       // Iterate over each of the events
       for(unsigned i = 0; i < data.events.events_len; ++i) {
 	Time start(data.events.events_val[i].start_time);
@@ -625,12 +631,12 @@ std::cerr << "OLD MEM EVENT: mem_type:" << olddata.events.events_val[i].mem_type
 
 	    bool is_metric_frame  = (j == trace.begin());
 	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(interval, AddressRange(*j))
-		    );
+	    subextents.getIntersectionWith(
+		Extent(interval, AddressRange(*j)),
+		intersection
+		);
 	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
+	    for(std::vector<ExtentGroup::size_type>::const_iterator
 		    k = intersection.begin(); k != intersection.end(); ++k) {
 		
 		// Calculate intersection time (in nS) of subextent and event
@@ -67,6 +67,9 @@ typedef struct {
 	uint64_t stacktraces[StackTraceBufferSize];  /**< Stack traces. */
 	mpi_event events[EventBufferSize];          /**< MPI call events. */
     } buffer;    
+
+    /** Hash table of the stack traces in the tracing buffer. */
+    OpenSS_StackTraceTable stacktrace_table;
     
 #if defined (OPENSS_OFFLINE)
     char mpi_traced[PATH_MAX];
@@ -162,6 +165,7 @@ static void mpi_send_events(TLS *tls)
     
     /* Re-initialize the actual data blob */
     tls->data.stacktraces.stacktraces_len = 0;
+    OpenSS_ClearStackTraceTable(&(tls->stacktrace_table));
     tls->data.events.events_len = 0;    
 }
     
@@ -216,7 +220,7 @@ void mpi_record_event(const mpi_event* event, uint64_t function)
 
     uint64_t stacktrace[MaxFramesPerStackTrace];
     unsigned stacktrace_size = 0;
-    unsigned entry, start, i;
+    unsigned entry, i;
 
     /* Decrement the MPI function wrapper nesting depth */
     --tls->nesting_depth;
@@ -252,36 +256,12 @@ void mpi_record_event(const mpi_event* event, uint64_t function)
     
     /*
      * Search the tracing buffer for an existing stack trace matching the stack
-     * trace from the current thread context. For now do a simple linear search.
+     * trace from the current thread context. Use the stack trace hash table to
+     * accelerate the search. Otherwise add this stack trace to the tracing buffer.
      */
-    for(start = 0, i = 0;
-	(i < stacktrace_size) &&
-	    ((start + i) < tls->data.stacktraces.stacktraces_len);
-	++i)
-	
-	/* Do the i'th frames differ? */
-	if(stacktrace[i] != tls->buffer.stacktraces[start + i]) {
-	    
-	    /* Advance in the tracing buffer to the end of this stack trace */
-	    for(start += i;
-		(tls->buffer.stacktraces[start] != 0) &&
-		    (start < tls->data.stacktraces.stacktraces_len);
-		++start);
-	    
-	    /* Advance in the tracing buffer past the terminating zero */
-	    ++start;
-	    
-	    /* Begin comparing at the zero'th frame again */
-	    i = 0;
-	    
-	}
-    
-    /* Did we find a match in the tracing buffer? */
-    if(i == stacktrace_size)
-	entry = start;
-    
-    /* Otherwise add this stack trace to the tracing buffer */
-    else {
+    if(!OpenSS_FindStackTrace(&(tls->stacktrace_table),
+			      tls->buffer.stacktraces,
+			      stacktrace_size, stacktrace, &entry)) {
 	
 	/* Send events if there is insufficient room for this stack trace */
 	if((tls->data.stacktraces.stacktraces_len + stacktrace_size + 1) >=
@@ -326,6 +306,10 @@ void mpi_record_event(const mpi_event* event, uint64_t function)
 	/* Set the new size of the tracing buffer */
 	tls->data.stacktraces.stacktraces_len += (stacktrace_size + 1);
 	
+	/* Add this stack trace to the stack trace hash table */
+	OpenSS_AddStackTrace(&(tls->stacktrace_table),
+			     tls->buffer.stacktraces, entry, stacktrace_size);
+	
     }
     
     /* Add a new entry for this event to the tracing buffer. */
@@ -434,6 +418,7 @@ void mpi_start_tracing(const char* arguments)
     
     /* Initialize the actual data blob */
     tls->data.stacktraces.stacktraces_len = 0;
+    OpenSS_ClearStackTraceTable(&(tls->stacktrace_table));
     tls->data.stacktraces.stacktraces_val = tls->buffer.stacktraces;
     tls->data.events.events_len = 0;
     tls->data.events.events_val = tls->buffer.events;
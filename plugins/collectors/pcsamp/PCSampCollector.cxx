@@ -273,6 +273,9 @@ void PCSampCollector::getMetricValues(const std::string& metric,
     // Calculate time (in nS) of data blob's extent
     double t_blob = static_cast<double>(extent.getTimeInterval().getWidth());
    
+    // Cache of the subextents containing each sample
+    SubextentCache& cache = getSubextentCache(subextents);
+
     // Iterate over each of the samples
     for(unsigned i = 0; i < data.pc.pc_len; ++i) {
 
@@ -289,11 +292,8 @@ void PCSampCollector::getMetricValues(const std::string& metric,
 #endif
 	
 	// Find the subextents that contain this sample
-	std::set<ExtentGroup::size_type> intersection = 
-	    subextents.getIntersectionWith(
-		Extent(extent.getTimeInterval(),
-		       AddressRange(data.pc.pc_val[i]))
-		);
+	const std::vector<ExtentGroup::size_type>& containing =
+	    cache.getSubextentsAt(Address(data.pc.pc_val[i]));
 	
 	// Calculate the time (in seconds) attributable to this sample
 	double t_sample = static_cast<double>(data.count.count_val[i]) *
@@ -306,9 +306,15 @@ void PCSampCollector::getMetricValues(const std::string& metric,
 	<< std::endl;
 #endif
 	
-	// Iterate over each subextent in the intersection
-	for(std::set<ExtentGroup::size_type>::const_iterator
-		j = intersection.begin(); j != intersection.end(); ++j) {
+	// Iterate over each subextent containing this sample
+	for(std::vector<ExtentGroup::size_type>::const_iterator
+		j = containing.begin(); j != containing.end(); ++j) {
+
+	    // Skip subextents that don't intersect the data blob in time
+	    if(!extent.getTimeInterval().doesIntersect(
+		   subextents[*j].getTimeInterval()
+		   ))
+		continue;
 	    
 	    // Calculate intersection time (in nS) of subextent and data blob
 	    double t_intersection = static_cast<double>
@@ -338,6 +344,21 @@ void PCSampCollector::getMetricValues(const std::string& metric,
 	     reinterpret_cast<char*>(&data));
 }
 
+/**
+ * Test if a metric can be aggregated.
+ *
+ * Implements indicating which of this collector's metrics are additive over
+ * individual addresses. Only the "time" metric is.
+ *
+ * @param metric    Unique identifier of the metric.
+ * @return          Boolean "true" if the metric can be aggregated,
+ *                  "false" otherwise.
+ */
+bool PCSampCollector::isAggregatable(const std::string& metric) const
+{
+    return metric == "time";
+}
+
 void PCSampCollector::getUniquePCValues( const Thread& thread,
 					 const Blob& blob,
 					 PCBuffer *buffer) const
@@ -38,6 +38,23 @@ namespace {
     /** Type returned for the sample detail metrics. */
     typedef std::map<StackTrace, UserTimeDetail> SampleDetail;
 
+    /**
+     * Test if a stack frame is valid.
+     *
+     * libunwind can fail to unwind and deliver a bad address. If that address
+     * is equal to or exceeds the highest address possible then the Address
+     * constructor asserts. And for some reason pthreaded calltrees have an
+     * extra frame with address of 0x0. Do not pass these on to view code.
+     * FIXME. look at unwind code for the real cause...
+     *
+     * @param frame    Address of the stack frame.
+     * @return         Boolean "true" if the frame is valid, "false" otherwise.
+     */
+    bool isValidFrame(const uint64_t& frame)
+    {
+	return (frame != 0) && (frame < Address::TheHighest().getValue());
+    }
+
 }
 
 
@@ -310,7 +327,9 @@ void UserTimeCollector::getMetricValues(const std::string& metric,
     // Calculate time (in nS) of data blob's extent
     double t_blob = static_cast<double>(extent.getTimeInterval().getWidth());
 
-    ExtentGroup extgrp = subextents;
+    // Cache of the subextents containing each frame
+    SubextentCache& cache = getSubextentCache(subextents);
+
     // Iterate over each stack trace in the data blob    
     for(unsigned ib = 0, ie = 0; ie < data.bt.bt_len; ib = ie) {
 	
@@ -323,88 +342,79 @@ void UserTimeCollector::getMetricValues(const std::string& metric,
 	double t_sample = static_cast<double>(data.count.count_val[ib]) *
 	    static_cast<double>(data.interval) / 1000000000.0;
 	
-	// Get the stack trace for this sample
+	// Get the stack trace for this sample (only needed for the details)
 	StackTrace trace(thread, ebegintime);
-	for(unsigned j = ib; j < ie; ++j) {
-	   // libunwind can fail to unwind and deliver a bad address.
-	   // If that address is equal to or exceeds the highest address
-	   // possible then the Address constructor asserts.
-	   if (data.bt.bt_val[j] >= Address::TheHighest()) {
-//DEBUG
-#if 0
-		std::cerr << "TOSSING address " <<  data.bt.bt_val[j]
-		<< std::endl; 
-#endif
-	   } else {
-		if (data.bt.bt_val[j] == 0) {
-		    // for some reason pthreaded calltrees have an extra
-		    // frame with address of 0x0.  Do not pass these on to view
-		    // code.  FIXME.  look at unwind code for the real cause...
-		    continue;
-		}
+	for(unsigned j = ib; is_detail && (j < ie); ++j)
+	    if(isValidFrame(data.bt.bt_val[j]))
 		trace.push_back(Address(data.bt.bt_val[j]));
-	   }
-	}
 	
 	// Iterate over each of the frames in the current stack trace
-	for(StackTrace::const_iterator
-		j = trace.begin(); j != trace.end(); ++j) {
-	    
-	    // Stop after first frame if this is "exclusive_[time|detail]"
-	    if(is_exclusive && (j != trace.begin()))
-		break;
+	for(unsigned j = ib; j < ie; ++j) {
 
-	    if (!subBoundsAR.doesContain(*j)) {
+	    // Skip frames that aren't valid addresses
+	    if(!isValidFrame(data.bt.bt_val[j]))
 		continue;
-	    }
-
-	    // Find the subextents that contain this frame
-	    std::set<ExtentGroup::size_type> intersection =
-		subextents.getIntersectionWith(
-		    Extent(etimeinterval, AddressRange(*j))
-		    );
-
-	    // Iterate over each subextent in the intersection
-	    for(std::set<ExtentGroup::size_type>::const_iterator
-		    k = intersection.begin(); k != intersection.end(); ++k) {
-
-		// Calculate intersection time (in nS) of subextent and blob
-		double t_intersection = static_cast<double>
-		    ((etimeinterval &
-		      subextents[*k].getTimeInterval()).getWidth());
-
-		// Handle "[inclusive|exclusive]_detail" metric
-		if(is_detail) {
-
-		    // Find this stack trace in the subextent's metric value
-		    SampleDetail::iterator l =
-			(*reinterpret_cast<std::vector<SampleDetail>*>(ptr))[*k]
-			.insert(
-			    std::make_pair(trace, UserTimeDetail())
-			    ).first;
+	    Address frame(data.bt.bt_val[j]);
+	    
+	    if(subBoundsAR.doesContain(frame)) {
+
+		// Find the subextents that contain this frame
+		const std::vector<ExtentGroup::size_type>& containing =
+		    cache.getSubextentsAt(frame);
+
+		// Iterate over each subextent containing this frame
+		for(std::vector<ExtentGroup::size_type>::const_iterator
+			k = containing.begin(); k != containing.end(); ++k) {
+
+		    // Skip subextents that don't intersect the blob in time
+		    if(!etimeinterval.doesIntersect(
+			   subextents[*k].getTimeInterval()
+			   ))
+			continue;
+
+		    // Calculate intersection time (in nS) of subextent and blob
+		    double t_intersection = static_cast<double>
+			((etimeinterval &
+			  subextents[*k].getTimeInterval()).getWidth());
+
+		    // Handle "[inclusive|exclusive]_detail" metric
+		    if(is_detail) {
+
+			// Find this stack trace in the subextent's metric value
+			SampleDetail::iterator l =
+			    (*reinterpret_cast<std::vector<SampleDetail>*>(ptr))
+			    [*k].insert(
+				std::make_pair(trace, UserTimeDetail())
+				).first;
 		    
-		    // Add (to the subextent's metric value) the appropriate
-		    // fraction of the count and total time attributable to
-		    // this sample
-		    l->second.dm_count += static_cast<uint64_t>(
-			static_cast<double>(data.count.count_val[ib]) * 
-			(t_intersection / t_blob)
-			);
-		    l->second.dm_time += t_sample * (t_intersection / t_blob);
+			// Add (to the subextent's metric value) the appropriate
+			// fraction of the count and total time attributable to
+			// this sample
+			l->second.dm_count += static_cast<uint64_t>(
+			    static_cast<double>(data.count.count_val[ib]) * 
+			    (t_intersection / t_blob)
+			    );
+			l->second.dm_time += t_sample * (t_intersection / t_blob);
 		    
-		}
+		    }
 
-		// Handle "[inclusive|exclusive]_time" metric		
-		else {
+		    // Handle "[inclusive|exclusive]_time" metric		
+		    else {
 
-		    // Add (to the subextent's metric value) the appropriate
-		    // fraction of the total time attributable to this sample
-		    (*reinterpret_cast<std::vector<double>*>(ptr))[*k] +=
-			t_sample * (t_intersection / t_blob);
+			// Add (to the subextent's metric value) the appropriate
+			// fraction of the total time attributable to this sample
+			(*reinterpret_cast<std::vector<double>*>(ptr))[*k] +=
+			    t_sample * (t_intersection / t_blob);
 		    
-		}
+		    }
 		
+		}
+
 	    }
+
+	    // Stop after first frame if this is "exclusive_[time|detail]"
+	    if(is_exclusive)
+		break;
 	    
 	}
 	
@@ -415,6 +425,21 @@ void UserTimeCollector::getMetricValues(const std::string& metric,
              reinterpret_cast<char*>(&data));
 }
 
+/**
+ * Test if a metric can be aggregated.
+ *
+ * Implements indicating which of this collector's metrics are additive over
+ * individual addresses. Only the "exclusive_time" metric is.
+ *
+ * @param metric    Unique identifier of the metric.
+ * @return          Boolean "true" if the metric can be aggregated,
+ *                  "false" otherwise.
+ */
+bool UserTimeCollector::isAggregatable(const std::string& metric) const
+{
+    return metric == "exclusive_time";
+}
+
 void UserTimeCollector::getUniquePCValues( const Thread& thread,
                                          const Blob& blob,
                                          PCBuffer *buffer) const
@@ -71,6 +71,16 @@ typedef struct {
 				    /**< exist in buffer bt. */
     } buffer;    
 
+    /** Hash table of the unique stacks in the sample buffer. */
+    OpenSS_StackTraceTable stacktrace_table;
+
+#ifndef NDEBUG
+    bool_t debug_stacks;        /**< Flag indicating if stats are gathered. */
+    uint64_t debug_samples;     /**< Number of samples taken. */
+    uint64_t debug_unique;      /**< Number of unique stacks found. */
+    uint64_t debug_search_time; /**< Time spent finding and adding stacks. */
+#endif
+
     bool_t defer_sampling;
 
 #if defined(OPENSS_HANDLE_UNWIND_SEGV)
@@ -219,6 +229,7 @@ static void send_samples(TLS *tls)
     /* Re-initialize the sampling buffer */
     memset(tls->buffer.bt, 0, sizeof(tls->buffer.bt));
     memset(tls->buffer.count, 0, sizeof(tls->buffer.count));
+    OpenSS_ClearStackTraceTable(&(tls->stacktrace_table));
 }
 
 /**
@@ -313,43 +324,45 @@ static void usertimeTimerHandler(const ucontext_t* context)
 #endif
 
 
-    bool_t stack_already_exists = FALSE;
-
-    int i, j;
-    /* search individual stacks via count/indexing array */
-    for (i = 0; i < tls->data.count.count_len ; i++ )
-    {
-	/* a count > 0 indexes the top of stack in the data buffer. */
-	/* a count == 255 indicates this stack is at the count limit. */
-	if (tls->buffer.count[i] == 0) {
-	    continue;
-	}
-	if (tls->buffer.count[i] == 255) {
-	    continue;
-	}
-
-	/* see if the stack addresses match */
-	for (j = 0; j < framecount ; j++ )
-	{
-	    if ( tls->buffer.bt[i+j] != framebuf[j] ) {
-		   break;
-	    }
-	}
+    /* nothing is recorded for an empty stack trace */
+    if (framecount == 0) {
+	return;
+    }
 
-	if ( j == framecount) {
-	    stack_already_exists = TRUE;
-	    stackindex = i;
-	}
+#ifndef NDEBUG
+    uint64_t debug_start_time = 0;
+    if (tls->debug_stacks) {
+	tls->debug_samples++;
+	debug_start_time = OpenSS_GetTime();
     }
+#endif
+
+    int i;
+    unsigned entry;
 
     /* if the stack already exisits in the buffer, update its count
-     * and return. If the stack is already at the count limit.
+     * and return. If the stack is already at the count limit, a new
+     * instance of the stack is added and replaces it in the hash table.
     */
-    if (stack_already_exists && tls->buffer.count[stackindex] < 255 ) {
-	/* update count for this stack */
-	tls->buffer.count[stackindex] = tls->buffer.count[stackindex] + 1;
-	return;
+    if (OpenSS_FindStackTrace(&(tls->stacktrace_table), tls->buffer.bt,
+			      framecount, framebuf, &entry)) {
+	stackindex = entry;
+	if (tls->buffer.count[stackindex] < 255 ) {
+	    /* update count for this stack */
+	    tls->buffer.count[stackindex] = tls->buffer.count[stackindex] + 1;
+#ifndef NDEBUG
+	    if (tls->debug_stacks) {
+		tls->debug_search_time += OpenSS_GetTime() - debug_start_time;
+	    }
+#endif
+	    return;
+	}
+    }
+#ifndef NDEBUG
+    else if (tls->debug_stacks) {
+	tls->debug_unique++;
     }
+#endif
 
     /* sample buffer has no room for these stack frames.*/
     int buflen = tls->data.bt.bt_len + framecount;
@@ -357,6 +370,7 @@ static void usertimeTimerHandler(const ucontext_t* context)
 	/* send the current sample buffer. (will init a new buffer) */
 	send_samples(tls);
     }
+    entry = tls->data.bt.bt_len;
 
     /* add frames to sample buffer, compute addresss range */
     for (i = 0; i < framecount ; i++)
@@ -382,6 +396,16 @@ static void usertimeTimerHandler(const ucontext_t* context)
 	tls->data.bt.bt_len++;
 	tls->data.count.count_len++;
     }
+
+    /* add this stack to the hash table */
+    OpenSS_AddStackTrace(&(tls->stacktrace_table), tls->buffer.bt,
+			 entry, framecount);
+
+#ifndef NDEBUG
+    if (tls->debug_stacks) {
+	tls->debug_search_time += OpenSS_GetTime() - debug_start_time;
+    }
+#endif
 }
 
 
@@ -444,6 +468,14 @@ void usertime_start_sampling(const char* arguments)
     /* Initialize the sampling buffer */
     memset(tls->buffer.bt, 0, sizeof(tls->buffer.bt));
     memset(tls->buffer.count, 0, sizeof(tls->buffer.count));
+    OpenSS_ClearStackTraceTable(&(tls->stacktrace_table));
+
+#ifndef NDEBUG
+    tls->debug_stacks = (getenv("OPENSS_DEBUG_COLLECTOR") != NULL);
+    tls->debug_samples = 0;
+    tls->debug_unique = 0;
+    tls->debug_search_time = 0;
+#endif
 
 #if defined(OPENSS_HANDLE_UNWIND_SEGV)
     memset((void *)tls->unwind_jmp, '\0', sizeof(tls->unwind_jmp));
@@ -491,6 +523,18 @@ void usertime_stop_sampling(const char* arguments)
 	send_samples(tls);
     }
     
+#ifndef NDEBUG
+    /* Report the cost of finding stacks versus the number of unique stacks */
+    if (tls->debug_stacks && (tls->debug_samples > 0)) {
+	fprintf(stderr, "usertime_stop_sampling: %llu samples, %llu new stacks, "
+		"%llu ns/sample finding stacks\n",
+		(unsigned long long)tls->debug_samples,
+		(unsigned long long)tls->debug_unique,
+		(unsigned long long)(tls->debug_search_time /
+				     tls->debug_samples));
+    }
+#endif
+
     /* Destroy our thread-local storage */
 #ifdef USE_EXPLICIT_TLS
     free(tls);
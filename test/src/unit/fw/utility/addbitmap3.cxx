@@ -0,0 +1,50 @@
+#include <iostream>
+#include <stdlib.h>
+#include "inttypes.h"
+#include "AddressRange.hxx"
+#include "AddressBitmap.hxx"
+#include "Blob.hxx"
+
+using namespace std;
+using namespace OpenSpeedShop;
+using namespace Framework;
+
+int main(){
+	bool passed = true;
+        AddressRange testRange(Address(0x1000), Address(0x1100));
+
+	// Fully valid bitmaps are run-length encoded, when enabled
+	setenv("OPENSS_COMPRESS_BITMAPS", "1", 1);
+	AddressBitmap full(testRange);
+	full.setValue(testRange, true);
+	Blob full_blob = full.getBlob();
+	if (full_blob.getSize() >= (testRange.getWidth() / 8))
+		passed = false;
+	AddressBitmap full_copy(testRange, full_blob);
+	if (full_copy.getContiguousRanges(true).size() != 1)
+		passed = false;
+
+	// Packed bitmaps, as found in existing databases, are still decoded
+	unsigned char packed[32];
+	for (int i = 0; i < 32; i++)
+		packed[i] = 0x55;
+	AddressBitmap sparse(testRange, Blob(32, packed));
+	if (!sparse.getValue(Address(0x1000)) ||
+	    sparse.getValue(Address(0x1001)) ||
+	    (sparse.getContiguousRanges(true).size() != 128))
+		passed = false;
+	AddressBitmap sparse_copy(testRange, sparse.getBlob());
+	for (Address a = Address(0x1000); a < Address(0x1100); ++a)
+		if (sparse_copy.getValue(a) != sparse.getValue(a))
+			passed = false;
+
+        if (passed){
+                cout << "PASS" << endl;
+        }
+        else
+        {
+                cout << "FAIL" << endl;
+        }
+
+ return 0;
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <string.h>
+#include "inttypes.h"
+#include "Blob.hxx"
+
+using namespace std;
+using namespace OpenSpeedShop;
+using namespace Framework;
+
+int main(){
+	bool passed = true;
+	char contents[64];
+	memset(contents, 0x5A, sizeof(contents));
+
+	// Copies of an owning blob share its contents
+	Blob owner(sizeof(contents), contents);
+	Blob shared(owner);
+	if ((owner.getContents() == contents) ||
+	    (shared.getContents() != owner.getContents()) ||
+	    owner.isBorrowed())
+		passed = false;
+
+	// Borrowed contents are referenced without being copied
+	Blob view(sizeof(contents), contents, Blob::Borrow);
+	if ((view.getContents() != contents) || !view.isBorrowed())
+		passed = false;
+
+	// Copies of a borrowing blob own a copy of the contents
+	Blob copy(view);
+	if ((copy.getContents() == contents) || copy.isBorrowed() ||
+	    (copy.getSize() != sizeof(contents)) ||
+	    (memcmp(copy.getContents(), contents, sizeof(contents)) != 0))
+		passed = false;
+
+	// Shared contents outlive the blob they were copied from
+	Blob assigned;
+	{
+		Blob temporary(sizeof(contents), contents);
+		assigned = temporary;
+	}
+	if (memcmp(assigned.getContents(), contents, sizeof(contents)) != 0)
+		passed = false;
+	assigned = Blob();
+	if (!assigned.isEmpty())
+		passed = false;
+
+        if (passed){
+                cout << "PASS" << endl;
+        }
+        else
+        {
+                cout << "FAIL" << endl;
+        }
+
+ return 0;
+}
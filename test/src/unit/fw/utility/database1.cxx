@@ -0,0 +1,108 @@
+#include <iostream>
+#include <sstream>
+#include <sys/time.h>
+#include <unistd.h>
+#include "inttypes.h"
+#include "Database.hxx"
+
+using namespace std;
+using namespace OpenSpeedShop;
+using namespace Framework;
+
+static const int Rows = 16;
+static const int Queries = 100000;
+
+// Lookup by the address space of a thread, as Thread::getFunctionAt() does
+#define LOOKUP_STATEMENT \
+	"SELECT linked_object, addr_begin, addr_end " \
+	"FROM AddressSpaces " \
+	"WHERE thread = ? " \
+	"  AND ? >= time_begin " \
+	"  AND ? < time_end " \
+	"  AND ? >= addr_begin " \
+	"  AND ? < addr_end;"
+
+static Database::RegisteredStatement LookupStatement(LOOKUP_STATEMENT);
+
+// Time repeated lookups, returning the sum of the linked objects found
+template <typename T>
+static int timeLookups(Database& database, const T& statement,
+		       const char* label){
+	int sum = 0;
+	struct timeval start, stop;
+	gettimeofday(&start, NULL);
+	database.beginTransaction();
+	for (int i = 0; i < Queries; ++i) {
+		int row = i % Rows;
+		database.prepareStatement(statement);
+		database.bindArgument(1, 1);
+		database.bindArgument(2, 0);
+		database.bindArgument(3, 0);
+		database.bindArgument(4, 100 * row + 50);
+		database.bindArgument(5, 100 * row + 50);
+		while (database.executeStatement())
+			sum += database.getResultAsInteger(1);
+	}
+	database.commitTransaction();
+	gettimeofday(&stop, NULL);
+
+	cout << "Prepared " << Queries << " " << label << " statements in "
+	     << ((stop.tv_sec - start.tv_sec) * 1000 +
+		 (stop.tv_usec - start.tv_usec) / 1000)
+	     << " mS" << endl;
+
+	return sum;
+}
+
+int main(){
+	bool passed = true;
+
+	ostringstream name;
+	name << "database1_" << getpid() << ".openss";
+	Database::create(name.str());
+	{
+		Database database(name.str());
+
+		// Fill a scratch address space table
+		database.beginTransaction();
+		database.prepareStatement(
+			"CREATE TABLE AddressSpaces ("
+			"  thread INTEGER, "
+			"  time_begin INTEGER, "
+			"  time_end INTEGER, "
+			"  addr_begin INTEGER, "
+			"  addr_end INTEGER, "
+			"  linked_object INTEGER"
+			");"
+			);
+		while (database.executeStatement());
+		for (int i = 0; i < Rows; ++i) {
+			database.prepareStatement(
+				"INSERT INTO AddressSpaces VALUES (1, 0, 1, ?, ?, ?);"
+				);
+			database.bindArgument(1, 100 * i);
+			database.bindArgument(2, 100 * (i + 1));
+			database.bindArgument(3, i);
+			while (database.executeStatement());
+		}
+		database.commitTransaction();
+
+		// Both forms of the statement find the same rows
+		int text = timeLookups(database, string(LOOKUP_STATEMENT), "text");
+		int registered = timeLookups(database, LookupStatement, "registered");
+		if ((text != registered) ||
+		    (text != (Queries / Rows) * (Rows * (Rows - 1) / 2)))
+			passed = false;
+	}
+	Database::remove(name.str());
+
+        if (passed){
+                cout << "PASS" << endl;
+        }
+        else
+        {
+                cout << "FAIL" << endl;
+        }
+
+ return 0;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <set>
+#include <pthread.h>
+#include <sys/time.h>
+#include "inttypes.h"
+#include "SmartPtr.hxx"
+
+using namespace std;
+using namespace OpenSpeedShop;
+using namespace Framework;
+
+// Object counting its live instances
+struct Counted {
+	static unsigned live;
+	Counted() { __sync_fetch_and_add(&live, 1); }
+	~Counted() { __sync_fetch_and_sub(&live, 1); }
+};
+unsigned Counted::live = 0;
+
+// Entity holding a smart pointer, as Function holds its database
+struct Entity {
+	SmartPtr<Counted> database;
+	int entry;
+	Entity(const SmartPtr<Counted>& d, int e) : database(d), entry(e) { }
+	bool operator<(const Entity& other) const {
+		return entry < other.entry;
+	}
+};
+
+static const int Entities = 10000;
+static const int Copies = 100;
+
+// Copy a set of entities repeatedly, as ThreadGroup::getFunctions() does
+static void* copySets(void* arg){
+	const set<Entity>& entities = *reinterpret_cast<set<Entity>*>(arg);
+	for (int i = 0; i < Copies; ++i) {
+		set<Entity> result;
+		result.insert(entities.begin(), entities.end());
+	}
+	return NULL;
+}
+
+int main(){
+	bool passed = true;
+
+	// Null smart pointers share nothing and destroy nothing
+	{
+		SmartPtr<Counted> a, b;
+		a = b;
+		if (!a.isNull() || !b.isNull())
+			passed = false;
+	}
+
+	// The object is destroyed with the last reference
+	{
+		SmartPtr<Counted> a(new Counted());
+		{
+			SmartPtr<Counted> b(a);
+			SmartPtr<Counted> c;
+			c = b;
+			c = c;
+		}
+		if (Counted::live != 1)
+			passed = false;
+		a = SmartPtr<Counted>();
+		if (Counted::live != 0)
+			passed = false;
+	}
+
+	// Concurrent copies keep the reference count exact
+	{
+		SmartPtr<Counted> database(new Counted());
+		set<Entity> entities;
+		for (int i = 0; i < Entities; ++i)
+			entities.insert(Entity(database, i));
+
+		struct timeval start, stop;
+		gettimeofday(&start, NULL);
+		pthread_t threads[4];
+		for (int i = 0; i < 4; ++i)
+			pthread_create(&threads[i], NULL, copySets, &entities);
+		for (int i = 0; i < 4; ++i)
+			pthread_join(threads[i], NULL);
+		gettimeofday(&stop, NULL);
+
+		cout << "Copied " << (4 * Copies * Entities) << " entities in "
+		     << ((stop.tv_sec - start.tv_sec) * 1000 +
+			 (stop.tv_usec - start.tv_usec) / 1000)
+		     << " mS" << endl;
+
+		if (Counted::live != 1)
+			passed = false;
+	}
+	if (Counted::live != 0)
+		passed = false;
+
+        if (passed){
+                cout << "PASS" << endl;
+        }
+        else
+        {
+                cout << "FAIL" << endl;
+        }
+
+ return 0;
+}